@@ -0,0 +1,265 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <cmath>
+#include <cstddef>
+#include <new>
+
+#include "error.h"
+
+/*forward-mode automatic differentiation: dual number carries value and derivatives
+  along N tangent directions, so goal function written once as a template over
+  the number type gives exact gradient in dim / N passes*/
+template<unsigned int N>
+class Dual
+{
+public:
+    double val;
+    double d[N];
+
+    Dual(double value = 0): val(value)
+    {
+        for (unsigned int i = 0; i < N; i++)
+            d[i] = 0;
+    }
+
+    /*variable with derivative 1 along 'direction'*/
+    static Dual variable(double value, unsigned int direction)
+    {
+        Dual res(value);
+        if (direction < N)
+            res.d[direction] = 1;
+        return res;
+    }
+
+    Dual& operator+=(Dual const& right)
+    {
+        val += right.val;
+        for (unsigned int i = 0; i < N; i++)
+            d[i] += right.d[i];
+        return *this;
+    }
+
+    Dual& operator-=(Dual const& right)
+    {
+        val -= right.val;
+        for (unsigned int i = 0; i < N; i++)
+            d[i] -= right.d[i];
+        return *this;
+    }
+
+    Dual& operator*=(Dual const& right)
+    {
+        for (unsigned int i = 0; i < N; i++)
+            d[i] = d[i] * right.val + val * right.d[i];
+        val *= right.val;
+        return *this;
+    }
+
+    Dual& operator/=(Dual const& right)
+    {
+        double inv = 1 / right.val;
+        val *= inv;
+        for (unsigned int i = 0; i < N; i++)
+            d[i] = (d[i] - val * right.d[i]) * inv;
+        return *this;
+    }
+};
+
+template<unsigned int N>
+inline Dual<N> operator-(Dual<N> const& x)
+{
+    Dual<N> res(-x.val);
+    for (unsigned int i = 0; i < N; i++)
+        res.d[i] = -x.d[i];
+    return res;
+}
+
+template<unsigned int N>
+inline Dual<N> operator+(Dual<N> left, Dual<N> const& right) { return left += right; }
+template<unsigned int N>
+inline Dual<N> operator+(Dual<N> left, double right) { return left += Dual<N>(right); }
+template<unsigned int N>
+inline Dual<N> operator+(double left, Dual<N> right) { return right += Dual<N>(left); }
+
+template<unsigned int N>
+inline Dual<N> operator-(Dual<N> left, Dual<N> const& right) { return left -= right; }
+template<unsigned int N>
+inline Dual<N> operator-(Dual<N> left, double right) { return left -= Dual<N>(right); }
+template<unsigned int N>
+inline Dual<N> operator-(double left, Dual<N> const& right) { return Dual<N>(left) -= right; }
+
+template<unsigned int N>
+inline Dual<N> operator*(Dual<N> left, Dual<N> const& right) { return left *= right; }
+template<unsigned int N>
+inline Dual<N> operator*(Dual<N> left, double right)
+{
+    left.val *= right;
+    for (unsigned int i = 0; i < N; i++)
+        left.d[i] *= right;
+    return left;
+}
+template<unsigned int N>
+inline Dual<N> operator*(double left, Dual<N> const& right) { return right * left; }
+
+template<unsigned int N>
+inline Dual<N> operator/(Dual<N> left, Dual<N> const& right) { return left /= right; }
+template<unsigned int N>
+inline Dual<N> operator/(Dual<N> const& left, double right) { return left * (1 / right); }
+template<unsigned int N>
+inline Dual<N> operator/(double left, Dual<N> const& right) { return Dual<N>(left) /= right; }
+
+/*comparisons look at values only, so branches of goal function behave as over doubles*/
+template<unsigned int N>
+inline bool operator<(Dual<N> const& left, Dual<N> const& right) { return left.val < right.val; }
+template<unsigned int N>
+inline bool operator<(Dual<N> const& left, double right) { return left.val < right; }
+template<unsigned int N>
+inline bool operator<(double left, Dual<N> const& right) { return left < right.val; }
+
+template<unsigned int N>
+inline bool operator>(Dual<N> const& left, Dual<N> const& right) { return left.val > right.val; }
+template<unsigned int N>
+inline bool operator>(Dual<N> const& left, double right) { return left.val > right; }
+template<unsigned int N>
+inline bool operator>(double left, Dual<N> const& right) { return left > right.val; }
+
+template<unsigned int N>
+inline bool operator<=(Dual<N> const& left, Dual<N> const& right) { return left.val <= right.val; }
+template<unsigned int N>
+inline bool operator<=(Dual<N> const& left, double right) { return left.val <= right; }
+template<unsigned int N>
+inline bool operator<=(double left, Dual<N> const& right) { return left <= right.val; }
+
+template<unsigned int N>
+inline bool operator>=(Dual<N> const& left, Dual<N> const& right) { return left.val >= right.val; }
+template<unsigned int N>
+inline bool operator>=(Dual<N> const& left, double right) { return left.val >= right; }
+template<unsigned int N>
+inline bool operator>=(double left, Dual<N> const& right) { return left >= right.val; }
+
+template<unsigned int N>
+inline bool operator==(Dual<N> const& left, Dual<N> const& right) { return left.val == right.val; }
+template<unsigned int N>
+inline bool operator==(Dual<N> const& left, double right) { return left.val == right; }
+template<unsigned int N>
+inline bool operator==(double left, Dual<N> const& right) { return left == right.val; }
+
+template<unsigned int N>
+inline bool operator!=(Dual<N> const& left, Dual<N> const& right) { return left.val != right.val; }
+template<unsigned int N>
+inline bool operator!=(Dual<N> const& left, double right) { return left.val != right; }
+template<unsigned int N>
+inline bool operator!=(double left, Dual<N> const& right) { return left != right.val; }
+
+/*elementary functions: value is f(x), derivatives are f'(x) * dx*/
+template<unsigned int N>
+inline Dual<N> chain(Dual<N> const& x, double value, double derivative)
+{
+    Dual<N> res(value);
+    for (unsigned int i = 0; i < N; i++)
+        res.d[i] = derivative * x.d[i];
+    return res;
+}
+
+template<unsigned int N>
+inline Dual<N> sqrt(Dual<N> const& x)
+{
+    double s = std::sqrt(x.val);
+    return chain(x, s, 0.5 / s);
+}
+
+template<unsigned int N>
+inline Dual<N> exp(Dual<N> const& x)
+{
+    double e = std::exp(x.val);
+    return chain(x, e, e);
+}
+
+template<unsigned int N>
+inline Dual<N> log(Dual<N> const& x) { return chain(x, std::log(x.val), 1 / x.val); }
+
+template<unsigned int N>
+inline Dual<N> sin(Dual<N> const& x) { return chain(x, std::sin(x.val), std::cos(x.val)); }
+
+template<unsigned int N>
+inline Dual<N> cos(Dual<N> const& x) { return chain(x, std::cos(x.val), -std::sin(x.val)); }
+
+template<unsigned int N>
+inline Dual<N> tan(Dual<N> const& x)
+{
+    double t = std::tan(x.val);
+    return chain(x, t, 1 + t * t);
+}
+
+template<unsigned int N>
+inline Dual<N> atan(Dual<N> const& x) { return chain(x, std::atan(x.val), 1 / (1 + x.val * x.val)); }
+
+template<unsigned int N>
+inline Dual<N> fabs(Dual<N> const& x) { return chain(x, std::fabs(x.val), x.val < 0 ? -1 : 1); }
+
+template<unsigned int N>
+inline Dual<N> pow(Dual<N> const& x, double p)
+{
+    if (x.val == 0) {
+        /*x^(p-1) * x is 0 * inf for p < 1; derivative is 0 for p == 0 or p > 1, infinite for p < 1,
+          directions not depending on x keep zero derivative instead of inf * 0*/
+        Dual<N> res(std::pow(x.val, p));
+        double derivative = p == 0 ? 0 : p * std::pow(x.val, p - 1);
+        for (unsigned int i = 0; i < N; i++)
+            res.d[i] = x.d[i] == 0 ? 0 : derivative * x.d[i];
+        return res;
+    }
+    double xp = std::pow(x.val, p - 1);
+    return chain(x, xp * x.val, p * xp);
+}
+
+/*exp(p * log(x)) isn't defined for x <= 0, so power takes derivative by base as above and adds
+  x^p * log(x) * dp only along directions which exponent depends on; it tends to 0 at x == 0 for p > 0*/
+template<unsigned int N>
+inline Dual<N> pow(Dual<N> const& x, Dual<N> const& p)
+{
+    Dual<N> res = pow(x, p.val);
+    double byExponent = x.val == 0 && p.val > 0 ? 0 : res.val * std::log(x.val);
+    for (unsigned int i = 0; i < N; i++) {
+        if (p.d[i] != 0)
+            res.d[i] += byExponent * p.d[i];
+    }
+    return res;
+}
+
+/*value and gradient of 'f' at 'x' (dim doubles); 'f' is called as f(Dual<N> const* x, Dual<N>& res)
+  and returns error code, every pass seeds N of coordinates, so there are (dim + N - 1) / N passes*/
+template<unsigned int N, class Function>
+int dualGradient(Function const& f, double const* x, size_t dim, double& value, double* grad)
+{
+    if (!x || !grad)
+        return ERR_WRONG_ARG;
+
+    Dual<N>* args = new(std::nothrow) Dual<N>[dim];
+    if (!args)
+        return ERR_MEMORY_ALLOCATION;
+    for (size_t i = 0; i < dim; i++)
+        args[i] = Dual<N>(x[i]);
+
+    int errCode = ERR_OK;
+    size_t first = 0;
+    do {
+        for (size_t i = first; i < first + N && i < dim; i++)
+            args[i].d[i - first] = 1;
+        Dual<N> res;
+        errCode = f(static_cast<Dual<N> const*>(args), res);
+        if (errCode != ERR_OK)
+            break;
+        value = res.val;
+        for (size_t i = first; i < first + N && i < dim; i++) {
+            grad[i] = res.d[i - first];
+            args[i].d[i - first] = 0;
+        }
+        first += N;
+    } while (first < dim);
+    delete[] args;
+    return errCode;
+}
+
+#endif // DUAL_H
@@ -1,15 +1,20 @@
 #ifndef IBROCKER_H
 #define IBROCKER_H
 
+#include <cstddef>
+
 #include "error.h"
 #include "SHARED_EXPORT.h"
 
 class SHARED_EXPORT IBrocker
 {
 public:
+    /*INTERFACE_1 adds the methods declared after destructor, they may be called
+      only when getId() of brocker isn't less than INTERFACE_1*/
     enum InterfaceTypes
     {
         INTERFACE_0,
+        INTERFACE_1,
         DIMENSION_INTERFACE_IMPL
     };
 
@@ -17,6 +22,7 @@ public:
     {
         PROBLEM,
         SOLVER,
+        PROBLEM_CACHE,
         DIMENSION_TYPE
     };
 
@@ -31,6 +37,15 @@ protected:
     /*dtor*/
     virtual ~IBrocker(){}
 
+public:
+    /*new brocker with independent instance of the same implementation for another thread,
+      NULL if implementation can't be copied; it is released by its own release()*/
+    virtual IBrocker* createWorkerBrocker() const
+    {
+        return NULL;
+    }
+
+protected:
     IBrocker() = default;
 
 private:
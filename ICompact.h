@@ -7,16 +7,45 @@
 class SHARED_EXPORT ICompact
 {
 public:
+    class IIterator;
+
+    /*INTERFACE_1 adds the methods declared after destructor, they follow slots of INTERFACE_0
+      in vtable, so they may be called only when getId() of compact isn't less than INTERFACE_1*/
     enum InterfaceTypes
     {
         INTERFACE_0,
+        INTERFACE_1,
         DIMENSION_INTERFACE_IMPL
     };
 
+    enum SequenceType
+    {
+        SEQUENCE_SOBOL,
+        SEQUENCE_HALTON,
+        DIMENSION_SEQUENCE
+    };
+
+    enum ProjectionType
+    {
+        PROJECTION_LATTICE,
+        PROJECTION_CONTINUOUS,
+        DIMENSION_PROJECTION
+    };
+
+    enum IndexOrder
+    {
+        ORDER_ROW_MAJOR,
+        ORDER_MORTON,
+        DIMENSION_ORDER
+    };
+
     virtual int getId() const = 0;
 
     /*factories*/
     static ICompact* createCompact(IVector const* const begin, IVector const* const end, IVector const* const step = 0);
+    /*box 'begin'..'end' cut by half-spaces (normals[i], x) <= offsets[i], step is the sampling of the box*/
+    static ICompact* createPolytope(IVector const* const begin, IVector const* const end, unsigned int count,
+                                    IVector const* const* normals, IVector const* const offsets, IVector const* const step = 0);
 
     /*operations*/
     virtual int Intersection(ICompact const& c)
@@ -41,27 +70,13 @@ public:
     }
     virtual int MakeConvex() { return ERR_OK; }
 
-    /*static operations*/
-    static ICompact* Intersection(ICompact const* const left, ICompact const* const right)
-    {
-        qt_assert("NOT IMPLEMENTED", __FILE__, __LINE__);
-        return static_cast<ICompact*>(0);
-    }
-    static ICompact* Union(ICompact const* const left, ICompact const* const right)
-    {
-        qt_assert("NOT IMPLEMENTED", __FILE__, __LINE__);
-        return static_cast<ICompact*>(0);
-    }
-    static ICompact* Difference(ICompact const* const left, ICompact const* const right)
-    {
-        qt_assert("NOT IMPLEMENTED", __FILE__, __LINE__);
-        return static_cast<ICompact*>(0);
-    }
-    static ICompact* SymDifference(ICompact const* const left, ICompact const* const right)
-    {
-        qt_assert("NOT IMPLEMENTED", __FILE__, __LINE__);
-        return static_cast<ICompact*>(0);
-    }
+    /*static operations (results of operations over boxes are boxes or unions of boxes, sampled by the finer
+      sampling of operands); empty result is a compact without points, whose begin() and end() return nullptr
+      and getBoundingBox() returns ERR_OUT_OF_RANGE, so nullptr is returned only on errors*/
+    static ICompact* Intersection(ICompact const* const left, ICompact const* const right);
+    static ICompact* Union(ICompact const* const left, ICompact const* const right);
+    static ICompact* Difference(ICompact const* const left, ICompact const* const right);
+    static ICompact* SymDifference(ICompact const* const left, ICompact const* const right);
     static ICompact* MakeConvex(ICompact const* const src)
     {
         if (!src) return static_cast<ICompact*>(0);
@@ -75,7 +90,11 @@ public:
     virtual IIterator* begin(IVector const* const step = 0) = 0;
 
     virtual int isContains(IVector const* const vec, bool& result) const = 0;
-    virtual int isSubSet(ICompact const* const other) const = 0;
+    /*result of INTERFACE_0 compacts isn't defined, isSubSet with bool result replaces it*/
+    virtual int isSubSet(ICompact const* const /*other*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
     virtual int isSimplyConn(bool& result) const
     {
         result = true;
@@ -93,6 +112,47 @@ public:
     /*dtor*/
     virtual ~ICompact() = default;
 
+    /*quasi-random iterator: visits points first, first + stride, first + 2 * stride, ...
+      of low-discrepancy sequence mapped onto the compact, so parallel workers may
+      partition the sequence by passing first = worker index and stride = workers amount*/
+    virtual IIterator* beginSequence(SequenceType /*type*/, unsigned /*first*/ = 0, unsigned /*stride*/ = 1)
+    {
+        return static_cast<IIterator*>(0);
+    }
+    //checks if this compact is a subset of 'other'
+    virtual int isSubSet(ICompact const* const /*other*/, bool& /*result*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    /*corners of the smallest box containing the compact, ERR_OUT_OF_RANGE for empty compact*/
+    virtual int getBoundingBox(IVector *& /*begin*/, IVector *& /*end*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    /*nearest point of the compact: PROJECTION_LATTICE snaps to the sampling as getNearestNeighbor,
+      PROJECTION_CONTINUOUS only clamps to the compact; callers may fall back to lattice on ERR_NOT_IMPLEMENTED*/
+    virtual int getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const
+    {
+        if (type == PROJECTION_LATTICE)
+            return getNearestNeighbor(vec, nn);
+        return ERR_NOT_IMPLEMENTED;
+    }
+    /*number of sampling point in the compact and back, for compacts sampled by lattice*/
+    virtual int getIndexByPoint(IVector const* const /*vec*/, unsigned int & /*result*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual IVector* getPointByIndex(unsigned int /*index*/) const
+    {
+        return static_cast<IVector*>(0);
+    }
+    /*order of indices and of default iteration: row-major or Morton (Z-order), which keeps
+      indices of points close by every axis close to each other; Morton indices contain gaps*/
+    virtual int setIndexOrder(IndexOrder order)
+    {
+        return order == ORDER_ROW_MAJOR ? ERR_OK : ERR_NOT_IMPLEMENTED;
+    }
+
     class IIterator
     {
     public:
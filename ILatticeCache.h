@@ -0,0 +1,42 @@
+#ifndef ILATTICECACHE_H
+#define ILATTICECACHE_H
+
+#include "SHARED_EXPORT.h"
+
+/*cache of goal function values at sampling points of compact, keyed by
+  ICompact::getIndexByPoint; when the table is full old values are overwritten*/
+class SHARED_EXPORT ILatticeCache
+{
+public:
+    enum InterfaceTypes
+    {
+        INTERFACE_0,
+        DIMENSION_INTERFACE_IMPL
+    };
+
+    virtual int getId() const = 0;
+
+    /*factories*/
+    static ILatticeCache* createCache(unsigned int capacity);
+
+    virtual int find(unsigned int index, double& value, bool& found) = 0;
+    virtual int put(unsigned int index, double value) = 0;
+    virtual int clear() = 0;
+
+    /*statistics of 'find' calls*/
+    virtual unsigned int getHits() const = 0;
+    virtual unsigned int getMisses() const = 0;
+
+    /*dtor*/
+    virtual ~ILatticeCache(){};
+
+protected:
+    ILatticeCache() = default;
+
+private:
+    /*non default copyable*/
+    ILatticeCache(const ILatticeCache& other) = delete;
+    void operator=(const ILatticeCache& other) = delete;
+};
+
+#endif // ILATTICECACHE_H
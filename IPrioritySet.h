@@ -0,0 +1,31 @@
+#ifndef IPRIORITYSET_H
+#define IPRIORITYSET_H
+
+#include "ISet.h"
+
+/*set of K best points by value (the least values are the best),
+  indices of points stay the same until they are removed or pushed out*/
+class SHARED_EXPORT IPrioritySet : public ISet
+{
+public:
+    /*factory*/
+    static IPrioritySet* createPrioritySet(unsigned int R_dim, unsigned int capacity);
+
+    using ISet::put;
+    /*puts item if set isn't full or item is better than the worst one, which is removed then*/
+    virtual int put(IVector const* const item, double value) = 0;
+    virtual int getValue(unsigned int index, double& value) const = 0;
+    virtual int getBest(IVector*& pItem, double& value) const = 0;
+    virtual unsigned int getCapacity() const = 0;
+
+    /*points (count * dim doubles) and their values sorted from the best one*/
+    virtual int exportSorted(unsigned int bufferSize, double* coords, double* values) const = 0;
+
+    /*dtor*/
+    virtual ~IPrioritySet(){};
+
+protected:
+    IPrioritySet() = default;
+};
+
+#endif // IPRIORITYSET_H
@@ -1,15 +1,22 @@
 #ifndef IPROBLEM_H
 #define IPROBLEM_H
 
+#include <new>
+
 #include "IVector.h"
 #include "SHARED_EXPORT.h"
 
+class IBrocker;
+
 class SHARED_EXPORT IProblem
 {
 public:
+    /*INTERFACE_1 adds the methods declared after destructor, they follow slots of INTERFACE_0
+      in vtable, so they may be called only when getId() of problem isn't less than INTERFACE_1*/
     enum InterfaceTypes
     {
         INTERFACE_0,
+        INTERFACE_1,
         DIMENSION_INTERFACE_IMPL
     };
 
@@ -20,6 +27,20 @@ public:
         DIMENSION_DERIVED
     };
 
+    enum DifferenceScheme
+    {
+        FORWARD_DIFFERENCE,
+        CENTRAL_DIFFERENCE,
+        DIMENSION_DIFFERENCE
+    };
+
+    /*adapter taking derivatives of 'problem' by finite differences with relative 'step' (0 for default one);
+      perturbed points of gradient are evaluated by batches spread over 'threads' (0 for all cores),
+      every thread gets worker instance if 'problem' isn't reentrant, or one thread is used if it has none;
+      problem of INTERFACE_0 is evaluated point by point; release() of returned brocker doesn't release 'problem'*/
+    static IBrocker* createFiniteDifferenceAdapter(IProblem* problem, DifferenceScheme scheme = CENTRAL_DIFFERENCE,
+                                                   double step = 0, unsigned int threads = 0);
+
     virtual int getId() const = 0;
 
     virtual int goalFunction(IVector const* args, IVector const* params, double& res) const = 0;
@@ -38,6 +59,177 @@ public:
 protected:
     virtual ~IProblem(){}
 
+public:
+    /*caller's buffer of 'dim' doubles is used as params (args) without copying until it is
+      replaced by setParams (setArgs) or unbound by nullptr; after writing to bound buffer caller
+      calls paramsChanged (argsChanged), so values cached by problem are updated*/
+    virtual int bindParams(double const* /*params*/, size_t /*dim*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int bindArgs(double const* /*args*/, size_t /*dim*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int paramsChanged()
+    {
+        return ERR_OK;
+    }
+    virtual int argsChanged()
+    {
+        return ERR_OK;
+    }
+
+    /*const methods may be called from several threads at once without locks;
+      problems which aren't reentrant are used by one thread or through worker instances*/
+    virtual bool isReentrant() const
+    {
+        return false;
+    }
+    /*independent copy with the same fixed args and params (bound buffers stay shared) for another thread,
+      nullptr if problem can't be copied; after writing to shared buffer caller notifies every worker by its
+      paramsChanged (argsChanged); copy is released only by its releaseWorkerInstance, which returns
+      ERR_WRONG_ARG for problems which aren't copies*/
+    virtual IProblem* createWorkerInstance() const
+    {
+        return NULL;
+    }
+    virtual int releaseWorkerInstance()
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    /*batch of 'count' points stored one after another (count * dim doubles), values are written to 'res';
+      arguments are checked once per batch, default adapters evaluate points one by one*/
+    virtual int goalFunctionByArgsBatch(size_t count, double const* args, double* res) const
+    {
+        return goalFunctionBatch(BY_ARGS, count, args, res);
+    }
+    virtual int goalFunctionByParamsBatch(size_t count, double const* params, double* res) const
+    {
+        return goalFunctionBatch(BY_PARAMS, count, params, res);
+    }
+
+    /*whole gradient is written to 'grad' of the same dim, fused methods return value of function too;
+      default adapters take derivatives by every coordinate*/
+    virtual int gradientByArgs(IVector const* args, IVector* grad) const
+    {
+        return gradient(BY_ARGS, args, grad);
+    }
+    virtual int gradientByParams(IVector const* params, IVector* grad) const
+    {
+        return gradient(BY_PARAMS, params, grad);
+    }
+    virtual int valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const
+    {
+        int errCode = goalFunctionByArgs(args, value);
+        return errCode != ERR_OK ? errCode : gradientByArgs(args, grad);
+    }
+    virtual int valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const
+    {
+        int errCode = goalFunctionByParams(params, value);
+        return errCode != ERR_OK ? errCode : gradientByParams(params, grad);
+    }
+
+    /*Hessian matrix (dim * dim doubles) is written row by row to 'hessian'*/
+    virtual int hessianByArgs(IVector const* /*args*/, double* /*hessian*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int hessianByParams(IVector const* /*params*/, double* /*hessian*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    /*product of Hessian and 'vec' is written to 'res', default adapters build the whole Hessian*/
+    virtual int hessianVectorProductByArgs(IVector const* args, IVector const* vec, IVector* res) const
+    {
+        return hessianVectorProduct(BY_ARGS, args, vec, res);
+    }
+    virtual int hessianVectorProductByParams(IVector const* params, IVector const* vec, IVector* res) const
+    {
+        return hessianVectorProduct(BY_PARAMS, params, vec, res);
+    }
+    /*nonzero entries of upper triangle of Hessian as (rows[i], cols[i]),
+      arrays are allocated by problem and deleted by caller with delete[], they are NULL on failure*/
+    virtual int getHessianSparsity(DerivedType /*dr*/, size_t& count, size_t*& rows, size_t*& cols) const
+    {
+        count = 0;
+        rows = cols = NULL;
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+protected:
+    int goalFunctionBatch(DerivedType dr, size_t count, double const* points, double* res) const
+    {
+        size_t dim;
+        int errCode = dr == BY_ARGS ? getArgsDim(dim) : getParamsDim(dim);
+        if (errCode != ERR_OK || count == 0)
+            return errCode;
+        if (!points || !res)
+            return ERR_WRONG_ARG;
+
+        IVector* vec = IVector::createVector(dim, points);
+        if (!vec)
+            return ERR_MEMORY_ALLOCATION;
+        for (size_t i = 0; i < count && errCode == ERR_OK; i++) {
+            errCode = vec->setAllCoords(dim, const_cast<double*>(points + i * dim));
+            if (errCode == ERR_OK)
+                errCode = dr == BY_ARGS ? goalFunctionByArgs(vec, res[i]) : goalFunctionByParams(vec, res[i]);
+        }
+        delete vec;
+        return errCode;
+    }
+
+    int gradient(DerivedType dr, IVector const* point, IVector* grad) const
+    {
+        size_t dim;
+        int errCode = dr == BY_ARGS ? getArgsDim(dim) : getParamsDim(dim);
+        if (errCode != ERR_OK)
+            return errCode;
+        if (!point || !grad)
+            return ERR_WRONG_ARG;
+        if (grad->getDim() != dim)
+            return ERR_DIMENSIONS_MISMATCH;
+
+        for (size_t i = 0; i < dim && errCode == ERR_OK; i++) {
+            double value;
+            errCode = dr == BY_ARGS ? derivativeGoalFunctionByArgs(1, i, dr, value, point)
+                                    : derivativeGoalFunctionByParams(1, i, dr, value, point);
+            if (errCode == ERR_OK)
+                errCode = grad->setCoord(i, value);
+        }
+        return errCode;
+    }
+
+    int hessianVectorProduct(DerivedType dr, IVector const* point, IVector const* vec, IVector* res) const
+    {
+        size_t dim;
+        int errCode = dr == BY_ARGS ? getArgsDim(dim) : getParamsDim(dim);
+        if (errCode != ERR_OK)
+            return errCode;
+        if (!point || !vec || !res)
+            return ERR_WRONG_ARG;
+        if (vec->getDim() != dim || res->getDim() != dim)
+            return ERR_DIMENSIONS_MISMATCH;
+
+        unsigned int vecDim;
+        double const* v;
+        double* hessian = new(std::nothrow) double[dim * dim];
+        if (!hessian)
+            return ERR_MEMORY_ALLOCATION;
+        errCode = dr == BY_ARGS ? hessianByArgs(point, hessian) : hessianByParams(point, hessian);
+        if (errCode == ERR_OK)
+            errCode = vec->getCoordsPtr(vecDim, v);
+        for (size_t i = 0; i < dim && errCode == ERR_OK; i++) {
+            double sum = 0;
+            for (size_t j = 0; j < dim; j++)
+                sum += hessian[i * dim + j] * v[j];
+            errCode = res->setCoord(i, sum);
+        }
+        delete[] hessian;
+        return errCode;
+    }
+
     IProblem() = default;
 
 private:
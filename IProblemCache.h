@@ -0,0 +1,50 @@
+#ifndef IPROBLEMCACHE_H
+#define IPROBLEMCACHE_H
+
+#include "SHARED_EXPORT.h"
+
+class IBrocker;
+class IProblem;
+
+/*memoizing decorator of expensive problem: goal values and derivatives are cached by exact bits of
+  args and params, least recently used results are dropped when cache is full; lookups are locked,
+  so decorator is reentrant when wrapped problem is, and its worker instances share one cache*/
+class SHARED_EXPORT IProblemCache
+{
+public:
+    enum InterfaceTypes
+    {
+        INTERFACE_0,
+        DIMENSION_INTERFACE_IMPL
+    };
+
+    /*brocker casts to IBrocker::PROBLEM (decorator) and IBrocker::PROBLEM_CACHE (statistics);
+      'capacity' is in bytes (up to INT_MAX), every entry takes its key (point, fixed vectors and kind)
+      and its doubles: one for value, dim for gradient and dim * dim for Hessian;
+      fixed args and params of 'problem' have to be changed through decorator only;
+      release() of returned brocker doesn't release 'problem'*/
+    static IBrocker* createCache(IProblem* problem, unsigned int capacity);
+
+    virtual int getId() const = 0;
+
+    virtual int clear() = 0;
+
+    /*statistics of lookups since creation or last clear*/
+    virtual unsigned int getHits() const = 0;
+    virtual unsigned int getMisses() const = 0;
+    /*bytes of keys and values in cache now*/
+    virtual unsigned int getSize() const = 0;
+
+protected:
+    /*dtor*/
+    virtual ~IProblemCache(){}
+
+    IProblemCache() = default;
+
+private:
+    /*non default copyable*/
+    IProblemCache(const IProblemCache& other) = delete;
+    void operator=(const IProblemCache& other) = delete;
+};
+
+#endif // IPROBLEMCACHE_H
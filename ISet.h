@@ -8,16 +8,39 @@ class SHARED_EXPORT ISet
 {
 public:
 
+    /*INTERFACE_1 adds the methods declared after destructor, they follow slots of INTERFACE_0
+      in vtable, so they may be called only when getId() of set isn't less than INTERFACE_1*/
     enum InterfaceTypes
     {
         INTERFACE_0,
+        INTERFACE_1,
         DIMENSION_INTERFACE_IMPL
     };
 
+    /*points put into set in unique mode are skipped if set contains them within EPS*/
+    enum InsertMode
+    {
+        INSERT_ALL,
+        INSERT_UNIQUE,
+        DIMENSION_INSERT_MODE
+    };
+
     virtual int getId() const = 0;
 
     /*factories*/
     static ISet* createSet(unsigned int R_dim);
+    /*thread-safe set: points are spread over 'shards' locked separately, 0 is for default amount*/
+    static ISet* createConcurrentSet(unsigned int R_dim, unsigned int shards = 0);
+
+    /*archive of non-dominated points: first 'objectives' coordinates are minimized (all if 0),
+      'capacity' bounds its size by pruning the most crowded points (no bound if 0)*/
+    static ISet* createParetoSet(unsigned int R_dim, unsigned int objectives = 0, unsigned int capacity = 0);
+    /*set file is a header (magic, version, dim, count, reserved zeros)
+      followed by count * dim doubles in native byte order*/
+    /*read-only set of mapped file, its pages are shared by all processes opening it*/
+    static ISet* openMappedSet(char const* fileName);
+    /*appends points to set file, which is created if doesn't exist*/
+    static int appendToFile(char const* fileName, unsigned int dim, unsigned int count, double const* coords);
 
     virtual int put(IVector const* const item) = 0;
     virtual int get(unsigned int index, IVector*& pItem) const = 0;
@@ -26,6 +49,9 @@ public:
     virtual unsigned int getSize() const = 0;
     virtual int clear() = 0;
 
+    /*filter of points for 'removeIf', 'context' is passed as is*/
+    typedef bool (*Predicate)(double const* coords, unsigned int dim, void* context);
+
     class IIterator
     {
     public:
@@ -55,6 +81,65 @@ public:
     /*dtor*/
     virtual ~ISet(){};
 
+    /*indices of 'k' nearest points by NORM_2 sorted by distance and of points within 'radius',
+      'indices' is allocated by set and deleted by caller with delete[]*/
+    virtual int getNearest(IVector const* const /*pItem*/, unsigned int /*k*/, unsigned int*& /*indices*/, unsigned int& /*count*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int getInRadius(IVector const* const /*pItem*/, double /*radius*/, unsigned int*& /*indices*/, unsigned int& /*count*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    /*borrowed coordinates of point and of all points one after another (count * dim),
+      pointers are valid until the next change of the set*/
+    virtual int getCoordsPtr(unsigned int /*index*/, unsigned int& /*dim*/, double const*& /*coords*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int getData(unsigned int& /*count*/, unsigned int& /*dim*/, double const*& /*data*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int getCoordsPtrByIterator(IIterator const* /*pIter*/, unsigned int& /*dim*/, double const*& /*coords*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    /*batch operations over points stored one after another ('count' * dim doubles)*/
+    virtual int putMany(unsigned int /*count*/, double const* /*coords*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int exportTo(unsigned int /*bufferSize*/, double* /*buffer*/) const
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int removeIf(Predicate /*predicate*/, void* /*context*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+    virtual int remove(unsigned int /*count*/, unsigned int const* /*indices*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    /*puts item if set doesn't contain it, atomically for thread-safe sets*/
+    virtual int putUnique(IVector const* const item, bool& added)
+    {
+        bool found = false;
+        int errCode = contains(item, found);
+        if (errCode != ERR_OK)
+            return errCode;
+        added = !found;
+        return found ? ERR_OK : put(item);
+    }
+    virtual int setInsertMode(InsertMode /*mode*/)
+    {
+        return ERR_NOT_IMPLEMENTED;
+    }
+
 protected:
     ISet() = default;
 
@@ -5,6 +5,7 @@
 #include <QMessageBox>
 #include <float.h>
 #include <limits.h>
+#include <string.h>
 
 #include "controller.h"
 #include "sqlconnectiondialog.h"
@@ -383,32 +384,52 @@ void Controller::on_drawButton_clicked()
         QMessageBox::critical(this, tr("Failed to draw plot"), tr("Failed to get solution from solver."));
         return;
     }
-    IVector * iter = solution->clone();
-    if (!iter) {
+    unsigned int dim;
+    double const* coords;
+    if (solution->getCoordsPtr(dim, coords) != ERR_OK) {
         delete solution;
-        QMessageBox::critical(this, tr("Failed to draw plot"), tr("Failed to alloc memory."));
+        QMessageBox::critical(this, tr("Failed to draw plot"), tr("Failed to get value of solution point."));
+        return;
+    }
+    if ((unsigned int)axis > dim) {
+        delete solution;
+        QMessageBox::critical(this, tr("Failed to draw plot"), tr("Not supported axis."));
         return;
     }
 
+    /*points differ only by one coordinate, they are evaluated by batches;
+      problems of INTERFACE_0 have no batch methods, they get batches of one point*/
+    bool batched = _problem->getId() >= IProblem::INTERFACE_1;
+    const int BATCH_SIZE = batched ? 1024 : 1;
+    QVector<double> batch(BATCH_SIZE * dim);
+    for (int j = 0; j < BATCH_SIZE; j++)
+        memcpy(batch.data() + j * dim, coords, dim * sizeof(double));
+
     int ec;
     for (double X = a; X <= b; X += h)
+        x[i++] = X;
+    for (int first = 0; first < i; first += BATCH_SIZE)
     {
-        iter->setCoord(axis - 1, X);
-        x[i] = X;
-        if (_solve_by_args) {
-            ec = _problem->goalFunctionByArgs(iter, y[i]);
+        int count = qMin(BATCH_SIZE, i - first);
+        for (int j = 0; j < count; j++)
+            batch[j * dim + axis - 1] = x[first + j];
+        if (!batched) {
+            IVector * point = IVector::createVector(dim, batch.constData());
+            ec = point ? ERR_OK : ERR_MEMORY_ALLOCATION;
+            if (ec == ERR_OK)
+                ec = _solve_by_args ? _problem->goalFunctionByArgs(point, y[first]) : _problem->goalFunctionByParams(point, y[first]);
+            delete point;
+        } else if (_solve_by_args) {
+            ec = _problem->goalFunctionByArgsBatch(count, batch.constData(), y.data() + first);
         } else {
-            ec = _problem->goalFunctionByParams(iter, y[i]);
+            ec = _problem->goalFunctionByParamsBatch(count, batch.constData(), y.data() + first);
         }
         if (ec != ERR_OK) {
             delete solution;
-            delete iter;
             QMessageBox::critical(this, tr("Failed to draw plot"), tr("Failed to get value of goal function."));
             return;
         }
-        i++;
     }
-    delete iter;
     if (solution->getCoord(axis - 1, px[0]) != ERR_OK) {
         delete solution;
         QMessageBox::critical(this, tr("Failed to draw plot"), tr("Failed to get value of solution point."));
@@ -5,7 +5,8 @@ QMAKE_CXXFLAGS += -std=gnu++0x
 TARGET = optimization-solver
 TEMPLATE = app
 
-LIBS += debug/log.dll debug/vector.dll debug/compact.dll debug/set.dll
+# compact and set are built into dll/ by src/src.pro
+LIBS += $$PWD/dll/log.dll $$PWD/dll/vector.dll $$PWD/dll/compact.dll $$PWD/dll/set.dll
 
 SOURCES += main.cpp \
     controller.cpp \
@@ -22,6 +23,10 @@ HEADERS  += \
     IProblem.h \
     ILog.h \
     ICompact.h \
+    ILatticeCache.h \
+    IPrioritySet.h \
+    IProblemCache.h \
+    Dual.h \
     IBrocker.h \
     error.h \
     controller.h \
@@ -1,6 +1,7 @@
 #include <stdint.h>
 #include <math.h>
 #include <iostream>
+#include <algorithm>
 #include <qvector.h>
 #include <qlist.h>
 
@@ -10,10 +11,69 @@
 #define nullptr 0
 
 namespace {
+	// initial direction numbers of Sobol sequence (Joe and Kuo) for dimensions 2, 3, ...
+	struct SobolInit
+	{
+		unsigned degree;		// degree of primitive polynomial
+		unsigned polynomial;	// inner coefficients of primitive polynomial
+		unsigned m[7];			// initial direction numbers
+	};
+
+	SobolInit const SOBOL_INIT[] =
+	{
+		{1, 0,  {1}},
+		{2, 1,  {1, 3}},
+		{3, 1,  {1, 3, 1}},
+		{3, 2,  {1, 1, 1}},
+		{4, 1,  {1, 1, 3, 3}},
+		{4, 4,  {1, 3, 5, 13}},
+		{5, 2,  {1, 1, 5, 5, 17}},
+		{5, 4,  {1, 1, 5, 5, 5}},
+		{5, 7,  {1, 1, 7, 11, 19}},
+		{5, 11, {1, 1, 5, 1, 1}},
+		{5, 13, {1, 1, 1, 3, 11}},
+		{5, 14, {1, 3, 5, 5, 31}},
+		{6, 1,  {1, 3, 3, 9, 7, 49}},
+		{6, 13, {1, 1, 1, 15, 21, 21}},
+		{6, 16, {1, 3, 1, 13, 27, 49}},
+		{6, 19, {1, 1, 1, 15, 7, 5}},
+		{6, 22, {1, 3, 1, 15, 13, 25}},
+		{6, 25, {1, 1, 5, 5, 19, 61}},
+		{7, 1,  {1, 3, 7, 11, 23, 15, 103}},
+		{7, 4,  {1, 3, 7, 13, 13, 15, 69}}
+	};
+
+	unsigned const SOBOL_BITS = 32;
+	unsigned const SOBOL_MAX_DIM = sizeof(SOBOL_INIT) / sizeof(SOBOL_INIT[0]) + 1;
+
+	// axis-aligned box used by set operations
+	struct Box
+	{
+		QVector<double> begin;
+		QVector<double> end;
+	};
+
+	enum Operation
+	{
+		OPERATION_INTERSECTION,
+		OPERATION_UNION,
+		OPERATION_DIFFERENCE,
+		OPERATION_SYM_DIFFERENCE
+	};
+
 	class Compact : public ICompact
 	{
 	public:
-		class CompactIterator : public ICompact::IIterator
+		// base of all compact iterators, gives access to the current point
+		class BaseIterator : public ICompact::IIterator
+		{
+		public:
+			BaseIterator(Compact const *compact, unsigned pos, IVector const *step);
+
+			virtual IVector* getPoint() const = 0;
+		}; // end BaseIterator
+
+		class CompactIterator : public BaseIterator
 		{
 		public:
 			CompactIterator(Compact const *compact, unsigned pos, IVector *step = nullptr);
@@ -24,14 +84,45 @@ namespace {
 
 			// other utility methods:
 			IVector* getPoint() const;
+			unsigned getPos() const;
+			void setPos(unsigned pos);
 
 		private:
 			Compact const* _compact;	// compact for iterating
 			IVector *_step;				// step (only for non-default behaviour)
 			unsigned _pos;				// current position in compact
+			unsigned _lastIndex;		// index of the last point in current order of compact
+			QVector<unsigned> _counters;// buffer for decoding Morton indices
 		}; // end CompactIterator
 
+		class SequenceIterator : public BaseIterator
+		{
+		public:
+			SequenceIterator(Compact const *compact, SequenceType type, unsigned first, unsigned stride);
+
+			// IIterator intarface methods:
+			int setStep(IVector const* const step);
+			int doStep();
+
+			// other utility methods:
+			IVector* getPoint() const;
+			int init();
+
+		private:
+			void setSobolState();
+			double radicalInverse(unsigned base, unsigned index) const;
+
+			Compact const* _compact;		// compact for iterating
+			SequenceType _type;				// type of low-discrepancy sequence
+			unsigned _index;				// index of current point in sequence
+			unsigned _stride;				// distance between indices of visited points
+			QVector<unsigned> _directions;	// Sobol direction numbers, SOBOL_BITS per axis
+			QVector<unsigned> _sobolState;	// Sobol integer coordinates of current point
+			QVector<unsigned> _bases;		// Halton prime bases, one per axis
+		}; // end SequenceIterator
+
 		static unsigned const MAX_POINTS_AMOUNT = UINT_MAX;
+		static unsigned const MAX_INDEX_BITS = 32;
 		static unsigned const PRECISION_DIVIDER = 1000;
 		static double const DOUBLE_EPS = 1e-8;
 
@@ -41,7 +132,9 @@ namespace {
 		IVector *_pointEnd;					 // "top-right" corner
 		IVector *_samplingValues;			 // values of distance between the points by every axis
 		QVector<unsigned> _samplingCounters; // amounts of points by every axis
-		QList<CompactIterator*> _iterators;	 // list of iterators
+		IndexOrder _order;					 // order of indices of points
+		QVector<unsigned> _mortonBits;		 // bits of Morton index by every axis
+		QList<BaseIterator*> _iterators;	 // list of iterators
 
 		Compact(IVector *begin, IVector *end, IVector *samplingValues, QVector<unsigned> &samplingCounters);
 		~Compact();
@@ -51,23 +144,102 @@ namespace {
 
 		int getId() const;
 		int getNearestNeighbor(IVector const* vec, IVector *& nn) const;
+		int getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const;
 		int isContains(IVector const* const vec, bool& result) const;
-		int isSubSet(ICompact const* const other) const;
+		int isSubSet(ICompact const* const other, bool& result) const;
+		using ICompact::isSubSet;
+		int isIntersects(ICompact const* const other, bool& result) const;
+		int getBoundingBox(IVector *& begin, IVector *& end) const;
+		int getIndexByPoint(IVector const* const vec, unsigned &result) const;
+		IVector* getPointByIndex(unsigned index) const;
+		int setIndexOrder(IndexOrder order);
+
+		int Intersection(ICompact const& c);
+		int Union(ICompact const& c);
+		int Difference(ICompact const& c);
+		int SymDifference(ICompact const& c);
 
 		IIterator* begin(IVector const* const step);
 		IIterator* end(IVector const* const step = 0);
+		IIterator* beginSequence(SequenceType type, unsigned first = 0, unsigned stride = 1);
 		int getByIterator(IIterator const* pIter, IVector*& pItem) const;
 		int deleteIterator(IIterator *pIter);
 
 		// other utility methods:
+		int applyOperation(Operation operation, ICompact const& c);
+		int assignBox(Box const& box, QVector<double> const& spacing);
+		int getBox(Box& box) const;
+		int getSamplingValues(QVector<double>& spacing) const;
 		int isSamplingContains(IVector const *vec, bool& result) const;
 		int checkStepCorrectness(IVector const *step) const;
 		bool vectorPrecisionEquals(IVector const *v1, IVector const *v2) const;
 		int findIterator(IIterator const *iterator) const;
-
-		int getIndexByPoint(IVector const *vec, unsigned &result) const;
-		IVector* getPointByIndex(unsigned index) const;
+		unsigned encodeIndex(QVector<unsigned> const &counters) const;
+		bool decodeIndex(unsigned index, QVector<unsigned> &counters) const;
+		unsigned getLastIndex() const;
+		static int getMortonBits(QVector<unsigned> const &samplingCounters, QVector<unsigned> &bits);
 	};// end Compact
+
+	// union of boxes with disjoint interiors, produced by set operations over compacts
+	class CompactUnion : public ICompact
+	{
+	public:
+		class UnionIterator : public ICompact::IIterator
+		{
+		public:
+			UnionIterator(CompactUnion const *compactUnion, int box, IIterator *boxIterator, IVector *step);
+			~UnionIterator();
+
+			// IIterator intarface methods:
+			int setStep(IVector const* const step);
+			int doStep();
+
+			// other utility methods:
+			int nextPoint();
+			int isVisited(bool& result) const;
+
+			CompactUnion const* _union;	// union for iterating
+			int _box;					// index of current box
+			IIterator *_boxIterator;	// iterator over current box
+			IVector *_step;				// step (only for non-default behaviour)
+		}; // end UnionIterator
+
+		unsigned _dim;						// dimension of vectors in compact
+		QVector<double> _spacing;			// distance between the points of boxes by every axis
+		QList<Compact*> _boxes;				// boxes of union
+		QList<UnionIterator*> _iterators;	// list of iterators
+
+		CompactUnion(unsigned dim, QVector<double> const &spacing, QList<Compact*> const &boxes);
+		~CompactUnion();
+
+		// ICompact intarface methods:
+		ICompact* clone() const;
+
+		int getId() const;
+		int getNearestNeighbor(IVector const* vec, IVector *& nn) const;
+		int getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const;
+		int isContains(IVector const* const vec, bool& result) const;
+		int isSubSet(ICompact const* const other, bool& result) const;
+		using ICompact::isSubSet;
+		int isSimplyConn(bool& result) const;
+		int isIntersects(ICompact const* const other, bool& result) const;
+		int getBoundingBox(IVector *& begin, IVector *& end) const;
+
+		int Intersection(ICompact const& c);
+		int Union(ICompact const& c);
+		int Difference(ICompact const& c);
+		int SymDifference(ICompact const& c);
+
+		IIterator* begin(IVector const* const step);
+		IIterator* end(IVector const* const step = 0);
+		int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+		int deleteIterator(IIterator *pIter);
+
+		// other utility methods:
+		int applyOperation(Operation operation, ICompact const& c);
+		int findIterator(IIterator const *iterator) const;
+		UnionIterator* createIterator(int box, bool atEnd, IVector const *step);
+	};// end CompactUnion
 }// end anonymous namespace
 
 
@@ -241,564 +413,1976 @@ ICompact* ICompact::createCompact(IVector const* const begin, IVector const* con
 }// end factory method
 
 
-Compact::Compact(IVector *begin, IVector *end, IVector *samplingValues, QVector<unsigned> &samplingCounters) : _samplingCounters(samplingCounters)
+// intersection of closed boxes, returns false if boxes don't intersect
+bool intersectBoxes(Box const &left, Box const &right, Box &result)
 {
-	_pointBegin = begin;
-	_pointEnd = end;
-	_samplingValues = samplingValues;
-	_dim = begin->getDim();
-	_pointsAmount = 1;
-	for (unsigned i = 0; i < _dim; i++)
-	{
-		_pointsAmount *= _samplingCounters[i];
+	int dim = left.begin.size();
+	result.begin.resize(dim);
+	result.end.resize(dim);
+	for (int i = 0; i < dim; i++)
+	{
+		result.begin[i] = std::max(left.begin[i], right.begin[i]);
+		result.end[i] = std::min(left.end[i], right.end[i]);
+		if (result.begin[i] > result.end[i] + Compact::DOUBLE_EPS)
+		{
+			return false;
+		}
+		if (result.begin[i] > result.end[i])
+		{
+			result.end[i] = result.begin[i];
+		}
 	}
-}
+	return true;
+}// end intersectBoxes
 
-Compact::~Compact()
+bool boxContains(Box const &outer, Box const &inner)
 {
-	delete _pointBegin;
-	delete _pointEnd;
-	delete _samplingValues;
-	for (int i = 0; i < _iterators.count(); i++)
+	for (int i = 0; i < outer.begin.size(); i++)
 	{
-		if (_iterators[i])
+		if (inner.begin[i] < outer.begin[i] - Compact::DOUBLE_EPS || inner.end[i] > outer.end[i] + Compact::DOUBLE_EPS)
 		{
-			delete _iterators[i];
+			return false;
 		}
 	}
+	return true;
 }
 
-ICompact* Compact::clone() const
+bool boxContainsPoint(Box const &box, IVector const *vec)
 {
-	double *counters = new(std::nothrow) double[_dim];
-	IVector *step;
-	ICompact *compact;
-	if (!counters)
-	{
-		ILog::report("ICompact::clone: failed with memory allocation\n");
-		return nullptr;
-	}
-	for (unsigned i = 0; i < _dim; i++)
+	unsigned dim;
+	double const *coords;
+	if (vec->getCoordsPtr(dim, coords) != ERR_OK || static_cast<int>(dim) != box.begin.size())
 	{
-		counters[i] = _samplingCounters[i];
+		return false;
 	}
-	step = IVector::createVector(_dim, counters);
-	if (!step)
+	for (unsigned i = 0; i < dim; i++)
 	{
-		ILog::report("ICompact::clone: failed to create step vector, continue with default sampling\n");
+		if (coords[i] < box.begin[i] - Compact::DOUBLE_EPS || coords[i] > box.end[i] + Compact::DOUBLE_EPS)
+		{
+			return false;
+		}
 	}
-	compact = createCompact(_pointBegin, _pointEnd, step);
-	delete[] counters;
-	delete step;
-	return compact;
-}// end clone
-
-int Compact::getId() const
-{
-	return ICompact::INTERFACE_0;
+	return true;
 }
 
-int Compact::getNearestNeighbor(IVector const* vec, IVector *& nn) const
+// appends closure of 'left \ right' to 'pieces' as boxes with disjoint interiors
+void subtractBox(Box const &left, Box const &right, QList<Box> &pieces)
 {
-	double coordBegin = 0.0, coordEnd = 0.0, coordVec = 0.0, samplingVal = 0.0;
-	IVector *neighbor;
-	if (!vec)
+	int dim = left.begin.size();
+	for (int i = 0; i < dim; i++)
 	{
-		ILog::report("ICompact::getNearestNeighbor: nullptr in 'vec' param\n");
-		return ERR_WRONG_ARG;
+		double overlap = std::min(left.end[i], right.end[i]) - std::max(left.begin[i], right.begin[i]);
+		// if interiors don't overlap then difference is the whole 'left' box
+		if (overlap < -Compact::DOUBLE_EPS || (overlap <= Compact::DOUBLE_EPS && left.end[i] - left.begin[i] > Compact::DOUBLE_EPS))
+		{
+			pieces.append(left);
+			return;
+		}
 	}
-	if (vec->getDim() != _dim)
+	// cut off slabs of 'left' lying out of 'right' axis by axis
+	Box rest = left;
+	for (int i = 0; i < dim; i++)
 	{
-		ILog::report("ICompact::getNearestNeighbor: dimensions mismatch in 'vec' param\n");
-		return ERR_DIMENSIONS_MISMATCH;
+		if (rest.begin[i] < right.begin[i] - Compact::DOUBLE_EPS)
+		{
+			Box piece = rest;
+			piece.end[i] = right.begin[i];
+			pieces.append(piece);
+			rest.begin[i] = right.begin[i];
+		}
+		if (rest.end[i] > right.end[i] + Compact::DOUBLE_EPS)
+		{
+			Box piece = rest;
+			piece.begin[i] = right.end[i];
+			pieces.append(piece);
+			rest.end[i] = right.end[i];
+		}
 	}
+}// end subtractBox
 
-	double *nnValues = new(std::nothrow) double[_dim];
-	if (!nnValues)
+// merges 'right' into 'left' if they differ only by one axis and touch by it
+bool mergeBoxes(Box &left, Box const &right)
+{
+	int axis = -1;
+	for (int i = 0; i < left.begin.size(); i++)
 	{
-		ILog::report("ICompact::getNearestNeighbor: failed with memory allocation\n");
-		return ERR_MEMORY_ALLOCATION;
+		if (fabs(left.begin[i] - right.begin[i]) > Compact::DOUBLE_EPS || fabs(left.end[i] - right.end[i]) > Compact::DOUBLE_EPS)
+		{
+			if (axis >= 0)
+			{
+				return false;
+			}
+			axis = i;
+		}
+	}
+	if (axis < 0 || left.begin[axis] > right.end[axis] + Compact::DOUBLE_EPS || right.begin[axis] > left.end[axis] + Compact::DOUBLE_EPS)
+	{
+		return false;
 	}
+	left.begin[axis] = std::min(left.begin[axis], right.begin[axis]);
+	left.end[axis] = std::max(left.end[axis], right.end[axis]);
+	return true;
+}// end mergeBoxes
 
-	for (unsigned i = 0; i < _dim; i++)
+// removes boxes covered by other boxes and merges neighbouring boxes
+void normalizeBoxes(QList<Box> &boxes)
+{
+	bool changed = true;
+	while (changed)
 	{
-		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _pointEnd->getCoord(i, coordEnd) != ERR_OK)
+		changed = false;
+		for (int i = 0; i < boxes.size() && !changed; i++)
 		{
-			ILog::report("ICompact::getNearestNeighbor: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
-			delete[] nnValues;
-			return ERR_ANY_OTHER;
+			for (int j = 0; j < boxes.size() && !changed; j++)
+			{
+				if (i != j && (boxContains(boxes[i], boxes[j]) || mergeBoxes(boxes[i], boxes[j])))
+				{
+					boxes.removeAt(j);
+					changed = true;
+				}
+			}
 		}
-		if (_samplingValues->getCoord(i, samplingVal) != ERR_OK || vec->getCoord(i, coordVec) != ERR_OK)
+	}
+}// end normalizeBoxes
+
+void subtractBoxes(QList<Box> const &left, QList<Box> const &right, QList<Box> &result)
+{
+	result = left;
+	for (int j = 0; j < right.size(); j++)
+	{
+		QList<Box> pieces;
+		for (int i = 0; i < result.size(); i++)
 		{
-			ILog::report("ICompact::getNearestNeighbor: failed to get coords from '_samplingValues' or from 'vec'\n");
-			delete[] nnValues;
-			return ERR_ANY_OTHER;
+			subtractBox(result[i], right[j], pieces);
 		}
+		result = pieces;
+	}
+}
 
-		// if current coordinate is bigger than the begin point
-		if (coordVec > coordBegin)
+void applyBoxesOperation(Operation operation, QList<Box> const &left, QList<Box> const &right, QList<Box> &result)
+{
+	QList<Box> pieces;
+	Box box;
+	result.clear();
+	switch (operation)
+	{
+	case OPERATION_INTERSECTION:
+		for (int i = 0; i < left.size(); i++)
 		{
-			// if current coordinate is bigger than the end point
-			if (coordVec > coordEnd)
+			for (int j = 0; j < right.size(); j++)
 			{
-				nnValues[i] = coordEnd;
-			}
-			// if current coordinate is between the begin and the end points
-			else
-			{
-				nnValues[i] = coordBegin + round((coordVec - coordBegin) / samplingVal) * samplingVal;
+				if (intersectBoxes(left[i], right[j], box))
+				{
+					result.append(box);
+				}
 			}
 		}
-		// if current coordinate is less (or equals) than the begin point
-		else
-		{
-			nnValues[i] = coordBegin;
-		}
+		break;
+	case OPERATION_UNION:
+		subtractBoxes(right, left, pieces);
+		result = left;
+		result += pieces;
+		break;
+	case OPERATION_DIFFERENCE:
+		subtractBoxes(left, right, result);
+		break;
+	case OPERATION_SYM_DIFFERENCE:
+		subtractBoxes(left, right, result);
+		subtractBoxes(right, left, pieces);
+		result += pieces;
+		break;
 	}
+	normalizeBoxes(result);
+}// end applyBoxesOperation
 
-	neighbor = IVector::createVector(_dim, nnValues);
-	delete[] nnValues;
-	if (neighbor)
+// gets boxes and sampling values of compact, only boxes and unions of boxes are supported
+int getBoxes(ICompact const *compact, QList<Box> &boxes, QVector<double> &spacing)
+{
+	int errCode;
+	Box box;
+	Compact const *boxCompact = dynamic_cast<Compact const*>(compact);
+	CompactUnion const *compactUnion = dynamic_cast<CompactUnion const*>(compact);
+	if (boxCompact)
 	{
-		nn = neighbor;
-		return ERR_OK;
+		if ((errCode = boxCompact->getBox(box)) != ERR_OK)
+		{
+			return errCode;
+		}
+		boxes.append(box);
+		return boxCompact->getSamplingValues(spacing);
 	}
-	else
+	if (compactUnion)
 	{
-		ILog::report("ICompact::getNearestNeighbor: failed to create neighbor\n");
-		return ERR_MEMORY_ALLOCATION;
+		for (int i = 0; i < compactUnion->_boxes.size(); i++)
+		{
+			if ((errCode = compactUnion->_boxes[i]->getBox(box)) != ERR_OK)
+			{
+				return errCode;
+			}
+			boxes.append(box);
+		}
+		spacing = compactUnion->_spacing;
+		return ERR_OK;
 	}
-}// end getNearestNeighbor
+	ILog::report("getBoxes: only boxes and unions of boxes are supported\n");
+	return ERR_NOT_IMPLEMENTED;
+}// end getBoxes
 
-int Compact::isContains(IVector const* const vec, bool& result) const
+// gets boxes of both operands and the finest sampling values of them
+int getOperandsBoxes(ICompact const *left, ICompact const *right, QList<Box> &leftBoxes, QList<Box> &rightBoxes, QVector<double> &spacing)
 {
-	double coordBegin = 0.0, coordEnd = 0.0, coordVec = 0.0;
-	if (!vec)
+	int errCode;
+	QVector<double> rightSpacing;
+	if (!left || !right)
 	{
-		ILog::report("ICompact::isContains: nullptr in 'vec' param\n");
+		ILog::report("getOperandsBoxes: nullptr compact\n");
 		return ERR_WRONG_ARG;
 	}
-	if (vec->getDim() != _dim)
+	if ((errCode = getBoxes(left, leftBoxes, spacing)) != ERR_OK || (errCode = getBoxes(right, rightBoxes, rightSpacing)) != ERR_OK)
 	{
-		ILog::report("ICompact::isContains: dimensions mismatch in 'vec' param\n");
+		ILog::report("getOperandsBoxes: failed to get boxes of compacts\n");
+		return errCode;
+	}
+	if (spacing.size() != rightSpacing.size())
+	{
+		ILog::report("getOperandsBoxes: dimensions mismatch\n");
 		return ERR_DIMENSIONS_MISMATCH;
 	}
-
-	for (unsigned i = 0; i < _dim; i++)
+	for (int i = 0; i < spacing.size(); i++)
 	{
-		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _pointEnd->getCoord(i, coordEnd) != ERR_OK)
-		{
-			ILog::report("ICompact::isContains: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
-			return ERR_ANY_OTHER;
-		}
-		if (vec->getCoord(i, coordVec) != ERR_OK)
-		{
-			ILog::report("ICompact::isContains: failed to get coord from 'vec'\n");
-			return ERR_ANY_OTHER;
-		}
-		if (!(coordVec >= coordBegin && coordVec <= coordEnd))
+		if (spacing[i] <= Compact::DOUBLE_EPS || (rightSpacing[i] > Compact::DOUBLE_EPS && rightSpacing[i] < spacing[i]))
 		{
-			result = false;
-			return ERR_OK;
+			spacing[i] = rightSpacing[i];
 		}
 	}
-	result = true;
 	return ERR_OK;
-} // end isContains
+}// end getOperandsBoxes
 
-int Compact::isSubSet(ICompact const* const other) const
+// creates box compact with sampling as close as possible to 'spacing'
+Compact* createBoxCompact(Box const &box, QVector<double> const &spacing)
 {
-	ILog::report("ICompact::isSubSet: ERR_NOT_IMPLEMENTED\n");
-	Q_ASSERT(ERR_NOT_IMPLEMENTED);
-	return ERR_NOT_IMPLEMENTED;
-}
-
-ICompact::IIterator* Compact::begin(IVector const* const step)
-{
-	CompactIterator *iterator;
-	IVector* stepClone;
-	if (!step)
-	{
-		iterator = new(std::nothrow) CompactIterator(this, 0);
-	}
-	else
+	int dim = box.begin.size();
+	double width, pointsAmount = 1.0;
+	QVector<double> counters(dim);
+	IVector *begin, *end, *step = nullptr;
+	ICompact *compact;
+	for (int i = 0; i < dim; i++)
 	{
-		if (checkStepCorrectness(step) != ERR_OK)
+		width = box.end[i] - box.begin[i];
+		if (width <= Compact::DOUBLE_EPS)
 		{
-			ILog::report("ICompact::begin: not correct 'step' param\n");
-			return nullptr;
+			counters[i] = 1.0;
 		}
-		if (!(stepClone = step->clone()))
+		else if (spacing[i] <= Compact::DOUBLE_EPS)
 		{
-			ILog::report("ICompact::begin: failed to clone 'step' param\n");
-			return nullptr;
+			counters[i] = 2.0;
 		}
-		iterator = new(std::nothrow) CompactIterator(this, 0, stepClone);
+		else
+		{
+			counters[i] = std::max(2.0, round(width / spacing[i]) + 1.0);
+		}
+		pointsAmount *= counters[i];
 	}
-	if (iterator)
+	begin = IVector::createVector(dim, box.begin.constData());
+	end = IVector::createVector(dim, box.end.constData());
+	// too fine sampling falls back to default one
+	if (pointsAmount <= static_cast<double>(Compact::MAX_POINTS_AMOUNT))
 	{
-		_iterators.append(iterator);
+		step = IVector::createVector(dim, counters.constData());
 	}
-	else
+	if (!begin || !end)
 	{
-		ILog::report("ICompact::begin: failed to create iterator\n");
+		ILog::report("createBoxCompact: failed to create corners of box\n");
+		delete begin;
+		delete end;
+		delete step;
+		return nullptr;
 	}
-	return iterator;
-}
+	compact = ICompact::createCompact(begin, end, step);
+	delete begin;
+	delete end;
+	delete step;
+	return static_cast<Compact*>(compact);
+}// end createBoxCompact
 
-ICompact::IIterator* Compact::end(IVector const* const step)
+ICompact* createBoxesCompact(QList<Box> const &boxes, QVector<double> const &spacing)
 {
-	CompactIterator *iterator;
-	IVector* stepClone;
-	if (!step)
+	QList<Compact*> compacts;
+	Compact *compact;
+	ICompact *result;
+	if (boxes.size() == 1)
 	{
-		iterator = new(std::nothrow) CompactIterator(this, _pointsAmount - 1);
+		return createBoxCompact(boxes[0], spacing);
 	}
-	else
+	for (int i = 0; i < boxes.size(); i++)
 	{
-		if (checkStepCorrectness(step) != ERR_OK)
+		if (!(compact = createBoxCompact(boxes[i], spacing)))
 		{
-			ILog::report("ICompact::end: not correct 'step' param\n");
-			return nullptr;
+			ILog::report("createBoxesCompact: failed to create box\n");
+			for (int j = 0; j < compacts.size(); j++)
+			{
+				delete compacts[j];
+			}
+			return nullptr;
 		}
-		if (!(stepClone = step->clone()))
+		compacts.append(compact);
+	}
+	// empty result is union without boxes
+	if (!(result = new(std::nothrow) CompactUnion(spacing.size(), spacing, compacts)))
+	{
+		ILog::report("createBoxesCompact: failed to create union of boxes\n");
+		for (int j = 0; j < compacts.size(); j++)
 		{
-			ILog::report("ICompact::end: failed to clone 'step' param\n");
-			return nullptr;
+			delete compacts[j];
 		}
-		iterator = new(std::nothrow) CompactIterator(this, _pointsAmount - 1, stepClone);
 	}
-	if (iterator)
+	return result;
+}// end createBoxesCompact
+
+ICompact* createByOperation(Operation operation, ICompact const *left, ICompact const *right)
+{
+	QList<Box> leftBoxes, rightBoxes, result;
+	QVector<double> spacing;
+	if (getOperandsBoxes(left, right, leftBoxes, rightBoxes, spacing) != ERR_OK)
 	{
-		_iterators.append(iterator);
+		return nullptr;
 	}
-	else
+	applyBoxesOperation(operation, leftBoxes, rightBoxes, result);
+	return createBoxesCompact(result, spacing);
+}
+
+int isSubSetByBoxes(ICompact const *compact, ICompact const *other, bool &result)
+{
+	QList<Box> boxes, otherBoxes, rest;
+	QVector<double> spacing;
+	int errCode = getOperandsBoxes(compact, other, boxes, otherBoxes, spacing);
+	if (errCode != ERR_OK)
 	{
-		ILog::report("ICompact::end: failed to create iterator\n");
+		return errCode;
 	}
-	return iterator;
+	subtractBoxes(boxes, otherBoxes, rest);
+	result = rest.isEmpty();
+	return ERR_OK;
 }
 
-int Compact::getByIterator(IIterator const* pIter, IVector*& pItem) const
+int isIntersectsByBoxes(ICompact const *compact, ICompact const *other, bool &result)
 {
-	IVector *point;
-	int index = findIterator(pIter);
-	if (index < 0)
+	QList<Box> boxes, otherBoxes;
+	QVector<double> spacing;
+	Box box;
+	int errCode = getOperandsBoxes(compact, other, boxes, otherBoxes, spacing);
+	if (errCode != ERR_OK)
 	{
-		ILog::report("ICompact::getByIterator: failed to find iterator\n");
-		return ERR_WRONG_ARG;
+		return errCode;
 	}
-	if (!(point = _iterators[index]->getPoint()))
+	result = false;
+	for (int i = 0; i < boxes.size() && !result; i++)
 	{
-		ILog::report("ICompact::getByIterator: failed to get point from iterator\n");
-		return ERR_ANY_OTHER;
+		for (int j = 0; j < otherBoxes.size() && !result; j++)
+		{
+			result = intersectBoxes(boxes[i], otherBoxes[j], box);
+		}
 	}
-	pItem = point;
 	return ERR_OK;
 }
 
-int Compact::deleteIterator(IIterator * pIter)
+ICompact* ICompact::Intersection(ICompact const* const left, ICompact const* const right)
 {
-	int index = findIterator(pIter);
-	if (index < 0)
+	ICompact *result = createByOperation(OPERATION_INTERSECTION, left, right);
+	if (!result)
 	{
-		ILog::report("ICompact::deleteIterator: failed to find iterator\n");
-		return ERR_WRONG_ARG;
+		ILog::report("ICompact::Intersection: failed to intersect compacts\n");
 	}
-	if (_iterators[index])
+	return result;
+}
+
+ICompact* ICompact::Union(ICompact const* const left, ICompact const* const right)
+{
+	ICompact *result = createByOperation(OPERATION_UNION, left, right);
+	if (!result)
 	{
-		delete _iterators[index];
+		ILog::report("ICompact::Union: failed to unite compacts\n");
 	}
-	_iterators.removeAt(index);
-	return ERR_OK;
+	return result;
 }
 
-int Compact::isSamplingContains(IVector const *vec, bool& result) const
+ICompact* ICompact::Difference(ICompact const* const left, ICompact const* const right)
 {
-	int errCode;
-	if (!vec)
+	ICompact *result = createByOperation(OPERATION_DIFFERENCE, left, right);
+	if (!result)
 	{
-		ILog::report("isSampligContains: nullptr in 'vec' param\n");
-		return ERR_WRONG_ARG;
+		ILog::report("ICompact::Difference: failed to subtract compacts\n");
 	}
-	if (vec->getDim() != _dim)
+	return result;
+}
+
+ICompact* ICompact::SymDifference(ICompact const* const left, ICompact const* const right)
+{
+	ICompact *result = createByOperation(OPERATION_SYM_DIFFERENCE, left, right);
+	if (!result)
 	{
-		ILog::report("isSampligContains: dimensions mismatch in 'vec' param\n");
-		return ERR_DIMENSIONS_MISMATCH;
+		ILog::report("ICompact::SymDifference: failed to subtract compacts symmetrically\n");
 	}
+	return result;
+}
 
-	IVector *neighbor = nullptr;
-	if ((errCode = getNearestNeighbor(vec, neighbor)) == ERR_OK)
+
+Compact::Compact(IVector *begin, IVector *end, IVector *samplingValues, QVector<unsigned> &samplingCounters) : _samplingCounters(samplingCounters)
+{
+	_pointBegin = begin;
+	_pointEnd = end;
+	_samplingValues = samplingValues;
+	_dim = begin->getDim();
+	_order = ORDER_ROW_MAJOR;
+	_pointsAmount = 1;
+	for (unsigned i = 0; i < _dim; i++)
 	{
-		result = vectorPrecisionEquals(vec, neighbor);
+		_pointsAmount *= _samplingCounters[i];
 	}
-	else
+}
+
+Compact::~Compact()
+{
+	delete _pointBegin;
+	delete _pointEnd;
+	delete _samplingValues;
+	for (int i = 0; i < _iterators.count(); i++)
 	{
-		ILog::report("isSampligContains: failed to get neagers neighbor\n");
+		if (_iterators[i])
+		{
+			delete _iterators[i];
+		}
 	}
-	delete neighbor;
-	return errCode;
-} // end isContains
+}
 
-int Compact::checkStepCorrectness(IVector const *step) const
+ICompact* Compact::clone() const
 {
-	double coordStep = 0.0, samplingVal = 0.0;
-	int errCode;
+	double *counters = new(std::nothrow) double[_dim];
+	IVector *step;
+	ICompact *compact;
+	if (!counters)
+	{
+		ILog::report("ICompact::clone: failed with memory allocation\n");
+		return nullptr;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		counters[i] = _samplingCounters[i];
+	}
+	step = IVector::createVector(_dim, counters);
 	if (!step)
 	{
+		ILog::report("ICompact::clone: failed to create step vector, continue with default sampling\n");
+	}
+	compact = createCompact(_pointBegin, _pointEnd, step);
+	delete[] counters;
+	delete step;
+	if (compact && compact->setIndexOrder(_order) != ERR_OK)
+	{
+		ILog::report("ICompact::clone: failed to set index order, continue with row-major order\n");
+	}
+	return compact;
+}// end clone
+
+int Compact::getId() const
+{
+	return ICompact::INTERFACE_1;
+}
+
+int Compact::getNearestNeighbor(IVector const* vec, IVector *& nn) const
+{
+	return getProjection(vec, PROJECTION_LATTICE, nn);
+}
+
+int Compact::getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const
+{
+	double coordBegin = 0.0, coordEnd = 0.0, coordVec = 0.0, samplingVal = 0.0;
+	IVector *neighbor;
+	if (!vec)
+	{
+		ILog::report("ICompact::getProjection: nullptr in 'vec' param\n");
 		return ERR_WRONG_ARG;
 	}
-	if (step->getDim() != _dim)
+	if (vec->getDim() != _dim)
 	{
-		ILog::report("checkStepCorrectness: dimensions mismatch in 'step' param\n");
+		ILog::report("ICompact::getProjection: dimensions mismatch in 'vec' param\n");
 		return ERR_DIMENSIONS_MISMATCH;
 	}
+	if (type != PROJECTION_LATTICE && type != PROJECTION_CONTINUOUS)
+	{
+		ILog::report("ICompact::getProjection: wrong projection type\n");
+		return ERR_WRONG_ARG;
+	}
+
+	double *nnValues = new(std::nothrow) double[_dim];
+	if (!nnValues)
+	{
+		ILog::report("ICompact::getProjection: failed with memory allocation\n");
+		return ERR_MEMORY_ALLOCATION;
+	}
+
 	for (unsigned i = 0; i < _dim; i++)
 	{
-		if ((errCode = step->getCoord(i, coordStep)) != ERR_OK)
+		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _pointEnd->getCoord(i, coordEnd) != ERR_OK)
 		{
-			return errCode;
+			ILog::report("ICompact::getProjection: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
+			delete[] nnValues;
+			return ERR_ANY_OTHER;
 		}
-		if ((errCode = _samplingValues->getCoord(i, samplingVal)) != ERR_OK)
+		if (_samplingValues->getCoord(i, samplingVal) != ERR_OK || vec->getCoord(i, coordVec) != ERR_OK)
 		{
-			return errCode;
+			ILog::report("ICompact::getProjection: failed to get coords from '_samplingValues' or from 'vec'\n");
+			delete[] nnValues;
+			return ERR_ANY_OTHER;
 		}
-		/* if at least one of step coordinates is greather then half of sampling
-		   value, than step is correct (otherwise step is too small and iteraror
-		   isn't able to move) */
-		if (fabs(coordStep) > samplingVal / 2.0)
+
+		// if current coordinate is bigger than the begin point
+		if (coordVec > coordBegin)
 		{
-			return ERR_OK;
+			// if current coordinate is bigger than the end point
+			if (coordVec > coordEnd)
+			{
+				nnValues[i] = coordEnd;
+			}
+			// if current coordinate is between the begin and the end points
+			else if (type == PROJECTION_LATTICE)
+			{
+				nnValues[i] = coordBegin + round((coordVec - coordBegin) / samplingVal) * samplingVal;
+			}
+			// continuous projection keeps the coordinate as is
+			else
+			{
+				nnValues[i] = coordVec;
+			}
+		}
+		// if current coordinate is less (or equals) than the begin point
+		else
+		{
+			nnValues[i] = coordBegin;
 		}
 	}
-	ILog::report("checkStepCorrectness: too small step\n");
-	return ERR_WRONG_ARG;
-}// end checkStepCorrectness
 
+	neighbor = IVector::createVector(_dim, nnValues);
+	delete[] nnValues;
+	if (neighbor)
+	{
+		nn = neighbor;
+		return ERR_OK;
+	}
+	else
+	{
+		ILog::report("ICompact::getProjection: failed to create neighbor\n");
+		return ERR_MEMORY_ALLOCATION;
+	}
+}// end getProjection
 
-bool Compact::vectorPrecisionEquals(IVector const *v1, IVector const *v2) const
+int Compact::isContains(IVector const* const vec, bool& result) const
 {
-	double coord1 = 0.0, coord2 = 0.0, samplingVal = 0.0, dist;
-	unsigned dimension;
-	if (!v1 || !v2)
+	double coordBegin = 0.0, coordEnd = 0.0, coordVec = 0.0;
+	if (!vec)
 	{
-		return false;
+		ILog::report("ICompact::isContains: nullptr in 'vec' param\n");
+		return ERR_WRONG_ARG;
 	}
-	if ((dimension = v1->getDim()) != v2->getDim())
+	if (vec->getDim() != _dim)
 	{
-		return false;
+		ILog::report("ICompact::isContains: dimensions mismatch in 'vec' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
 	}
-	for (unsigned i = 0; i < dimension; i++)
+
+	for (unsigned i = 0; i < _dim; i++)
 	{
-		if (v1->getCoord(i, coord1) != ERR_OK || v2->getCoord(i, coord2) != ERR_OK)
+		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _pointEnd->getCoord(i, coordEnd) != ERR_OK)
 		{
-			ILog::report("vectorPrecisionEquals: failed to get coords from 'v1' or from 'v2'\n");
-			return false;
+			ILog::report("ICompact::isContains: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
+			return ERR_ANY_OTHER;
 		}
-		if (_samplingValues->getCoord(i, samplingVal) != ERR_OK)
+		if (vec->getCoord(i, coordVec) != ERR_OK)
 		{
-			ILog::report("vectorPrecisionEquals: failed to get coord from '_samplingValues'\n");
-			return false;
+			ILog::report("ICompact::isContains: failed to get coord from 'vec'\n");
+			return ERR_ANY_OTHER;
 		}
-		if ((dist = fabs(coord2 - coord1)) > samplingVal / PRECISION_DIVIDER || dist > DOUBLE_EPS)
+		if (!(coordVec >= coordBegin && coordVec <= coordEnd))
 		{
-			return false;
+			result = false;
+			return ERR_OK;
 		}
 	}
-	return true;
-} // end vectorPrecisionEquals
+	result = true;
+	return ERR_OK;
+} // end isContains
 
-int Compact::findIterator(IIterator const *iterator) const
+int Compact::isSubSet(ICompact const* const other, bool& result) const
 {
-	for (int i = 0; i < _iterators.count(); i++)
+	int errCode = isSubSetByBoxes(this, other, result);
+	if (errCode != ERR_OK)
 	{
-		if (iterator == dynamic_cast<IIterator*>(_iterators[i]))
-		{
-			return i;
-		}
+		ILog::report("ICompact::isSubSet: failed to compare compacts\n");
 	}
-	ILog::report("findIterator: no iterator found\n");
-	return -1;
+	return errCode;
 }
 
-
-int Compact::getIndexByPoint(IVector const* const vec, unsigned &result) const
+int Compact::isIntersects(ICompact const* const other, bool& result) const
 {
-	bool contains = false;
-	unsigned index = 0;
-	double coordBegin = 0.0, coordVec = 0.0, samplingVal = 0.0;
-	int errCode = isSamplingContains(vec, contains);
+	int errCode = isIntersectsByBoxes(this, other, result);
 	if (errCode != ERR_OK)
 	{
-		ILog::report("getIndexByPoint: failed to check if compact contains point\n");
-		return errCode;
+		ILog::report("ICompact::isIntersects: failed to compare compacts\n");
 	}
-	if (!contains)
+	return errCode;
+}
+
+int Compact::getBoundingBox(IVector *& begin, IVector *& end) const
+{
+	IVector *beginClone, *endClone;
+	if (!(beginClone = _pointBegin->clone()))
 	{
-		ILog::report("getIndexByPoint: compact doesn't contain point\n");
-		return ERR_WRONG_ARG;
+		ILog::report("ICompact::getBoundingBox: failed to clone '_pointBegin'\n");
+		return ERR_MEMORY_ALLOCATION;
 	}
-	for (unsigned i = 0; i < _dim; i++)
+	if (!(endClone = _pointEnd->clone()))
 	{
-		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _samplingValues->getCoord(i, samplingVal) != ERR_OK)
-		{
-			ILog::report("getIndexByPoint: failed to get coords from '_pointBegin' or from '_samplingValues'\n");
+		ILog::report("ICompact::getBoundingBox: failed to clone '_pointEnd'\n");
+		delete beginClone;
+		return ERR_MEMORY_ALLOCATION;
+	}
+	begin = beginClone;
+	end = endClone;
+	return ERR_OK;
+}
+
+int Compact::Intersection(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_INTERSECTION, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Intersection: failed to intersect compacts\n");
+	}
+	return errCode;
+}
+
+int Compact::Union(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_UNION, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Union: failed to unite compacts\n");
+	}
+	return errCode;
+}
+
+int Compact::Difference(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_DIFFERENCE, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Difference: failed to subtract compacts\n");
+	}
+	return errCode;
+}
+
+int Compact::SymDifference(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_SYM_DIFFERENCE, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::SymDifference: failed to subtract compacts symmetrically\n");
+	}
+	return errCode;
+}
+
+ICompact::IIterator* Compact::begin(IVector const* const step)
+{
+	CompactIterator *iterator;
+	IVector* stepClone;
+	if (!step)
+	{
+		iterator = new(std::nothrow) CompactIterator(this, 0);
+	}
+	else
+	{
+		if (checkStepCorrectness(step) != ERR_OK)
+		{
+			ILog::report("ICompact::begin: not correct 'step' param\n");
+			return nullptr;
+		}
+		if (!(stepClone = step->clone()))
+		{
+			ILog::report("ICompact::begin: failed to clone 'step' param\n");
+			return nullptr;
+		}
+		iterator = new(std::nothrow) CompactIterator(this, 0, stepClone);
+	}
+	if (iterator)
+	{
+		_iterators.append(iterator);
+	}
+	else
+	{
+		ILog::report("ICompact::begin: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+ICompact::IIterator* Compact::end(IVector const* const step)
+{
+	CompactIterator *iterator;
+	IVector* stepClone;
+	if (!step)
+	{
+		iterator = new(std::nothrow) CompactIterator(this, getLastIndex());
+	}
+	else
+	{
+		if (checkStepCorrectness(step) != ERR_OK)
+		{
+			ILog::report("ICompact::end: not correct 'step' param\n");
+			return nullptr;
+		}
+		if (!(stepClone = step->clone()))
+		{
+			ILog::report("ICompact::end: failed to clone 'step' param\n");
+			return nullptr;
+		}
+		iterator = new(std::nothrow) CompactIterator(this, getLastIndex(), stepClone);
+	}
+	if (iterator)
+	{
+		_iterators.append(iterator);
+	}
+	else
+	{
+		ILog::report("ICompact::end: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+ICompact::IIterator* Compact::beginSequence(SequenceType type, unsigned first, unsigned stride)
+{
+	SequenceIterator *iterator;
+	if (type != SEQUENCE_SOBOL && type != SEQUENCE_HALTON)
+	{
+		ILog::report("ICompact::beginSequence: unknown sequence type\n");
+		return nullptr;
+	}
+	if (stride == 0)
+	{
+		ILog::report("ICompact::beginSequence: zero 'stride' param\n");
+		return nullptr;
+	}
+	if (type == SEQUENCE_SOBOL && _dim > SOBOL_MAX_DIM)
+	{
+		ILog::report("ICompact::beginSequence: dimension is too big for Sobol sequence\n");
+		return nullptr;
+	}
+	if (!(iterator = new(std::nothrow) SequenceIterator(this, type, first, stride)))
+	{
+		ILog::report("ICompact::beginSequence: failed to create iterator\n");
+		return nullptr;
+	}
+	if (iterator->init() != ERR_OK)
+	{
+		ILog::report("ICompact::beginSequence: failed to init iterator\n");
+		delete iterator;
+		return nullptr;
+	}
+	_iterators.append(iterator);
+	return iterator;
+}
+
+int Compact::getByIterator(IIterator const* pIter, IVector*& pItem) const
+{
+	IVector *point;
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::getByIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	if (!(point = _iterators[index]->getPoint()))
+	{
+		ILog::report("ICompact::getByIterator: failed to get point from iterator\n");
+		return ERR_ANY_OTHER;
+	}
+	pItem = point;
+	return ERR_OK;
+}
+
+int Compact::deleteIterator(IIterator * pIter)
+{
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::deleteIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	if (_iterators[index])
+	{
+		delete _iterators[index];
+	}
+	_iterators.removeAt(index);
+	return ERR_OK;
+}
+
+int Compact::isSamplingContains(IVector const *vec, bool& result) const
+{
+	int errCode;
+	if (!vec)
+	{
+		ILog::report("isSampligContains: nullptr in 'vec' param\n");
+		return ERR_WRONG_ARG;
+	}
+	if (vec->getDim() != _dim)
+	{
+		ILog::report("isSampligContains: dimensions mismatch in 'vec' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+
+	IVector *neighbor = nullptr;
+	if ((errCode = getNearestNeighbor(vec, neighbor)) == ERR_OK)
+	{
+		result = vectorPrecisionEquals(vec, neighbor);
+	}
+	else
+	{
+		ILog::report("isSampligContains: failed to get neagers neighbor\n");
+	}
+	delete neighbor;
+	return errCode;
+} // end isContains
+
+int Compact::checkStepCorrectness(IVector const *step) const
+{
+	double coordStep = 0.0, samplingVal = 0.0;
+	int errCode;
+	if (!step)
+	{
+		return ERR_WRONG_ARG;
+	}
+	if (step->getDim() != _dim)
+	{
+		ILog::report("checkStepCorrectness: dimensions mismatch in 'step' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if ((errCode = step->getCoord(i, coordStep)) != ERR_OK)
+		{
+			return errCode;
+		}
+		if ((errCode = _samplingValues->getCoord(i, samplingVal)) != ERR_OK)
+		{
+			return errCode;
+		}
+		/* if at least one of step coordinates is greather then half of sampling
+		   value, than step is correct (otherwise step is too small and iteraror
+		   isn't able to move) */
+		if (fabs(coordStep) > samplingVal / 2.0)
+		{
+			return ERR_OK;
+		}
+	}
+	ILog::report("checkStepCorrectness: too small step\n");
+	return ERR_WRONG_ARG;
+}// end checkStepCorrectness
+
+
+bool Compact::vectorPrecisionEquals(IVector const *v1, IVector const *v2) const
+{
+	double coord1 = 0.0, coord2 = 0.0, samplingVal = 0.0, dist;
+	unsigned dimension;
+	if (!v1 || !v2)
+	{
+		return false;
+	}
+	if ((dimension = v1->getDim()) != v2->getDim())
+	{
+		return false;
+	}
+	for (unsigned i = 0; i < dimension; i++)
+	{
+		if (v1->getCoord(i, coord1) != ERR_OK || v2->getCoord(i, coord2) != ERR_OK)
+		{
+			ILog::report("vectorPrecisionEquals: failed to get coords from 'v1' or from 'v2'\n");
+			return false;
+		}
+		if (_samplingValues->getCoord(i, samplingVal) != ERR_OK)
+		{
+			ILog::report("vectorPrecisionEquals: failed to get coord from '_samplingValues'\n");
+			return false;
+		}
+		if ((dist = fabs(coord2 - coord1)) > samplingVal / PRECISION_DIVIDER || dist > DOUBLE_EPS)
+		{
+			return false;
+		}
+	}
+	return true;
+} // end vectorPrecisionEquals
+
+int Compact::findIterator(IIterator const *iterator) const
+{
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		if (iterator == dynamic_cast<IIterator*>(_iterators[i]))
+		{
+			return i;
+		}
+	}
+	ILog::report("findIterator: no iterator found\n");
+	return -1;
+}
+
+
+// points out of sampling are usual for callers probing a cache, so they aren't reported
+int Compact::getIndexByPoint(IVector const* const vec, unsigned &result) const
+{
+	double coordBegin = 0.0, coordVec = 0.0, samplingVal = 0.0, counter, dist;
+	QVector<unsigned> counters(static_cast<int>(_dim));
+	if (!vec)
+	{
+		ILog::report("getIndexByPoint: nullptr in 'vec' param\n");
+		return ERR_WRONG_ARG;
+	}
+	if (vec->getDim() != _dim)
+	{
+		ILog::report("getIndexByPoint: dimensions mismatch in 'vec' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if (_pointBegin->getCoord(i, coordBegin) != ERR_OK || _samplingValues->getCoord(i, samplingVal) != ERR_OK)
+		{
+			ILog::report("getIndexByPoint: failed to get coords from '_pointBegin' or from '_samplingValues'\n");
+			return ERR_ANY_OTHER;
+		}
+		if (vec->getCoord(i, coordVec) != ERR_OK)
+		{
+			ILog::report("getIndexByPoint: failed to get coord from 'vec' param\n");
+			return ERR_ANY_OTHER;
+		}
+		counter = _samplingCounters[i] > 1 ? round((coordVec - coordBegin) / samplingVal) : 0.0;
+		dist = fabs(coordBegin + counter * samplingVal - coordVec);
+		if (counter < 0.0 || counter > _samplingCounters[i] - 1.0 || dist > samplingVal / PRECISION_DIVIDER || dist > DOUBLE_EPS)
+		{
+			return ERR_WRONG_ARG;
+		}
+		counters[i] = static_cast<unsigned>(counter);
+	}
+	result = encodeIndex(counters);
+	return ERR_OK;
+}// end getIndexByPoint
+
+IVector* Compact::getPointByIndex(unsigned index) const
+{
+	double beginCoord = 0.0, samplingVal = 0.0;
+	double *coords;
+	QVector<unsigned> counters;
+	IVector *vec;
+	if (!decodeIndex(index, counters))
+	{
+		ILog::report("getPointByIndex: index out of range\n");
+		return nullptr;
+	}
+	if (!(coords = new(std::nothrow) double[_dim]))
+	{
+		ILog::report("getPointByIndex: failed with memory allocation\n");
+		return nullptr;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if (_pointBegin->getCoord(i, beginCoord) != ERR_OK || _samplingValues->getCoord(i, samplingVal) != ERR_OK)
+		{
+			ILog::report("getPointByIndex: failed to get coords from '_pointBegin' or from '_samplingValues'\n");
+			delete[] coords;
+			return nullptr;
+		}
+		coords[i] = beginCoord + counters[i] * samplingVal;
+	}
+	vec = IVector::createVector(_dim, coords);
+	if (!vec)
+	{
+		ILog::report("getPointByIndex: failed to create vector\n");
+	}
+	delete[] coords;
+	return vec;
+}// end getPointByIndex
+
+int Compact::setIndexOrder(IndexOrder order)
+{
+	QVector<unsigned> bits;
+	QList<QVector<unsigned> > points;
+	if (order != ORDER_ROW_MAJOR && order != ORDER_MORTON)
+	{
+		ILog::report("ICompact::setIndexOrder: unknown index order\n");
+		return ERR_WRONG_ARG;
+	}
+	if (order == ORDER_MORTON && getMortonBits(_samplingCounters, bits) != ERR_OK)
+	{
+		ILog::report("ICompact::setIndexOrder: Morton index of sampling doesn't fit in 32 bits\n");
+		return ERR_OUT_OF_RANGE;
+	}
+	// lattice iterators keep their points, sequence iterators don't depend on order
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		CompactIterator *iterator = dynamic_cast<CompactIterator*>(_iterators[i]);
+		QVector<unsigned> counters;
+		if (iterator)
+		{
+			decodeIndex(iterator->getPos(), counters);
+		}
+		points.append(counters);
+	}
+	_order = order;
+	_mortonBits = bits;
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		CompactIterator *iterator = dynamic_cast<CompactIterator*>(_iterators[i]);
+		if (iterator)
+		{
+			iterator->setPos(encodeIndex(points[i]));
+		}
+	}
+	return ERR_OK;
+}// end setIndexOrder
+
+// row-major index, or Morton index: bits of counters interleaved from the lowest ones
+unsigned Compact::encodeIndex(QVector<unsigned> const &counters) const
+{
+	unsigned index = 0, bit = 0, levels = 0;
+	if (_order == ORDER_ROW_MAJOR)
+	{
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			index = index * _samplingCounters[i] + counters[i];
+		}
+		return index;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		levels = std::max(levels, _mortonBits[i]);
+	}
+	for (unsigned level = 0; level < levels; level++)
+	{
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			if (level < _mortonBits[i])
+			{
+				index |= ((counters[i] >> level) & 1u) << bit++;
+			}
+		}
+	}
+	return index;
+}// end encodeIndex
+
+// returns false for indices out of range and for gaps of Morton order
+bool Compact::decodeIndex(unsigned index, QVector<unsigned> &counters) const
+{
+	unsigned bit = 0, levels = 0;
+	counters.fill(0, static_cast<int>(_dim));
+	if (_order == ORDER_ROW_MAJOR)
+	{
+		if (index >= _pointsAmount)
+		{
+			return false;
+		}
+		for (unsigned i = _dim; i > 0; i--)
+		{
+			counters[i - 1] = index % _samplingCounters[i - 1];
+			index /= _samplingCounters[i - 1];
+		}
+		return true;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		levels = std::max(levels, _mortonBits[i]);
+	}
+	for (unsigned level = 0; level < levels; level++)
+	{
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			if (level < _mortonBits[i])
+			{
+				counters[i] |= ((index >> bit++) & 1u) << level;
+			}
+		}
+	}
+	if (bit < MAX_INDEX_BITS && (index >> bit) != 0)
+	{
+		return false;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if (counters[i] >= _samplingCounters[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}// end decodeIndex
+
+// index of the "top-right" corner is the biggest one in both orders
+unsigned Compact::getLastIndex() const
+{
+	QVector<unsigned> counters(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		counters[i] = _samplingCounters[i] - 1;
+	}
+	return encodeIndex(counters);
+}
+
+int Compact::getMortonBits(QVector<unsigned> const &samplingCounters, QVector<unsigned> &bits)
+{
+	unsigned total = 0;
+	bits.fill(0, samplingCounters.size());
+	for (int i = 0; i < samplingCounters.size(); i++)
+	{
+		while (bits[i] < MAX_INDEX_BITS && (1u << bits[i]) < samplingCounters[i])
+		{
+			bits[i]++;
+		}
+		total += bits[i];
+	}
+	return total <= MAX_INDEX_BITS ? ERR_OK : ERR_OUT_OF_RANGE;
+}// end getMortonBits
+
+int Compact::applyOperation(Operation operation, ICompact const& c)
+{
+	QList<Box> boxes, otherBoxes, result;
+	QVector<double> spacing;
+	int errCode;
+	if (!_iterators.isEmpty())
+	{
+		ILog::report("applyOperation: compact can't be changed while it has iterators\n");
+		return ERR_WRONG_ARG;
+	}
+	if ((errCode = getOperandsBoxes(this, &c, boxes, otherBoxes, spacing)) != ERR_OK)
+	{
+		return errCode;
+	}
+	applyBoxesOperation(operation, boxes, otherBoxes, result);
+	if (result.isEmpty())
+	{
+		ILog::report("applyOperation: result of operation is empty\n");
+		return ERR_WRONG_ARG;
+	}
+	if (result.size() > 1)
+	{
+		ILog::report("applyOperation: result of operation isn't a box, use static operation\n");
+		return ERR_WRONG_ARG;
+	}
+	return assignBox(result[0], spacing);
+}// end applyOperation
+
+// replaces corners and sampling values of compact
+int Compact::assignBox(Box const& box, QVector<double> const& spacing)
+{
+	Compact *tmp;
+	if (!(tmp = createBoxCompact(box, spacing)))
+	{
+		ILog::report("assignBox: failed to create compact\n");
+		return ERR_MEMORY_ALLOCATION;
+	}
+	std::swap(_pointBegin, tmp->_pointBegin);
+	std::swap(_pointEnd, tmp->_pointEnd);
+	std::swap(_samplingValues, tmp->_samplingValues);
+	std::swap(_samplingCounters, tmp->_samplingCounters);
+	std::swap(_pointsAmount, tmp->_pointsAmount);
+	delete tmp;
+	if (_order == ORDER_MORTON && getMortonBits(_samplingCounters, _mortonBits) != ERR_OK)
+	{
+		ILog::report("assignBox: Morton index doesn't fit new sampling, continue with row-major order\n");
+		_order = ORDER_ROW_MAJOR;
+	}
+	return ERR_OK;
+}// end assignBox
+
+int Compact::getBox(Box& box) const
+{
+	box.begin.resize(static_cast<int>(_dim));
+	box.end.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if (_pointBegin->getCoord(i, box.begin[i]) != ERR_OK || _pointEnd->getCoord(i, box.end[i]) != ERR_OK)
+		{
+			ILog::report("getBox: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
+			return ERR_ANY_OTHER;
+		}
+	}
+	return ERR_OK;
+}
+
+int Compact::getSamplingValues(QVector<double>& spacing) const
+{
+	spacing.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		if (_samplingValues->getCoord(i, spacing[i]) != ERR_OK)
+		{
+			ILog::report("getSamplingValues: failed to get coord from '_samplingValues'\n");
+			return ERR_ANY_OTHER;
+		}
+	}
+	return ERR_OK;
+}
+
+Compact::BaseIterator::BaseIterator(Compact const *compact, unsigned pos, IVector const *step) : IIterator(compact, pos, step)
+{
+}
+
+Compact::CompactIterator::CompactIterator(Compact const *compact, unsigned pos, IVector *step) : BaseIterator(compact, pos, step)
+{
+	_compact = compact;
+	_pos = pos;
+	_step = step;
+	_lastIndex = compact->getLastIndex();
+}
+
+int Compact::CompactIterator::setStep(IVector const* const step)
+{
+	int errCode;
+	IVector *tmp;
+	if (step)
+	{
+		if ((errCode = _compact->checkStepCorrectness(step)) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::setStep: not correct 'step' param\n");
+			return errCode;
+		}
+		tmp = step->clone();
+		if (!tmp)
+		{
+			ILog::report("ICompact::IIterator::setStep: failed to clone 'step' param\n");
 			return ERR_ANY_OTHER;
 		}
-		if (vec->getCoord(i, coordVec) != ERR_OK)
+	}
+	else
+	{
+		tmp = nullptr;
+	}
+	if (_step)
+	{
+		delete _step;
+	}
+	_step = tmp;
+	return ERR_OK;
+}// end setStep
+
+int Compact::CompactIterator::doStep()
+{
+	// if stepping by default behaviour
+	if (_step == nullptr)
+	{
+		if (_pos < _lastIndex)
+		{
+			_pos++;
+			// gaps of Morton order don't correspond to points
+			while (_compact->_order == ORDER_MORTON && !_compact->decodeIndex(_pos, _counters))
+			{
+				_pos++;
+			}
+			return ERR_OK;
+		}
+		else
+		{
+			ILog::report("ICompact::IIterator::doStep: step out of range (default behavour)\n");
+			return ERR_OUT_OF_RANGE;
+		}
+	}
+	// if stepping by non-default behaviour
+	else
+	{
+		unsigned newPos;
+		IVector *currentPoint = _compact->getPointByIndex(_pos), *neighbor = nullptr;
+		int errCode;
+
+		if (!currentPoint)
+		{
+			ILog::report("ICompact::IIterator::doStep: failed to get point by index (non-default behavour)\n");
+			return ERR_ANY_OTHER;
+		}
+		if ((errCode = currentPoint->add(_step)) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::doStep: failed to add step (non-default behavour)\n");
+			delete currentPoint;
+			return errCode;
+		}
+		if ((errCode = _compact->getNearestNeighbor(currentPoint, neighbor)) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::doStep: failed to get nearest neighbor (non-default behavour)\n");
+			delete currentPoint;
+			return errCode;
+		}
+		if ((errCode = _compact->getIndexByPoint(neighbor, newPos)) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::doStep: failed to get index by point (non-default behavour)\n");
+			delete currentPoint;
+			delete neighbor;
+			return errCode;
+		}
+		if (newPos == _pos)
+		{
+			ILog::report("ICompact::IIterator::doStep: step out of range (non-default behavour)\n");
+			errCode = ERR_OUT_OF_RANGE;
+		}
+		else
+		{
+			_pos = newPos;
+			errCode = ERR_OK;
+		}
+		delete currentPoint;
+		delete neighbor;
+		return errCode;
+	}
+}// end doStep
+
+IVector* Compact::CompactIterator::getPoint() const
+{
+	return _compact->getPointByIndex(_pos);
+}
+
+unsigned Compact::CompactIterator::getPos() const
+{
+	return _pos;
+}
+
+// position is set when order of compact changes, so the last index is taken again
+void Compact::CompactIterator::setPos(unsigned pos)
+{
+	_pos = pos;
+	_lastIndex = _compact->getLastIndex();
+}
+
+Compact::SequenceIterator::SequenceIterator(Compact const *compact, SequenceType type, unsigned first, unsigned stride) : BaseIterator(compact, first, nullptr)
+{
+	_compact = compact;
+	_type = type;
+	_index = first;
+	_stride = stride;
+}
+
+int Compact::SequenceIterator::init()
+{
+	unsigned dim = _compact->_dim;
+	if (_type == SEQUENCE_HALTON)
+	{
+		// first 'dim' primes are the bases of Halton sequence
+		_bases.reserve(static_cast<int>(dim));
+		for (unsigned candidate = 2; static_cast<unsigned>(_bases.size()) < dim; candidate++)
+		{
+			bool isPrime = true;
+			for (int i = 0; i < _bases.size() && _bases[i] * _bases[i] <= candidate; i++)
+			{
+				if (candidate % _bases[i] == 0)
+				{
+					isPrime = false;
+					break;
+				}
+			}
+			if (isPrime)
+			{
+				_bases.append(candidate);
+			}
+		}
+		return ERR_OK;
+	}
+
+	_directions = QVector<unsigned>(static_cast<int>(dim * SOBOL_BITS), 0);
+	_sobolState = QVector<unsigned>(static_cast<int>(dim), 0);
+	// first axis is van der Corput sequence in base 2
+	for (unsigned k = 0; k < SOBOL_BITS; k++)
+	{
+		_directions[k] = 1u << (SOBOL_BITS - 1 - k);
+	}
+	for (unsigned j = 1; j < dim; j++)
+	{
+		SobolInit const &init = SOBOL_INIT[j - 1];
+		unsigned *v = _directions.data() + j * SOBOL_BITS;
+		for (unsigned k = 0; k < init.degree; k++)
+		{
+			v[k] = init.m[k] << (SOBOL_BITS - 1 - k);
+		}
+		for (unsigned k = init.degree; k < SOBOL_BITS; k++)
+		{
+			v[k] = v[k - init.degree] ^ (v[k - init.degree] >> init.degree);
+			for (unsigned l = 1; l < init.degree; l++)
+			{
+				if ((init.polynomial >> (init.degree - 1 - l)) & 1u)
+				{
+					v[k] ^= v[k - l];
+				}
+			}
+		}
+	}
+	setSobolState();
+	return ERR_OK;
+}// end init
+
+// skips directly to '_index': Sobol point n is xor of direction numbers by the bits of Gray code of n
+void Compact::SequenceIterator::setSobolState()
+{
+	unsigned gray = _index ^ (_index >> 1);
+	for (unsigned j = 0; j < _compact->_dim; j++)
+	{
+		unsigned x = 0;
+		unsigned const *v = _directions.constData() + j * SOBOL_BITS;
+		for (unsigned k = 0; k < SOBOL_BITS; k++)
+		{
+			if ((gray >> k) & 1u)
+			{
+				x ^= v[k];
+			}
+		}
+		_sobolState[j] = x;
+	}
+}
+
+double Compact::SequenceIterator::radicalInverse(unsigned base, unsigned index) const
+{
+	double result = 0.0, factor = 1.0 / base;
+	while (index > 0)
+	{
+		result += (index % base) * factor;
+		index /= base;
+		factor /= base;
+	}
+	return result;
+}
+
+int Compact::SequenceIterator::setStep(IVector const* const step)
+{
+	ILog::report("ICompact::IIterator::setStep: sequence iterator doesn't support steps\n");
+	return ERR_NOT_IMPLEMENTED;
+}
+
+int Compact::SequenceIterator::doStep()
+{
+	if (_index > UINT_MAX - _stride)
+	{
+		ILog::report("ICompact::IIterator::doStep: step out of range (sequence)\n");
+		return ERR_OUT_OF_RANGE;
+	}
+	if (_type == SEQUENCE_SOBOL)
+	{
+		if (_stride == 1)
+		{
+			// Gray code ordering: neighbour points differ by one direction number
+			unsigned bit = 0;
+			while ((_index >> bit) & 1u)
+			{
+				bit++;
+			}
+			for (unsigned j = 0; j < _compact->_dim; j++)
+			{
+				_sobolState[j] ^= _directions[j * SOBOL_BITS + bit];
+			}
+			_index++;
+		}
+		else
+		{
+			_index += _stride;
+			setSobolState();
+		}
+	}
+	else
+	{
+		_index += _stride;
+	}
+	return ERR_OK;
+}// end doStep
+
+IVector* Compact::SequenceIterator::getPoint() const
+{
+	double coordBegin = 0.0, coordEnd = 0.0, unit;
+	double *coords = new(std::nothrow) double[_compact->_dim];
+	IVector *vec;
+	if (!coords)
+	{
+		ILog::report("ICompact::IIterator::getPoint: failed with memory allocation\n");
+		return nullptr;
+	}
+	for (unsigned i = 0; i < _compact->_dim; i++)
+	{
+		if (_compact->_pointBegin->getCoord(i, coordBegin) != ERR_OK || _compact->_pointEnd->getCoord(i, coordEnd) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::getPoint: failed to get coords from '_pointBegin' or from '_pointEnd'\n");
+			delete[] coords;
+			return nullptr;
+		}
+		if (_type == SEQUENCE_SOBOL)
+		{
+			unit = ldexp(static_cast<double>(_sobolState[i]), -static_cast<int>(SOBOL_BITS));
+		}
+		else
+		{
+			unit = radicalInverse(_bases[i], _index);
+		}
+		coords[i] = coordBegin + unit * (coordEnd - coordBegin);
+	}
+	vec = IVector::createVector(_compact->_dim, coords);
+	if (!vec)
+	{
+		ILog::report("ICompact::IIterator::getPoint: failed to create vector\n");
+	}
+	delete[] coords;
+	return vec;
+}// end getPoint
+
+CompactUnion::CompactUnion(unsigned dim, QVector<double> const &spacing, QList<Compact*> const &boxes) : _spacing(spacing), _boxes(boxes)
+{
+	_dim = dim;
+}
+
+CompactUnion::~CompactUnion()
+{
+	// iterators refer to the boxes, so they go first
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		delete _iterators[i];
+	}
+	for (int i = 0; i < _boxes.count(); i++)
+	{
+		delete _boxes[i];
+	}
+}
+
+ICompact* CompactUnion::clone() const
+{
+	QList<Compact*> boxes;
+	ICompact *box, *compact;
+	for (int i = 0; i < _boxes.count(); i++)
+	{
+		if (!(box = _boxes[i]->clone()))
+		{
+			ILog::report("ICompact::clone: failed to clone box of union\n");
+			for (int j = 0; j < boxes.count(); j++)
+			{
+				delete boxes[j];
+			}
+			return nullptr;
+		}
+		boxes.append(static_cast<Compact*>(box));
+	}
+	if (!(compact = new(std::nothrow) CompactUnion(_dim, _spacing, boxes)))
+	{
+		ILog::report("ICompact::clone: failed with memory allocation\n");
+		for (int j = 0; j < boxes.count(); j++)
+		{
+			delete boxes[j];
+		}
+	}
+	return compact;
+}// end clone
+
+int CompactUnion::getId() const
+{
+	return ICompact::INTERFACE_1;
+}
+
+int CompactUnion::getNearestNeighbor(IVector const* vec, IVector *& nn) const
+{
+	return getProjection(vec, PROJECTION_LATTICE, nn);
+}
+
+int CompactUnion::getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const
+{
+	IVector *best = nullptr, *neighbor, *diff;
+	double bestDist = 0.0, dist;
+	int errCode;
+	if (_boxes.isEmpty())
+	{
+		ILog::report("ICompact::getProjection: compact is empty\n");
+		return ERR_OUT_OF_RANGE;
+	}
+	for (int i = 0; i < _boxes.count(); i++)
+	{
+		if ((errCode = _boxes[i]->getProjection(vec, type, neighbor)) != ERR_OK)
+		{
+			ILog::report("ICompact::getProjection: failed to project onto box of union\n");
+			delete best;
+			return errCode;
+		}
+		if (!(diff = IVector::subtract(neighbor, vec)) || diff->norm(IVector::NORM_2, dist) != ERR_OK)
+		{
+			ILog::report("ICompact::getProjection: failed to calculate distance to neighbor\n");
+			delete diff;
+			delete neighbor;
+			delete best;
+			return ERR_ANY_OTHER;
+		}
+		delete diff;
+		if (!best || dist < bestDist)
+		{
+			delete best;
+			best = neighbor;
+			bestDist = dist;
+		}
+		else
+		{
+			delete neighbor;
+		}
+	}
+	nn = best;
+	return ERR_OK;
+}// end getProjection
+
+int CompactUnion::isContains(IVector const* const vec, bool& result) const
+{
+	int errCode;
+	result = false;
+	for (int i = 0; i < _boxes.count() && !result; i++)
+	{
+		if ((errCode = _boxes[i]->isContains(vec, result)) != ERR_OK)
 		{
-			ILog::report("getIndexByPoint: failed to get coord from 'vec' param\n");
-			return ERR_ANY_OTHER;
+			ILog::report("ICompact::isContains: failed to check box of union\n");
+			return errCode;
 		}
-		index *= _samplingCounters[i];
-		index += static_cast<unsigned>(round((coordVec - coordBegin) / samplingVal));
 	}
-	result = index;
 	return ERR_OK;
-}// end getIndexByPoint
+}
 
-IVector* Compact::getPointByIndex(unsigned index) const
+int CompactUnion::isSubSet(ICompact const* const other, bool& result) const
 {
-	unsigned currentIndex;
-	double beginCoord = 0.0, samplingVal = 0.0;
-	double *coords = new(std::nothrow) double[_dim];
-	IVector *vec;
-	if (!coords)
+	int errCode = isSubSetByBoxes(this, other, result);
+	if (errCode != ERR_OK)
 	{
-		ILog::report("getPointByIndex: failed with memory allocation\n");
-		return nullptr;
+		ILog::report("ICompact::isSubSet: failed to compare compacts\n");
+	}
+	return errCode;
+}
+
+int CompactUnion::isSimplyConn(bool& result) const
+{
+	if (_boxes.count() <= 1)
+	{
+		result = true;
+		return ERR_OK;
 	}
-	if (index >= _pointsAmount)
+	ILog::report("ICompact::isSimplyConn: ERR_NOT_IMPLEMENTED for union of boxes\n");
+	return ERR_NOT_IMPLEMENTED;
+}
+
+int CompactUnion::isIntersects(ICompact const* const other, bool& result) const
+{
+	int errCode = isIntersectsByBoxes(this, other, result);
+	if (errCode != ERR_OK)
 	{
-		ILog::report("getPointByIndex: index out of range\n");
-		delete[] coords;
-		return nullptr;
+		ILog::report("ICompact::isIntersects: failed to compare compacts\n");
+	}
+	return errCode;
+}
+
+int CompactUnion::getBoundingBox(IVector *& begin, IVector *& end) const
+{
+	Box box, bounds;
+	IVector *beginVec, *endVec;
+	if (_boxes.isEmpty())
+	{
+		ILog::report("ICompact::getBoundingBox: compact is empty\n");
+		return ERR_OUT_OF_RANGE;
 	}
-	for (unsigned i = _dim; i > 0; i--)
+	for (int i = 0; i < _boxes.count(); i++)
 	{
-		currentIndex = index % (_samplingCounters)[i - 1];
-		index /= (_samplingCounters)[i - 1];
-		if (_pointBegin->getCoord(i - 1, beginCoord) != ERR_OK || _samplingValues->getCoord(i - 1, samplingVal) != ERR_OK)
+		if (_boxes[i]->getBox(box) != ERR_OK)
 		{
-			ILog::report("getPointByIndex: failed to get coords from '_pointBegin' or from '_samplingValues'\n");
-			delete[] coords;
-			return nullptr;
+			ILog::report("ICompact::getBoundingBox: failed to get box of union\n");
+			return ERR_ANY_OTHER;
+		}
+		if (i == 0)
+		{
+			bounds = box;
+			continue;
+		}
+		for (unsigned j = 0; j < _dim; j++)
+		{
+			bounds.begin[j] = std::min(bounds.begin[j], box.begin[j]);
+			bounds.end[j] = std::max(bounds.end[j], box.end[j]);
 		}
-		coords[i - 1] = beginCoord + currentIndex * samplingVal;
 	}
-	vec = IVector::createVector(_dim, coords);
-	if (!vec)
+	if (!(beginVec = IVector::createVector(_dim, bounds.begin.constData())))
 	{
-		ILog::report("getPointByIndex: failed to create vector\n");
+		ILog::report("ICompact::getBoundingBox: failed to create 'begin'\n");
+		return ERR_MEMORY_ALLOCATION;
 	}
-	delete[] coords;
-	return vec;
-}// end getPointByIndex
+	if (!(endVec = IVector::createVector(_dim, bounds.end.constData())))
+	{
+		ILog::report("ICompact::getBoundingBox: failed to create 'end'\n");
+		delete beginVec;
+		return ERR_MEMORY_ALLOCATION;
+	}
+	begin = beginVec;
+	end = endVec;
+	return ERR_OK;
+}// end getBoundingBox
 
-Compact::CompactIterator::CompactIterator(Compact const *compact, unsigned pos, IVector *step) : IIterator(compact, pos, step)
+int CompactUnion::Intersection(ICompact const& c)
 {
-	_compact = compact;
-	_pos = pos;
-	_step = step;
+	int errCode = applyOperation(OPERATION_INTERSECTION, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Intersection: failed to intersect compacts\n");
+	}
+	return errCode;
 }
 
-int Compact::CompactIterator::setStep(IVector const* const step)
+int CompactUnion::Union(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_UNION, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Union: failed to unite compacts\n");
+	}
+	return errCode;
+}
+
+int CompactUnion::Difference(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_DIFFERENCE, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::Difference: failed to subtract compacts\n");
+	}
+	return errCode;
+}
+
+int CompactUnion::SymDifference(ICompact const& c)
+{
+	int errCode = applyOperation(OPERATION_SYM_DIFFERENCE, c);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::SymDifference: failed to subtract compacts symmetrically\n");
+	}
+	return errCode;
+}
+
+int CompactUnion::applyOperation(Operation operation, ICompact const& c)
 {
+	QList<Box> boxes, otherBoxes, result;
+	QList<Compact*> compacts;
+	QVector<double> spacing;
+	Compact *compact;
 	int errCode;
-	IVector *tmp;
-	if (step)
+	if (!_iterators.isEmpty())
 	{
-		if ((errCode = _compact->checkStepCorrectness(step)) != ERR_OK)
+		ILog::report("applyOperation: union can't be changed while it has iterators\n");
+		return ERR_WRONG_ARG;
+	}
+	if ((errCode = getOperandsBoxes(this, &c, boxes, otherBoxes, spacing)) != ERR_OK)
+	{
+		return errCode;
+	}
+	applyBoxesOperation(operation, boxes, otherBoxes, result);
+	for (int i = 0; i < result.size(); i++)
+	{
+		if (!(compact = createBoxCompact(result[i], spacing)))
 		{
-			ILog::report("ICompact::IIterator::setStep: not correct 'step' param\n");
-			return errCode;
+			ILog::report("applyOperation: failed to create box\n");
+			for (int j = 0; j < compacts.size(); j++)
+			{
+				delete compacts[j];
+			}
+			return ERR_MEMORY_ALLOCATION;
 		}
-		tmp = step->clone();
-		if (!tmp)
+		compacts.append(compact);
+	}
+	for (int i = 0; i < _boxes.size(); i++)
+	{
+		delete _boxes[i];
+	}
+	_boxes = compacts;
+	_spacing = spacing;
+	return ERR_OK;
+}// end applyOperation
+
+CompactUnion::UnionIterator* CompactUnion::createIterator(int box, bool atEnd, IVector const *step)
+{
+	IIterator *boxIterator;
+	IVector *stepClone = nullptr;
+	UnionIterator *iterator;
+	if (step && !(stepClone = step->clone()))
+	{
+		ILog::report("createIterator: failed to clone 'step' param\n");
+		return nullptr;
+	}
+	boxIterator = atEnd ? _boxes[box]->end(step) : _boxes[box]->begin(step);
+	if (!boxIterator)
+	{
+		ILog::report("createIterator: failed to create iterator over box\n");
+		delete stepClone;
+		return nullptr;
+	}
+	if (!(iterator = new(std::nothrow) UnionIterator(this, box, boxIterator, stepClone)))
+	{
+		ILog::report("createIterator: failed to create iterator\n");
+		_boxes[box]->deleteIterator(boxIterator);
+		delete stepClone;
+		return nullptr;
+	}
+	_iterators.append(iterator);
+	return iterator;
+}// end createIterator
+
+ICompact::IIterator* CompactUnion::begin(IVector const* const step)
+{
+	if (_boxes.isEmpty())
+	{
+		ILog::report("ICompact::begin: compact is empty\n");
+		return nullptr;
+	}
+	IIterator *iterator = createIterator(0, false, step);
+	if (!iterator)
+	{
+		ILog::report("ICompact::begin: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+ICompact::IIterator* CompactUnion::end(IVector const* const step)
+{
+	if (_boxes.isEmpty())
+	{
+		ILog::report("ICompact::end: compact is empty\n");
+		return nullptr;
+	}
+	IIterator *iterator = createIterator(_boxes.count() - 1, true, step);
+	if (!iterator)
+	{
+		ILog::report("ICompact::end: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+int CompactUnion::getByIterator(IIterator const* pIter, IVector*& pItem) const
+{
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::getByIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	return _boxes[_iterators[index]->_box]->getByIterator(_iterators[index]->_boxIterator, pItem);
+}
+
+int CompactUnion::deleteIterator(IIterator * pIter)
+{
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::deleteIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	delete _iterators[index];
+	_iterators.removeAt(index);
+	return ERR_OK;
+}
+
+int CompactUnion::findIterator(IIterator const *iterator) const
+{
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		if (iterator == dynamic_cast<IIterator*>(_iterators[i]))
 		{
-			ILog::report("ICompact::IIterator::setStep: failed to clone 'step' param\n");
-			return ERR_ANY_OTHER;
+			return i;
 		}
 	}
-	else
+	ILog::report("findIterator: no iterator found\n");
+	return -1;
+}
+
+CompactUnion::UnionIterator::UnionIterator(CompactUnion const *compactUnion, int box, IIterator *boxIterator, IVector *step) : IIterator(compactUnion, box, step)
+{
+	_union = compactUnion;
+	_box = box;
+	_boxIterator = boxIterator;
+	_step = step;
+}
+
+CompactUnion::UnionIterator::~UnionIterator()
+{
+	_union->_boxes[_box]->deleteIterator(_boxIterator);
+	delete _step;
+}
+
+int CompactUnion::UnionIterator::setStep(IVector const* const step)
+{
+	IVector *tmp = nullptr;
+	int errCode;
+	if (step && !(tmp = step->clone()))
 	{
-		tmp = nullptr;
+		ILog::report("ICompact::IIterator::setStep: failed to clone 'step' param\n");
+		return ERR_MEMORY_ALLOCATION;
 	}
-	if (_step)
+	if ((errCode = _boxIterator->setStep(step)) != ERR_OK)
 	{
-		delete _step;
+		ILog::report("ICompact::IIterator::setStep: not correct 'step' param\n");
+		delete tmp;
+		return errCode;
 	}
+	delete _step;
 	_step = tmp;
 	return ERR_OK;
 }// end setStep
 
-int Compact::CompactIterator::doStep()
+// skips points of shared faces visited with previous boxes
+int CompactUnion::UnionIterator::doStep()
 {
-	// if stepping by default behaviour
-	if (_step == nullptr)
+	bool visited = true;
+	int errCode = ERR_OK;
+	while (visited && errCode == ERR_OK)
 	{
-		if (_pos < _compact->_pointsAmount - 1)
-		{
-			_pos++;
-			return ERR_OK;
-		}
-		else
+		if ((errCode = nextPoint()) == ERR_OK)
 		{
-			ILog::report("ICompact::IIterator::doStep: step out of range (default behavour)\n");
-			return ERR_OUT_OF_RANGE;
+			errCode = isVisited(visited);
 		}
 	}
-	// if stepping by non-default behaviour
-	else
-	{
-		unsigned newPos;
-		IVector *currentPoint = _compact->getPointByIndex(_pos), *neighbor = nullptr;
-		int errCode;
+	return errCode;
+}// end doStep
 
-		if (!currentPoint)
-		{
-			ILog::report("ICompact::IIterator::doStep: failed to get point by index (non-default behavour)\n");
-			return ERR_ANY_OTHER;
-		}
-		if ((errCode = currentPoint->add(_step)) != ERR_OK)
-		{
-			ILog::report("ICompact::IIterator::doStep: failed to add step (non-default behavour)\n");
-			delete currentPoint;
-			return errCode;
-		}
-		if ((errCode = _compact->getNearestNeighbor(currentPoint, neighbor)) != ERR_OK)
-		{
-			ILog::report("ICompact::IIterator::doStep: failed to get nearest neighbor (non-default behavour)\n");
-			delete currentPoint;
-			return errCode;
-		}
-		if ((errCode = _compact->getIndexByPoint(neighbor, newPos)) != ERR_OK)
-		{
-			ILog::report("ICompact::IIterator::doStep: failed to get index by point (non-default behavour)\n");
-			delete currentPoint;
-			delete neighbor;
-			return errCode;
-		}
-		if (newPos == _pos)
-		{
-			ILog::report("ICompact::IIterator::doStep: step out of range (non-default behavour)\n");
-			errCode = ERR_OUT_OF_RANGE;
-		}
-		else
-		{
-			_pos = newPos;
-			errCode = ERR_OK;
-		}
-		delete currentPoint;
-		delete neighbor;
+// walks boxes of union one by one
+int CompactUnion::UnionIterator::nextPoint()
+{
+	IIterator *next;
+	int errCode = _boxIterator->doStep();
+	if (errCode != ERR_OUT_OF_RANGE || _box + 1 >= _union->_boxes.count())
+	{
 		return errCode;
 	}
-}// end doStep
+	if (!(next = _union->_boxes[_box + 1]->begin(_step)))
+	{
+		ILog::report("ICompact::IIterator::doStep: failed to begin next box of union\n");
+		return ERR_ANY_OTHER;
+	}
+	_union->_boxes[_box]->deleteIterator(_boxIterator);
+	_boxIterator = next;
+	_box++;
+	return ERR_OK;
+}// end nextPoint
 
-IVector* Compact::CompactIterator::getPoint() const
+// checks if current point belongs to one of boxes before the current one
+int CompactUnion::UnionIterator::isVisited(bool& result) const
 {
-	return _compact->getPointByIndex(_pos);
-}
+	IVector *point;
+	Box box;
+	int errCode;
+	result = false;
+	if (_box == 0)
+	{
+		return ERR_OK;
+	}
+	if ((errCode = _union->_boxes[_box]->getByIterator(_boxIterator, point)) != ERR_OK)
+	{
+		return errCode;
+	}
+	for (int i = 0; i < _box && !result && errCode == ERR_OK; i++)
+	{
+		if ((errCode = _union->_boxes[i]->getBox(box)) == ERR_OK)
+		{
+			result = boxContainsPoint(box, point);
+		}
+	}
+	delete point;
+	return errCode;
+}// end isVisited
 
 ICompact::IIterator::IIterator(ICompact const* const compact, int pos, IVector const* const step)
 {
@@ -0,0 +1,498 @@
+#include <QVector>
+#include <QMutex>
+#include <cmath>
+#include <algorithm>
+#include "ISet.h"
+#include "error.h"
+#include "ILog.h"
+#include "PointIndex.h"
+
+namespace {
+    const double CONCURRENT_EPS = 1e-8;
+
+    class ConcurrentSet : public ISet
+    {
+    public:
+        int getId() const;
+
+        int put(IVector const* const item);
+        int putUnique(IVector const* const item, bool& added);
+        int get(unsigned int index, IVector*& pItem) const;
+        int remove(unsigned int index);
+        using ISet::remove;
+        int contains(IVector const* const pItem, bool& rc) const;
+        unsigned int getSize() const;
+        int clear();
+
+        int setInsertMode(InsertMode mode);
+
+        int exportTo(unsigned int bufferSize, double* buffer) const;
+
+        IIterator* end();
+        IIterator* begin();
+
+        int deleteIterator(IIterator * pIter);
+        int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+        int getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const;
+
+        /*iterates over the copy of points made when it was created*/
+        class SnapshotIterator : public ISet::IIterator
+        {
+        public:
+            int next();
+            int prev();
+            bool isEnd() const;
+            bool isBegin() const;
+
+            QVector<double> _snapshot;
+            unsigned int _dim;
+            unsigned int _pos;
+
+            SnapshotIterator(ISet const* const set, unsigned int dim);
+        };
+
+        /*ctor*/
+        ConcurrentSet(unsigned int dim, unsigned int shards);
+        /*dtor*/
+        ~ConcurrentSet();
+
+        bool isValid() const;
+
+        static const unsigned int DEFAULT_SHARDS = 64;
+
+    private:
+        /*points of shard belong to cells of hash grid mapped to it, so equal points share shard*/
+        struct Shard
+        {
+            QMutex mutex;
+            ISet* set;
+        };
+
+        int getCoords(IVector const* const item, double const*& coords, char const* message) const;
+        unsigned int getShard(QVector<long long> const& cell) const;
+        void getShards(double const* coords, QVector<unsigned int>& shards) const;
+        void sortShards(QVector<unsigned int>& shards) const;
+        void lockShards(QVector<unsigned int> const& shards) const;
+        void unlockShards(QVector<unsigned int> const& shards) const;
+        void lockAll() const;
+        void unlockAll() const;
+        int findIterator(IIterator const * pIter) const;
+        SnapshotIterator* createIterator(bool atEnd);
+
+        unsigned int _dim;
+        QVector<Shard*> _shards;
+        InsertMode _insertMode;
+        QVector<SnapshotIterator*> _iterators;
+        mutable QMutex _iteratorsMutex;
+    };
+
+} //end anonymous namespace
+
+int ConcurrentSet::getId() const {
+    return ISet::INTERFACE_1;
+}
+
+ISet* ISet::createConcurrentSet(unsigned int R_dim, unsigned int shards) {
+    if (R_dim == 0) {
+        ILog::report("ISet.createConcurrentSet: Can't create Set with zero dimension\n");
+        return NULL;
+    }
+    if (shards == 0)
+        shards = ConcurrentSet::DEFAULT_SHARDS;
+
+    ConcurrentSet* set = new(std::nothrow) ConcurrentSet(R_dim, shards);
+    if (!set) {
+        ILog::report("ISet.createConcurrentSet: Not enough memory\n");
+        return NULL;
+    }
+    if (!set->isValid()) {
+        ILog::report("ISet.createConcurrentSet: Not enough memory for shards\n");
+        delete set;
+        return NULL;
+    }
+    return set;
+}
+
+ConcurrentSet::ConcurrentSet(unsigned int dim, unsigned int shards): _dim(dim), _insertMode(INSERT_ALL) {
+    for (unsigned int i = 0; i < shards; i++) {
+        Shard* shard = new(std::nothrow) Shard;
+        if (!shard)
+            break;
+        shard->set = ISet::createSet(dim);
+        _shards.append(shard);
+    }
+}
+
+ConcurrentSet::~ConcurrentSet() {
+    for (int i = 0; i < _shards.size(); i++) {
+        delete _shards[i]->set;
+        delete _shards[i];
+    }
+    for (int i = 0; i < _iterators.size(); i++) {
+        delete _iterators[i];
+    }
+}
+
+bool ConcurrentSet::isValid() const {
+    if (_shards.isEmpty())
+        return false;
+    for (int i = 0; i < _shards.size(); i++) {
+        if (!_shards[i]->set)
+            return false;
+    }
+    return true;
+}
+
+unsigned int ConcurrentSet::getShard(QVector<long long> const& cell) const {
+    return static_cast<unsigned int>(PointGrid::hashCell(cell.constData(), _dim) % _shards.size());
+}
+
+/*shards of all cells which the EPS box around point touches, the first one is the home shard of point;
+  cells are those of PointGrid, which finds equal points in every shard*/
+void ConcurrentSet::getShards(double const* coords, QVector<unsigned int>& shards) const {
+    QVector<long long> home(_dim), low, cell;
+    QVector<unsigned int> split;
+    shards.clear();
+    for (unsigned int i = 0; i < _dim; i++)
+        home[i] = PointGrid::getCell(coords[i], CONCURRENT_EPS);
+    shards.append(getShard(home));
+    if (!PointGrid::getTouchedCells(coords, _dim, CONCURRENT_EPS, low, split)) {
+        for (int i = 0; i < _shards.size(); i++)
+            shards.append(i);
+    } else {
+        for (unsigned int mask = 0; mask < (1u << split.size()); mask++) {
+            cell = low;
+            for (int j = 0; j < split.size(); j++) {
+                if (mask & (1u << j))
+                    cell[split[j]]++;
+            }
+            shards.append(getShard(cell));
+        }
+    }
+}
+
+void ConcurrentSet::sortShards(QVector<unsigned int>& shards) const {
+    std::sort(shards.begin(), shards.end());
+    shards.resize(std::unique(shards.begin(), shards.end()) - shards.begin());
+}
+
+/*shards are always locked in ascending order, so threads can't deadlock*/
+void ConcurrentSet::lockShards(QVector<unsigned int> const& shards) const {
+    for (int i = 0; i < shards.size(); i++)
+        _shards[shards[i]]->mutex.lock();
+}
+
+void ConcurrentSet::unlockShards(QVector<unsigned int> const& shards) const {
+    for (int i = shards.size(); i > 0; i--)
+        _shards[shards[i - 1]]->mutex.unlock();
+}
+
+void ConcurrentSet::lockAll() const {
+    for (int i = 0; i < _shards.size(); i++)
+        _shards[i]->mutex.lock();
+}
+
+void ConcurrentSet::unlockAll() const {
+    for (int i = _shards.size(); i > 0; i--)
+        _shards[i - 1]->mutex.unlock();
+}
+
+int ConcurrentSet::getCoords(IVector const* const item, double const*& coords, char const* message) const {
+    if (!item) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != item->getDim()) {
+        ILog::report("ISet: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+    unsigned int dim;
+    return item->getCoordsPtr(dim, coords);
+}
+
+int ConcurrentSet::put(IVector const* const item) {
+    double const* coords;
+    QVector<unsigned int> shards;
+    if (_insertMode == INSERT_UNIQUE) {
+        bool added;
+        return putUnique(item, added);
+    }
+    int errCode = getCoords(item, coords, "ISet.put: Input argument is nullptr\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    getShards(coords, shards);
+    Shard* shard = _shards[shards[0]];
+    shard->mutex.lock();
+    errCode = shard->set->put(item);
+    shard->mutex.unlock();
+    return errCode;
+}
+
+int ConcurrentSet::putUnique(IVector const* const item, bool& added) {
+    double const* coords;
+    QVector<unsigned int> shards;
+    bool found = false;
+    int errCode = getCoords(item, coords, "ISet.putUnique: Input argument is nullptr\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    getShards(coords, shards);
+    unsigned int home = shards[0];
+    sortShards(shards);
+    lockShards(shards);
+    for (int i = 0; i < shards.size() && errCode == ERR_OK && !found; i++)
+        errCode = _shards[shards[i]]->set->contains(item, found);
+    if (errCode == ERR_OK && !found)
+        errCode = _shards[home]->set->put(item);
+    unlockShards(shards);
+    added = errCode == ERR_OK && !found;
+    return errCode;
+}
+
+int ConcurrentSet::contains(IVector const* const pItem, bool& rc) const {
+    double const* coords;
+    QVector<unsigned int> shards;
+    int errCode = getCoords(pItem, coords, "ISet.contains: Input argument is nullptr\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    getShards(coords, shards);
+    sortShards(shards);
+    rc = false;
+    lockShards(shards);
+    for (int i = 0; i < shards.size() && errCode == ERR_OK && !rc; i++)
+        errCode = _shards[shards[i]]->set->contains(pItem, rc);
+    unlockShards(shards);
+    return errCode;
+}
+
+/*indices run over shards one after another, they are stable only while the set isn't changed*/
+int ConcurrentSet::get(unsigned int index, IVector*& pItem) const {
+    int errCode = ERR_OUT_OF_RANGE;
+    lockAll();
+    for (int i = 0; i < _shards.size(); i++) {
+        unsigned int size = _shards[i]->set->getSize();
+        if (index < size) {
+            errCode = _shards[i]->set->get(index, pItem);
+            break;
+        }
+        index -= size;
+    }
+    unlockAll();
+    if (errCode == ERR_OUT_OF_RANGE)
+        ILog::report("ISet.get: Wrong index (out of range)\n");
+    return errCode;
+}
+
+int ConcurrentSet::remove(unsigned int index) {
+    int errCode = ERR_OUT_OF_RANGE;
+    lockAll();
+    for (int i = 0; i < _shards.size(); i++) {
+        unsigned int size = _shards[i]->set->getSize();
+        if (index < size) {
+            errCode = _shards[i]->set->remove(index);
+            break;
+        }
+        index -= size;
+    }
+    unlockAll();
+    if (errCode == ERR_OUT_OF_RANGE)
+        ILog::report("ISet.remove: Wrong index (out of range)\n");
+    return errCode;
+}
+
+unsigned int ConcurrentSet::getSize() const {
+    unsigned int size = 0;
+    lockAll();
+    for (int i = 0; i < _shards.size(); i++)
+        size += _shards[i]->set->getSize();
+    unlockAll();
+    return size;
+}
+
+int ConcurrentSet::clear() {
+    lockAll();
+    for (int i = 0; i < _shards.size(); i++)
+        _shards[i]->set->clear();
+    unlockAll();
+    return ERR_OK;
+}
+
+/*unique mode is checked across shards by putUnique, shards themselves take all points*/
+int ConcurrentSet::setInsertMode(InsertMode mode) {
+    if (mode >= DIMENSION_INSERT_MODE) {
+        ILog::report("ISet.setInsertMode: Wrong insert mode\n");
+        return ERR_WRONG_ARG;
+    }
+    _insertMode = mode;
+    return ERR_OK;
+}
+
+/*copies points of all shards taken at one moment*/
+int ConcurrentSet::exportTo(unsigned int bufferSize, double* buffer) const {
+    if (!buffer) {
+        ILog::report("ISet.exportTo: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    int errCode = ERR_OK;
+    unsigned int used = 0;
+    lockAll();
+    for (int i = 0; i < _shards.size() && errCode == ERR_OK; i++) {
+        unsigned int count, dim;
+        double const* data;
+        errCode = _shards[i]->set->getData(count, dim, data);
+        if (errCode != ERR_OK)
+            break;
+        if (bufferSize - used < count * dim) {
+            errCode = ERR_OUT_OF_RANGE;
+            break;
+        }
+        std::copy(data, data + count * dim, buffer + used);
+        used += count * dim;
+    }
+    unlockAll();
+    if (errCode == ERR_OUT_OF_RANGE)
+        ILog::report("ISet.exportTo: Buffer is too small\n");
+    return errCode;
+}
+
+ConcurrentSet::SnapshotIterator* ConcurrentSet::createIterator(bool atEnd) {
+    SnapshotIterator* iterator = new(std::nothrow) SnapshotIterator(this, _dim);
+    if (!iterator)
+        return NULL;
+    lockAll();
+    for (int i = 0; i < _shards.size(); i++) {
+        unsigned int count, dim;
+        double const* data;
+        if (_shards[i]->set->getData(count, dim, data) == ERR_OK) {
+            for (unsigned int j = 0; j < count * dim; j++)
+                iterator->_snapshot.append(data[j]);
+        }
+    }
+    unlockAll();
+    if (iterator->_snapshot.isEmpty()) {
+        delete iterator;
+        return NULL;
+    }
+    if (atEnd)
+        iterator->_pos = iterator->_snapshot.size() / _dim - 1;
+    _iteratorsMutex.lock();
+    _iterators.append(iterator);
+    _iteratorsMutex.unlock();
+    return iterator;
+}
+
+ISet::IIterator* ConcurrentSet::end() {
+    SnapshotIterator* iterator = createIterator(true);
+    if (!iterator) {
+        ILog::report("ISet.end: Can not create iterator of empty set\n");
+        return NULL;
+    }
+    return iterator;
+}
+
+ISet::IIterator* ConcurrentSet::begin() {
+    SnapshotIterator* iterator = createIterator(false);
+    if (!iterator) {
+        ILog::report("ISet.begin: Can not create iterator of empty set\n");
+        return NULL;
+    }
+    return iterator;
+}
+
+int ConcurrentSet::findIterator(ISet::IIterator const * pIter) const {
+    for (int i = 0; i < _iterators.size(); i++) {
+        if (dynamic_cast<ISet::IIterator*>(_iterators[i]) == pIter) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ConcurrentSet::deleteIterator(IIterator * pIter) {
+    if (!pIter) {
+        ILog::report("ISet.deleteIterator: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    _iteratorsMutex.lock();
+    int indIterator = findIterator(pIter);
+    if (indIterator != -1) {
+        delete _iterators[indIterator];
+        _iterators.remove(indIterator);
+    }
+    _iteratorsMutex.unlock();
+
+    if (indIterator == -1) {
+        ILog::report("ISet.deleteIterator: Set does not contain input iterator\n");
+        return ERR_WRONG_ARG;
+    }
+    return ERR_OK;
+}
+
+int ConcurrentSet::getByIterator(IIterator const* pIter, IVector*& pItem) const {
+    unsigned int dim;
+    double const* coords;
+    int errCode = getCoordsPtrByIterator(pIter, dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    pItem = IVector::createVector(dim, coords);
+    if (!pItem) {
+        ILog::report("ISet.getByIterator: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+    return ERR_OK;
+}
+
+/*iterators own their snapshots, so coordinates stay valid until the iterator is deleted*/
+int ConcurrentSet::getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    if (!pIter) {
+        ILog::report("ISet.getByIterator: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    _iteratorsMutex.lock();
+    int indIterator = findIterator(pIter);
+    if (indIterator != -1) {
+        SnapshotIterator const* iterator = _iterators[indIterator];
+        dim = _dim;
+        coords = iterator->_snapshot.constData() + iterator->_pos * _dim;
+    }
+    _iteratorsMutex.unlock();
+
+    if (indIterator == -1) {
+        ILog::report("ISet.getByIterator: Set does not contain input iterator\n");
+        return ERR_WRONG_ARG;
+    }
+    return ERR_OK;
+}
+
+int ConcurrentSet::SnapshotIterator::next() {
+    if (_pos + 1 >= _snapshot.size() / _dim) {
+        ILog::report("ISet.next: Iterator already at the end of the set\n");
+        return ERR_OUT_OF_RANGE;
+    }
+    _pos++;
+    return ERR_OK;
+}
+
+int ConcurrentSet::SnapshotIterator::prev() {
+    if (_pos == 0) {
+        ILog::report("ISet.prev: Iterator already at the begin of the set\n");
+        return ERR_OUT_OF_RANGE;
+    }
+    _pos--;
+    return ERR_OK;
+}
+
+bool ConcurrentSet::SnapshotIterator::isEnd() const {
+    return _pos == _snapshot.size() / _dim - 1;
+}
+
+bool ConcurrentSet::SnapshotIterator::isBegin() const {
+    return _pos == 0;
+}
+
+ConcurrentSet::SnapshotIterator::SnapshotIterator(ISet const* const set, unsigned int dim): ISet::IIterator(set, 0), _dim(dim), _pos(0) {}
@@ -0,0 +1,1875 @@
+#include <new>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QLocale>
+#include <QMap>
+#include <QMutex>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTemporaryFile>
+#include <QThreadStorage>
+#include <QVector>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#endif
+
+#include "ILog.h"
+#include "IBrocker.h"
+#include "IProblem.h"
+#include "IVector.h"
+
+namespace {
+
+/*operations of expression graph and of bytecode*/
+enum Operation {
+    OP_CONST,
+    OP_ARG,
+    OP_PARAM,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_POWI,
+    OP_NEG,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_ATAN,
+    OP_EXP,
+    OP_LOG,
+    OP_SQRT,
+    OP_ABS,
+    OP_SIGN
+};
+
+/*points are evaluated by blocks, every instruction runs over the whole block*/
+size_t const BLOCK_SIZE = 64;
+
+/*node of expression graph: operands are nodes created before, index of variable
+  of OP_ARG and OP_PARAM is kept in 'a', exponent of OP_POWI and constant in 'value'*/
+struct Node {
+    int op, a, b;
+    double value;
+    bool byArgs, byParams;
+};
+
+/*equal nodes are created once, so common subexpressions are shared*/
+struct NodeKey {
+    int op, a, b;
+    quint64 bits;
+
+    bool operator<(NodeKey const& right) const {
+        if (op != right.op)
+            return op < right.op;
+        if (a != right.a)
+            return a < right.a;
+        if (b != right.b)
+            return b < right.b;
+        return bits < right.bits;
+    }
+};
+
+struct Function {
+    char const* name;
+    int op;
+};
+
+Function const FUNCTIONS[] = {
+    {"sin", OP_SIN},
+    {"cos", OP_COS},
+    {"tan", OP_TAN},
+    {"atan", OP_ATAN},
+    {"exp", OP_EXP},
+    {"log", OP_LOG},
+    {"sqrt", OP_SQRT},
+    {"abs", OP_ABS},
+    {"sign", OP_SIGN}
+};
+
+double powi(double x, int n) {
+    unsigned int m = n < 0 ? -n : n;
+    double res = 1;
+
+    for (; m; m >>= 1, x *= x) {
+        if (m & 1)
+            res *= x;
+    }
+
+    return n < 0 ? 1 / res : res;
+}
+
+double apply(int op, double x, double y) {
+    switch (op) {
+    case OP_ADD: return x + y;
+    case OP_SUB: return x - y;
+    case OP_MUL: return x * y;
+    case OP_DIV: return x / y;
+    case OP_POW: return std::pow(x, y);
+    case OP_POWI: return powi(x, (int)y);
+    case OP_NEG: return -x;
+    case OP_SIN: return std::sin(x);
+    case OP_COS: return std::cos(x);
+    case OP_TAN: return std::tan(x);
+    case OP_ATAN: return std::atan(x);
+    case OP_EXP: return std::exp(x);
+    case OP_LOG: return std::log(x);
+    case OP_SQRT: return std::sqrt(x);
+    case OP_ABS: return std::fabs(x);
+    case OP_SIGN: return x > 0 ? 1 : (x < 0 ? -1 : 0);
+    default: return 0;
+    }
+}
+
+/*graph of formula over args x0, x1, ... and params p0, p1, ...;
+  builders fold constants and drop neutral operands*/
+class Expression {
+
+public:
+
+    bool parse(char const* text);
+
+    int constant(double value);
+    int variable(int op, int index);
+    int unary(int op, int a);
+    int binary(int op, int a, int b);
+    int power(int a, int n);
+
+    /*derivative of 'node' by variable (op is OP_ARG or OP_PARAM), 'memo' keeps derivatives of nodes by the same variable*/
+    int derivative(int node, int op, int index, QMap<int, int>& memo);
+
+    Node const& node(int i) const { return _nodes[i]; }
+    int getRoot() const { return _root; }
+    size_t getArgsDim() const { return _dimArgs; }
+    size_t getParamsDim() const { return _dimParams; }
+
+    /*ctor*/
+    Expression();
+
+private:
+
+    int add(Node const& node);
+
+    int parseSum();
+    int parseProduct();
+    int parseUnary();
+    int parsePower();
+    int parsePrimary();
+    void skipSpaces();
+
+    QVector<Node> _nodes;
+    QMap<NodeKey, int> _index;
+    char const *_text, *_pos;
+    int _root;
+    size_t _dimArgs, _dimParams;
+
+};
+
+/*native code of program: the same arguments as Program::run*/
+typedef void (*Kernel)(size_t count, double const* points, size_t dim, double const* fixed, double* res);
+
+struct Instruction {
+    int op;
+    unsigned int dst, a, b, index;
+    double value;
+};
+
+/*straight-line register code of several outputs; instructions which don't depend on varying
+  vector form prologue evaluated once per call, registers are reused after last use*/
+class Program {
+
+public:
+
+    void compile(Expression const& expr, QVector<int> const& outputs, IProblem::DerivedType dr);
+
+    /*'count' points of varying vector (dim doubles each), 'fixed' is the other vector;
+      outputs of every point are written one after another to 'res'*/
+    void run(size_t count, double const* points, size_t dim, double const* fixed, double* res) const;
+
+    size_t getOutputsCount() const { return _outputs.size(); }
+
+    /*C++ function 'name' doing the same as run(), registers become local variables*/
+    void emit(QByteArray& source, char const* name) const;
+    void setKernel(Kernel kernel) { _kernel = kernel; }
+
+    /*ctor*/
+    Program();
+
+private:
+
+    static void execute(QVector<Instruction> const& code, double* regs, size_t count,
+                        int varying, double const* points, size_t dim, double const* fixed);
+
+    QVector<Instruction> _prologue, _body;
+    QVector<unsigned int> _outputs;
+    unsigned int _registers;
+    int _varying;
+    Kernel _kernel;
+
+};
+
+class ExpressionProblem : public IProblem {
+
+public:
+
+    int getId() const;
+
+    int goalFunction(IVector const* args, IVector const* params, double& res) const;
+    int goalFunctionByArgs(IVector const*  args, double& res) const;
+    int goalFunctionByParams(IVector const*  params, double& res) const;
+    int goalFunctionByArgsBatch(size_t count, double const* args, double* res) const;
+    int goalFunctionByParamsBatch(size_t count, double const* params, double* res) const;
+    int valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const;
+    int valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const;
+    int gradientByArgs(IVector const* args, IVector* grad) const;
+    int gradientByParams(IVector const* params, IVector* grad) const;
+    int hessianByArgs(IVector const* args, double* hessian) const;
+    int hessianByParams(IVector const* params, double* hessian) const;
+    int getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const;
+    int getArgsDim(size_t& dim) const;
+    int getParamsDim(size_t& dim) const;
+
+    int setParams(IVector const* params);
+    int setArgs(IVector const* args);
+    int bindParams(double const* params, size_t dim);
+    int bindArgs(double const* args, size_t dim);
+
+    bool isReentrant() const;
+    IProblem* createWorkerInstance() const;
+    int releaseWorkerInstance();
+
+    int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
+    int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const;
+    int derivativeGoalFunctionByParams(size_t order, size_t idx, DerivedType dr, double& value, IVector const* params) const;
+
+    /*factory, formula is parsed and value and gradient are compiled to bytecode (second order
+      derivatives on first use) or, if 'native', all of them to machine code by system compiler*/
+    static ExpressionProblem* createProblem(char const* formula, bool native);
+
+    /*dtor*/
+    ~ExpressionProblem();
+
+private:
+
+    /*ctor*/
+    ExpressionProblem(Expression const& expr);
+
+    void compile(DerivedType dr);
+    void compileSecondOrder(DerivedType dr) const;
+    int compileNative();
+    int getFixed(DerivedType dr, double const*& coords, const char* message) const;
+    int value(DerivedType dr, IVector const* point, double& res, const char* message) const;
+    int gradient(DerivedType dr, IVector const* point, double* value, IVector* grad, const char* message) const;
+    int hessian(DerivedType dr, IVector const* point, double* hessian, const char* message) const;
+    int derivative(size_t order, size_t idx, DerivedType dr, double& value, double const* a, double const* p) const;
+    int higherDerivative(size_t order, size_t idx, DerivedType dr, double& value, double const* point, double const* fixed) const;
+
+    mutable Expression _expr;
+    size_t _dimArgs, _dimParams;
+    IVector *_args, *_params;
+    /*buffers bound by caller are used instead of stored vectors*/
+    double const *_boundArgs, *_boundParams;
+
+    /*programs by args and by params: value; value and gradient; diagonal of Hessian; Hessian;
+      second order ones are built on first use, graph grows then, so it is guarded by mutex*/
+    Program _value[DIMENSION_DERIVED], _gradient[DIMENSION_DERIVED];
+    mutable Program _diagonal[DIMENSION_DERIVED], _hessian[DIMENSION_DERIVED];
+    mutable QVector<int> _hessianNodes[DIMENSION_DERIVED];
+    mutable bool _secondOrder[DIMENSION_DERIVED];
+    mutable QMutex _mutex;
+    QLibrary *_library;
+    /*made by createWorkerInstance, so it may be released by releaseWorkerInstance*/
+    bool _isWorker;
+
+};
+
+class ExpressionBrocker : public IBrocker {
+
+public:
+
+    int getId() const;
+
+    bool canCastTo(Type type) const;
+    void* getInterfaceImpl(Type type) const;
+
+    int release();
+
+    IBrocker* createWorkerBrocker() const;
+
+    /*ctor*/
+    ExpressionBrocker(ExpressionProblem *problem);
+
+    /*dtor*/
+    ~ExpressionBrocker();
+
+private:
+
+    ExpressionProblem *_problem;
+
+};
+
+}
+
+Expression::Expression():
+    _text(NULL), _pos(NULL), _root(-1), _dimArgs(0), _dimParams(0)
+{}
+
+int Expression::add(Node const& node) {
+    NodeKey key = {node.op, node.a, node.b, 0};
+    memcpy(&key.bits, &node.value, sizeof(key.bits));
+
+    QMap<NodeKey, int>::iterator it = _index.find(key);
+    if (it != _index.end())
+        return it.value();
+
+    _nodes.append(node);
+    _index.insert(key, _nodes.size() - 1);
+
+    return _nodes.size() - 1;
+}
+
+int Expression::constant(double value) {
+    Node node = {OP_CONST, -1, -1, value, false, false};
+    return add(node);
+}
+
+int Expression::variable(int op, int index) {
+    if (op == OP_ARG && (size_t)index >= _dimArgs)
+        _dimArgs = index + 1;
+    if (op == OP_PARAM && (size_t)index >= _dimParams)
+        _dimParams = index + 1;
+
+    Node node = {op, index, -1, 0, op == OP_ARG, op == OP_PARAM};
+    return add(node);
+}
+
+int Expression::unary(int op, int a) {
+    Node x = _nodes[a];
+
+    if (x.op == OP_CONST)
+        return constant(apply(op, x.value, 0));
+
+    if (op == OP_NEG && x.op == OP_NEG)
+        return x.a;
+
+    Node node = {op, a, -1, 0, x.byArgs, x.byParams};
+    return add(node);
+}
+
+int Expression::power(int a, int n) {
+    Node x = _nodes[a];
+
+    if (n == 0)
+        return constant(1);
+    if (n == 1)
+        return a;
+    if (x.op == OP_CONST)
+        return constant(powi(x.value, n));
+
+    Node node = {OP_POWI, a, -1, (double)n, x.byArgs, x.byParams};
+    return add(node);
+}
+
+int Expression::binary(int op, int a, int b) {
+    Node x = _nodes[a], y = _nodes[b];
+    bool cx = x.op == OP_CONST, cy = y.op == OP_CONST;
+
+    if (cx && cy)
+        return constant(apply(op, x.value, y.value));
+
+    switch (op) {
+    case OP_ADD:
+        if (cx && x.value == 0)
+            return b;
+        if (cy && y.value == 0)
+            return a;
+        if (a > b)
+            std::swap(a, b);
+        break;
+    case OP_SUB:
+        if (cy && y.value == 0)
+            return a;
+        if (cx && x.value == 0)
+            return unary(OP_NEG, b);
+        if (a == b)
+            return constant(0);
+        break;
+    case OP_MUL:
+        if ((cx && x.value == 0) || (cy && y.value == 0))
+            return constant(0);
+        if (cx && x.value == 1)
+            return b;
+        if (cy && y.value == 1)
+            return a;
+        if (cx && x.value == -1)
+            return unary(OP_NEG, b);
+        if (cy && y.value == -1)
+            return unary(OP_NEG, a);
+        if (a > b)
+            std::swap(a, b);
+        break;
+    case OP_DIV:
+        if (cx && x.value == 0)
+            return constant(0);
+        if (cy && y.value == 1)
+            return a;
+        break;
+    case OP_POW:
+        if (cy && y.value == std::floor(y.value) && std::fabs(y.value) <= 64)
+            return power(a, (int)y.value);
+        break;
+    }
+
+    Node node = {op, a, b, 0, x.byArgs || y.byArgs, x.byParams || y.byParams};
+    return add(node);
+}
+
+int Expression::derivative(int node, int op, int index, QMap<int, int>& memo) {
+    QMap<int, int>::iterator it = memo.find(node);
+    if (it != memo.end())
+        return it.value();
+
+    Node n = _nodes[node];
+    int res;
+
+    if (!(op == OP_ARG ? n.byArgs : n.byParams)) {
+        res = constant(0);
+    } else {
+        int da = n.a >= 0 && n.op != OP_ARG && n.op != OP_PARAM ? derivative(n.a, op, index, memo) : -1;
+        int db = n.b >= 0 ? derivative(n.b, op, index, memo) : -1;
+
+        switch (n.op) {
+        case OP_ARG:
+        case OP_PARAM:
+            res = constant(n.op == op && n.a == index ? 1 : 0);
+            break;
+        case OP_ADD:
+        case OP_SUB:
+            res = binary(n.op, da, db);
+            break;
+        case OP_MUL:
+            res = binary(OP_ADD, binary(OP_MUL, da, n.b), binary(OP_MUL, n.a, db));
+            break;
+        case OP_DIV:
+            res = binary(OP_DIV, binary(OP_SUB, da, binary(OP_MUL, node, db)), n.b);
+            break;
+        case OP_POW:
+            res = binary(OP_MUL, node, binary(OP_ADD, binary(OP_MUL, db, unary(OP_LOG, n.a)),
+                                              binary(OP_DIV, binary(OP_MUL, n.b, da), n.a)));
+            break;
+        case OP_POWI:
+            res = binary(OP_MUL, binary(OP_MUL, constant(n.value), power(n.a, (int)n.value - 1)), da);
+            break;
+        case OP_NEG:
+            res = unary(OP_NEG, da);
+            break;
+        case OP_SIN:
+            res = binary(OP_MUL, unary(OP_COS, n.a), da);
+            break;
+        case OP_COS:
+            res = binary(OP_MUL, unary(OP_NEG, unary(OP_SIN, n.a)), da);
+            break;
+        case OP_TAN:
+            res = binary(OP_MUL, binary(OP_ADD, constant(1), binary(OP_MUL, node, node)), da);
+            break;
+        case OP_ATAN:
+            res = binary(OP_DIV, da, binary(OP_ADD, constant(1), binary(OP_MUL, n.a, n.a)));
+            break;
+        case OP_EXP:
+            res = binary(OP_MUL, node, da);
+            break;
+        case OP_LOG:
+            res = binary(OP_DIV, da, n.a);
+            break;
+        case OP_SQRT:
+            res = binary(OP_DIV, da, binary(OP_MUL, constant(2), node));
+            break;
+        case OP_ABS:
+            res = binary(OP_MUL, unary(OP_SIGN, n.a), da);
+            break;
+        default:
+            res = constant(0);
+            break;
+        }
+    }
+
+    memo.insert(node, res);
+    return res;
+}
+
+/*grammar: sum = product {('+' | '-') product}, product = unary {('*' | '/') unary},
+  unary = '-' unary | power, power = primary ['^' unary],
+  primary = number | x<i> | p<i> | pi | e | function '(' sum ')' | '(' sum ')'*/
+bool Expression::parse(char const* text) {
+    if (!text) {
+        ILog::report("ExpressionProblem.parse: Input argument text is nullptr\n");
+        return false;
+    }
+
+    _text = _pos = text;
+    _root = parseSum();
+    skipSpaces();
+
+    if (_root >= 0 && *_pos == '\0')
+        return true;
+
+    QByteArray message = "ExpressionProblem.parse: Syntax error at position ";
+    message += QByteArray::number((int)(_pos - _text));
+    message += "\n";
+    ILog::report(message.constData());
+    _root = -1;
+
+    return false;
+}
+
+void Expression::skipSpaces() {
+    while (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r')
+        _pos++;
+}
+
+int Expression::parseSum() {
+    int left = parseProduct();
+
+    while (left >= 0) {
+        skipSpaces();
+        char c = *_pos;
+        if (c != '+' && c != '-')
+            break;
+        _pos++;
+        int right = parseProduct();
+        if (right < 0)
+            return -1;
+        left = binary(c == '+' ? OP_ADD : OP_SUB, left, right);
+    }
+
+    return left;
+}
+
+int Expression::parseProduct() {
+    int left = parseUnary();
+
+    while (left >= 0) {
+        skipSpaces();
+        char c = *_pos;
+        if (c != '*' && c != '/')
+            break;
+        _pos++;
+        int right = parseUnary();
+        if (right < 0)
+            return -1;
+        left = binary(c == '*' ? OP_MUL : OP_DIV, left, right);
+    }
+
+    return left;
+}
+
+int Expression::parseUnary() {
+    skipSpaces();
+
+    if (*_pos == '-') {
+        _pos++;
+        int a = parseUnary();
+        return a < 0 ? -1 : unary(OP_NEG, a);
+    }
+
+    if (*_pos == '+') {
+        _pos++;
+        return parseUnary();
+    }
+
+    return parsePower();
+}
+
+int Expression::parsePower() {
+    int base = parsePrimary();
+
+    if (base < 0)
+        return -1;
+
+    skipSpaces();
+
+    if (*_pos != '^')
+        return base;
+
+    _pos++;
+    int exponent = parseUnary();
+
+    return exponent < 0 ? -1 : binary(OP_POW, base, exponent);
+}
+
+int Expression::parsePrimary() {
+    skipSpaces();
+
+    if (*_pos == '(') {
+        _pos++;
+        int res = parseSum();
+        skipSpaces();
+        if (res < 0 || *_pos != ')')
+            return -1;
+        _pos++;
+        return res;
+    }
+
+    if ((*_pos >= '0' && *_pos <= '9') || *_pos == '.') {
+        /*number is scanned here and converted by C locale, strtod would stop at '.' under locales with decimal comma*/
+        char const* number = _pos;
+        while ((*_pos >= '0' && *_pos <= '9') || *_pos == '.')
+            _pos++;
+        if (*_pos == 'e' || *_pos == 'E') {
+            char const* exponent = _pos + ((_pos[1] == '+' || _pos[1] == '-') ? 2 : 1);
+            if (*exponent >= '0' && *exponent <= '9') {
+                _pos = exponent;
+                while (*_pos >= '0' && *_pos <= '9')
+                    _pos++;
+            }
+        }
+        bool ok;
+        double value = QLocale::c().toDouble(QString::fromLatin1(number, (int)(_pos - number)), &ok);
+        if (!ok)
+            return -1;
+        return constant(value);
+    }
+
+    char const* name = _pos;
+    while ((*_pos >= 'a' && *_pos <= 'z') || (*_pos >= 'A' && *_pos <= 'Z'))
+        _pos++;
+    size_t length = _pos - name;
+
+    if (length == 0)
+        return -1;
+
+    if (length == 1 && (*name == 'x' || *name == 'p') && *_pos >= '0' && *_pos <= '9') {
+        long index = strtol(_pos, const_cast<char**>(&_pos), 10);
+        if (index > 65535)
+            return -1;
+        return variable(*name == 'x' ? OP_ARG : OP_PARAM, (int)index);
+    }
+
+    if (length == 2 && strncmp(name, "pi", 2) == 0)
+        return constant(4 * std::atan(1.0));
+
+    if (length == 1 && *name == 'e')
+        return constant(std::exp(1.0));
+
+    for (size_t i = 0; i < sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]); i++) {
+        if (strlen(FUNCTIONS[i].name) != length || strncmp(FUNCTIONS[i].name, name, length) != 0)
+            continue;
+
+        skipSpaces();
+        if (*_pos != '(')
+            return -1;
+        _pos++;
+        int a = parseSum();
+        skipSpaces();
+        if (a < 0 || *_pos != ')')
+            return -1;
+        _pos++;
+        return unary(FUNCTIONS[i].op, a);
+    }
+
+    _pos = name;
+    return -1;
+}
+
+Program::Program():
+    _registers(0), _varying(OP_ARG), _kernel(NULL)
+{}
+
+void Program::compile(Expression const& expr, QVector<int> const& outputs, IProblem::DerivedType dr) {
+    _varying = dr == IProblem::BY_ARGS ? OP_ARG : OP_PARAM;
+    _prologue.clear();
+    _body.clear();
+    _outputs.clear();
+
+    int last = -1;
+    for (int i = 0; i < outputs.size(); i++)
+        last = std::max(last, outputs[i]);
+
+    /*nodes needed by outputs and position of last use of every node*/
+    QVector<char> needed(last + 1, 0);
+    QVector<int> lastUse(last + 1, -1);
+
+    for (int i = 0; i < outputs.size(); i++) {
+        needed[outputs[i]] = 1;
+        lastUse[outputs[i]] = last + 1;
+    }
+
+    for (int i = last; i >= 0; i--) {
+        Node const& node = expr.node(i);
+        if (!needed[i] || node.op == OP_CONST || node.op == OP_ARG || node.op == OP_PARAM)
+            continue;
+        needed[node.a] = 1;
+        lastUse[node.a] = std::max(lastUse[node.a], i);
+        if (node.b >= 0) {
+            needed[node.b] = 1;
+            lastUse[node.b] = std::max(lastUse[node.b], i);
+        }
+    }
+
+    QVector<unsigned int> reg(last + 1, 0), free;
+    _registers = 0;
+
+    for (int i = 0; i <= last; i++) {
+        if (!needed[i])
+            continue;
+
+        Node const& node = expr.node(i);
+        bool invariant = !(dr == IProblem::BY_ARGS ? node.byArgs : node.byParams);
+        bool load = node.op == OP_CONST || node.op == OP_ARG || node.op == OP_PARAM;
+
+        /*registers of operands used for the last time are free for result*/
+        if (!invariant && !load) {
+            int operands[2] = {node.a, node.b};
+            for (int k = 0; k < 2; k++) {
+                int o = operands[k];
+                if (o < 0 || (k == 1 && o == node.a) || lastUse[o] != i)
+                    continue;
+                Node const& operand = expr.node(o);
+                if (dr == IProblem::BY_ARGS ? operand.byArgs : operand.byParams)
+                    free.append(reg[o]);
+            }
+        }
+
+        if (!invariant && !free.isEmpty()) {
+            reg[i] = free.last();
+            free.resize(free.size() - 1);
+        } else {
+            reg[i] = _registers++;
+        }
+
+        Instruction ins = {node.op, reg[i], load ? 0 : reg[node.a], load || node.b < 0 ? 0 : reg[node.b],
+                           load && node.op != OP_CONST ? (unsigned int)node.a : 0, node.value};
+        (invariant ? _prologue : _body).append(ins);
+    }
+
+    for (int i = 0; i < outputs.size(); i++)
+        _outputs.append(reg[outputs[i]]);
+}
+
+void Program::execute(QVector<Instruction> const& code, double* regs, size_t count,
+                      int varying, double const* points, size_t dim, double const* fixed) {
+    for (int i = 0; i < code.size(); i++) {
+        Instruction const& ins = code[i];
+        double *d = regs + ins.dst * BLOCK_SIZE;
+        double const *x = regs + ins.a * BLOCK_SIZE, *y = regs + ins.b * BLOCK_SIZE;
+        size_t k;
+
+        switch (ins.op) {
+        case OP_CONST:
+            for (k = 0; k < count; k++) d[k] = ins.value;
+            break;
+        case OP_ARG:
+        case OP_PARAM:
+            if (ins.op == varying) {
+                for (k = 0; k < count; k++) d[k] = points[k * dim + ins.index];
+            } else {
+                for (k = 0; k < count; k++) d[k] = fixed[ins.index];
+            }
+            break;
+        case OP_ADD:
+            for (k = 0; k < count; k++) d[k] = x[k] + y[k];
+            break;
+        case OP_SUB:
+            for (k = 0; k < count; k++) d[k] = x[k] - y[k];
+            break;
+        case OP_MUL:
+            for (k = 0; k < count; k++) d[k] = x[k] * y[k];
+            break;
+        case OP_DIV:
+            for (k = 0; k < count; k++) d[k] = x[k] / y[k];
+            break;
+        case OP_POW:
+            for (k = 0; k < count; k++) d[k] = std::pow(x[k], y[k]);
+            break;
+        case OP_POWI:
+            if (ins.value == 2) {
+                for (k = 0; k < count; k++) d[k] = x[k] * x[k];
+            } else {
+                for (k = 0; k < count; k++) d[k] = powi(x[k], (int)ins.value);
+            }
+            break;
+        case OP_NEG:
+            for (k = 0; k < count; k++) d[k] = -x[k];
+            break;
+        case OP_SQRT:
+            for (k = 0; k < count; k++) d[k] = std::sqrt(x[k]);
+            break;
+        case OP_ABS:
+            for (k = 0; k < count; k++) d[k] = std::fabs(x[k]);
+            break;
+        default:
+            for (k = 0; k < count; k++) d[k] = apply(ins.op, x[k], 0);
+            break;
+        }
+    }
+}
+
+void Program::run(size_t count, double const* points, size_t dim, double const* fixed, double* res) const {
+    if (_kernel) {
+        _kernel(count, points, dim, fixed, res);
+        return;
+    }
+
+    /*registers of every thread are reused by all programs, they only grow*/
+    static QThreadStorage<QVector<double>*> buffers;
+
+    if (!buffers.hasLocalData())
+        buffers.setLocalData(new QVector<double>());
+
+    QVector<double>& regs = *buffers.localData();
+
+    if ((size_t)regs.size() < _registers * BLOCK_SIZE)
+        regs.resize(_registers * BLOCK_SIZE);
+
+    double *r = regs.data();
+    size_t outputs = _outputs.size();
+
+    /*invariant part is evaluated once and broadcast over the block*/
+    execute(_prologue, r, 1, _varying, points, dim, fixed);
+    for (int i = 0; i < _prologue.size(); i++) {
+        double *d = r + _prologue[i].dst * BLOCK_SIZE;
+        for (size_t k = 1; k < BLOCK_SIZE; k++)
+            d[k] = d[0];
+    }
+
+    for (size_t first = 0; first < count; first += BLOCK_SIZE) {
+        size_t n = std::min(BLOCK_SIZE, count - first);
+
+        execute(_body, r, n, _varying, points + first * dim, dim, fixed);
+
+        for (size_t o = 0; o < outputs; o++) {
+            double const *s = r + _outputs[o] * BLOCK_SIZE;
+            for (size_t k = 0; k < n; k++)
+                res[(first + k) * outputs + o] = s[k];
+        }
+    }
+}
+
+QByteArray operand(Instruction const& ins, int varying) {
+    char buffer[64];
+
+    switch (ins.op) {
+    case OP_CONST:
+        if (ins.value != ins.value)
+            return "__builtin_nan(\"\")";
+        if (ins.value - ins.value != 0)
+            return ins.value > 0 ? "__builtin_inf()" : "-__builtin_inf()";
+        /*QByteArray::number uses C locale, sprintf would emit decimal comma which compiles as comma operator*/
+        return QByteArray::number(ins.value, 'g', 17);
+    case OP_ARG:
+    case OP_PARAM:
+        sprintf(buffer, ins.op == varying ? "points[%u]" : "fixed[%u]", ins.index);
+        return buffer;
+    }
+
+    char const* format;
+
+    switch (ins.op) {
+    case OP_ADD: format = "r%u + r%u"; break;
+    case OP_SUB: format = "r%u - r%u"; break;
+    case OP_MUL: format = "r%u * r%u"; break;
+    case OP_DIV: format = "r%u / r%u"; break;
+    case OP_POW: format = "pow(r%u, r%u)"; break;
+    case OP_NEG: format = "-r%u"; break;
+    case OP_SIN: format = "sin(r%u)"; break;
+    case OP_COS: format = "cos(r%u)"; break;
+    case OP_TAN: format = "tan(r%u)"; break;
+    case OP_ATAN: format = "atan(r%u)"; break;
+    case OP_EXP: format = "exp(r%u)"; break;
+    case OP_LOG: format = "log(r%u)"; break;
+    case OP_SQRT: format = "sqrt(r%u)"; break;
+    case OP_ABS: format = "fabs(r%u)"; break;
+    default: format = "powi(r%u, %d)"; break;
+    }
+
+    if (ins.op == OP_SIGN)
+        sprintf(buffer, "(double)((r%u > 0) - (r%u < 0))", ins.a, ins.a);
+    else if (ins.op == OP_POWI)
+        sprintf(buffer, format, ins.a, (int)ins.value);
+    else
+        sprintf(buffer, format, ins.a, ins.b);
+
+    return buffer;
+}
+
+void Program::emit(QByteArray& source, char const* name) const {
+    char buffer[128];
+
+    source += "extern \"C\" EXPORT void ";
+    source += name;
+    source += "(size_t count, double const* points, size_t dim, double const* fixed, double* res)\n{\n";
+
+    for (unsigned int i = 0; i < _registers; i++) {
+        sprintf(buffer, "    double r%u = 0;\n", i);
+        source += buffer;
+    }
+
+    for (int i = 0; i < _prologue.size(); i++) {
+        sprintf(buffer, "    r%u = ", _prologue[i].dst);
+        source += buffer;
+        source += operand(_prologue[i], _varying);
+        source += ";\n";
+    }
+
+    sprintf(buffer, "    for (size_t k = 0; k < count; k++, points += dim, res += %d) {\n", _outputs.size());
+    source += buffer;
+
+    for (int i = 0; i < _body.size(); i++) {
+        sprintf(buffer, "        r%u = ", _body[i].dst);
+        source += buffer;
+        source += operand(_body[i], _varying);
+        source += ";\n";
+    }
+
+    for (int i = 0; i < _outputs.size(); i++) {
+        sprintf(buffer, "        res[%d] = r%u;\n", i, _outputs[i]);
+        source += buffer;
+    }
+
+    source += "    }\n}\n\n";
+}
+
+ExpressionProblem* ExpressionProblem::createProblem(char const* formula, bool native) {
+    Expression expr;
+
+    if (!expr.parse(formula))
+        return NULL;
+
+    ExpressionProblem *problem = new (std::nothrow) ExpressionProblem(expr);
+
+    if (!problem) {
+        ILog::report("ExpressionProblem.createProblem: not enough memory\n");
+        return NULL;
+    }
+
+    problem->compile(BY_ARGS);
+    problem->compile(BY_PARAMS);
+
+    if (native && problem->compileNative() != ERR_OK)
+        ILog::report("ExpressionProblem.createProblem: native code isn't available, bytecode is used\n");
+
+    return problem;
+}
+
+char const* const KERNELS[] = {"value", "gradient", "diagonal", "hessian"};
+
+QByteArray getEnv(char const* name, char const* defaultValue) {
+    QByteArray value = qgetenv(name);
+    return value.isEmpty() ? QByteArray(defaultValue) : value;
+}
+
+/*-march=native code runs only on the same CPU, so its brand and features go to the hash*/
+QByteArray hostCpu() {
+    QByteArray cpu = QSysInfo::currentCpuArchitecture().toLatin1();
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    unsigned int regs[4], leaves[] = {1, 7, 0x80000002, 0x80000003, 0x80000004};
+
+    for (size_t i = 0; i < sizeof(leaves) / sizeof(leaves[0]); i++) {
+        if (__get_cpuid_max(leaves[i] & 0x80000000, NULL) < leaves[i])
+            continue;
+        __cpuid_count(leaves[i], 0, regs[0], regs[1], regs[2], regs[3]);
+        /*stepping and APIC id of leaf 1 differ between equal cores*/
+        if (leaves[i] == 1) {
+            regs[0] &= 0x0fff0ff0;
+            regs[1] = 0;
+        }
+        cpu.append(reinterpret_cast<char const*>(regs), sizeof(regs));
+    }
+#endif
+    return cpu;
+}
+
+/*cached code is loaded into the process, so nobody else may be able to replace it*/
+bool isTrusted(QFileInfo const& info) {
+    QFile::Permissions permissions = info.permissions();
+
+    if (permissions.testFlag(QFile::WriteGroup) || permissions.testFlag(QFile::WriteOther))
+        return false;
+#ifdef Q_OS_UNIX
+    return info.ownerId() == getuid();
+#else
+    return true;
+#endif
+}
+
+/*programs are emitted as C++ and built by system compiler into shared library named by hash
+  of source, command and host CPU, so the same formula is built once per machine; cache is
+  per user and neither it nor libraries may be writable by others*/
+int ExpressionProblem::compileNative() {
+    QByteArray source = "#include <cmath>\n#include <cstddef>\n\nusing namespace std;\n\n"
+                        "#ifdef _WIN32\n#define EXPORT __declspec(dllexport)\n#else\n#define EXPORT\n#endif\n\n"
+                        "static inline double powi(double x, int n)\n{\n"
+                        "    unsigned int m = n < 0 ? -n : n;\n    double res = 1;\n"
+                        "    for (; m; m >>= 1, x *= x)\n        if (m & 1)\n            res *= x;\n"
+                        "    return n < 0 ? 1 / res : res;\n}\n\n";
+    Program *programs[] = {_value, _gradient, _diagonal, _hessian};
+    char name[32];
+
+    /*library is built once, so it gets second order kernels too*/
+    for (int dr = BY_ARGS; dr < DIMENSION_DERIVED; dr++)
+        compileSecondOrder((DerivedType)dr);
+
+    for (int dr = BY_ARGS; dr < DIMENSION_DERIVED; dr++) {
+        for (int i = 0; i < 4; i++) {
+            sprintf(name, "%s_%d", KERNELS[i], dr);
+            programs[i][dr].emit(source, name);
+        }
+    }
+
+    QString compiler = QString::fromLocal8Bit(getEnv("EXPRESSION_PROBLEM_CXX", "c++").constData());
+    QStringList flags;
+    flags << "-O3" << "-march=native" << "-shared";
+#ifndef Q_OS_WIN
+    flags << "-fPIC";
+#endif
+
+    QByteArray key = source + compiler.toLocal8Bit() + flags.join(" ").toLocal8Bit() + hostCpu();
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex().constData());
+    QString path = QString::fromLocal8Bit(qgetenv("EXPRESSION_PROBLEM_CACHE").constData());
+
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        if (path.isEmpty()) {
+            ILog::report("ExpressionProblem.compileNative: There is no cache location\n");
+            return ERR_ANY_OTHER;
+        }
+        path = QDir(path).filePath("expression-problem");
+    }
+
+    QDir cache(path);
+    bool created = !cache.exists();
+
+    if (!cache.mkpath(cache.absolutePath())) {
+        ILog::report("ExpressionProblem.compileNative: Can't create cache directory\n");
+        return ERR_ANY_OTHER;
+    }
+
+    if (created)
+        QFile::setPermissions(cache.absolutePath(), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+
+    if (!isTrusted(QFileInfo(cache.absolutePath()))) {
+        ILog::report("ExpressionProblem.compileNative: Cache directory is writable by other users\n");
+        return ERR_ANY_OTHER;
+    }
+
+#ifdef Q_OS_WIN
+    QString library = cache.filePath("expression_" + hash + ".dll");
+#else
+    QString library = cache.filePath("expression_" + hash + ".so");
+#endif
+
+    /*library is built under unique temporary name and renamed, so concurrent runs never load a partial file*/
+    if (!QFile::exists(library)) {
+        QTemporaryFile file(cache.filePath("expression_XXXXXX.cpp")), built(cache.filePath("expression_XXXXXX.tmp"));
+
+        if (!file.open() || file.write(source) != source.size() || !built.open()) {
+            ILog::report("ExpressionProblem.compileNative: Can't write source file\n");
+            return ERR_ANY_OTHER;
+        }
+        file.close();
+        built.close();
+
+        flags << "-o" << built.fileName() << file.fileName();
+
+        if (QProcess::execute(compiler, flags) != 0) {
+            ILog::report("ExpressionProblem.compileNative: Compiler failed\n");
+            return ERR_ANY_OTHER;
+        }
+
+        /*linker creates output with umask of the process*/
+        QFile::setPermissions(built.fileName(), QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
+                                                QFile::ReadGroup | QFile::ExeGroup | QFile::ReadOther | QFile::ExeOther);
+
+        if (QFile::rename(built.fileName(), library))
+            built.setAutoRemove(false);
+    }
+
+    if (!isTrusted(QFileInfo(library))) {
+        ILog::report("ExpressionProblem.compileNative: Cached library is writable by other users\n");
+        return ERR_ANY_OTHER;
+    }
+
+    _library = new (std::nothrow) QLibrary(library);
+
+    if (!_library) {
+        ILog::report("ExpressionProblem.compileNative: not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+
+    if (!_library->load()) {
+        ILog::report("ExpressionProblem.compileNative: Can't load library\n");
+        return ERR_ANY_OTHER;
+    }
+
+    Kernel kernels[DIMENSION_DERIVED][4];
+
+    for (int dr = BY_ARGS; dr < DIMENSION_DERIVED; dr++) {
+        for (int i = 0; i < 4; i++) {
+            sprintf(name, "%s_%d", KERNELS[i], dr);
+            kernels[dr][i] = reinterpret_cast<Kernel>(_library->resolve(name));
+            if (!kernels[dr][i]) {
+                ILog::report("ExpressionProblem.compileNative: Can't resolve kernel\n");
+                return ERR_ANY_OTHER;
+            }
+        }
+    }
+
+    for (int dr = BY_ARGS; dr < DIMENSION_DERIVED; dr++) {
+        for (int i = 0; i < 4; i++)
+            programs[i][dr].setKernel(kernels[dr][i]);
+    }
+
+    return ERR_OK;
+}
+
+/*derivatives are built on the same graph, so they share nodes with goal function and each other*/
+void ExpressionProblem::compile(DerivedType dr) {
+    int op = dr == BY_ARGS ? OP_ARG : OP_PARAM;
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+    int root = _expr.getRoot();
+    QVector<int> value, gradient;
+
+    value.append(root);
+    gradient.append(root);
+
+    for (size_t i = 0; i < dim; i++) {
+        QMap<int, int> memo;
+        gradient.append(_expr.derivative(root, op, i, memo));
+    }
+
+    _value[dr].compile(_expr, value, dr);
+    _gradient[dr].compile(_expr, gradient, dr);
+}
+
+/*dim^2 nodes of Hessian are built only for problems asking for them; graph merges equal nodes,
+  so first derivatives are found again instead of being kept*/
+void ExpressionProblem::compileSecondOrder(DerivedType dr) const {
+    QMutexLocker locker(&_mutex);
+
+    if (_secondOrder[dr])
+        return;
+
+    int op = dr == BY_ARGS ? OP_ARG : OP_PARAM;
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+    int root = _expr.getRoot();
+    QVector<int> gradient, diagonal, hessian(dim * dim);
+    QVector<QMap<int, int> > memo(dim);
+
+    for (size_t i = 0; i < dim; i++)
+        gradient.append(_expr.derivative(root, op, i, memo[i]));
+
+    for (size_t i = 0; i < dim; i++) {
+        for (size_t j = i; j < dim; j++)
+            hessian[i * dim + j] = hessian[j * dim + i] = _expr.derivative(gradient[i], op, j, memo[j]);
+        diagonal.append(hessian[i * dim + i]);
+    }
+
+    _diagonal[dr].compile(_expr, diagonal, dr);
+    _hessian[dr].compile(_expr, hessian, dr);
+    _hessianNodes[dr] = hessian;
+    _secondOrder[dr] = true;
+}
+
+int ExpressionProblem::getId() const {
+    return IProblem::INTERFACE_1;
+}
+
+int ExpressionProblem::goalFunction(IVector const* args,
+                                    IVector const* params, double& res) const {
+    if (!args) {
+        ILog::report("IProblem.goalFunction: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (!params) {
+        ILog::report("IProblem.goalFunction: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.goalFunction: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.goalFunction: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA, dimP;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    _value[BY_ARGS].run(1, a, _dimArgs, p, &res);
+
+    return ERR_OK;
+}
+
+/*vector fixed while 'dr' one varies: bound buffer or stored vector*/
+int ExpressionProblem::getFixed(DerivedType dr, double const*& coords, const char* message) const {
+    double const *bound = dr == BY_ARGS ? _boundParams : _boundArgs;
+    IVector *stored = dr == BY_ARGS ? _params : _args;
+
+    /*formula without params (args) has nothing to fix*/
+    if (bound || (dr == BY_ARGS ? _dimParams : _dimArgs) == 0) {
+        coords = bound;
+        return ERR_OK;
+    }
+
+    if (!stored) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    unsigned int dim;
+
+    return stored->getCoordsPtr(dim, coords);
+}
+
+int ExpressionProblem::value(DerivedType dr, IVector const* point, double& res, const char* message) const {
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+
+    if (!point) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    if (dim != point->getDim()) {
+        ILog::report("IProblem.goalFunction: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimX;
+    const double *x, *f;
+    int ec;
+
+    if ((ec = getFixed(dr, f, dr == BY_ARGS ? "IProblem.goalFunctionByArgs: Params are not set\n" : "IProblem.goalFunctionByParams: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = point->getCoordsPtr(dimX, x)) != ERR_OK)
+        return ec;
+
+    _value[dr].run(1, x, dim, f, &res);
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::goalFunctionByArgs(IVector const*  args, double& res) const {
+    return value(BY_ARGS, args, res, "IProblem.goalFunctionByArgs: Input argument args is nullptr\n");
+}
+
+int ExpressionProblem::goalFunctionByParams(IVector const*  params, double& res) const {
+    return value(BY_PARAMS, params, res, "IProblem.goalFunctionByParams: Input argument params is nullptr\n");
+}
+
+int ExpressionProblem::goalFunctionByArgsBatch(size_t count, double const* args, double* res) const {
+    if (count > 0 && (!args || !res)) {
+        ILog::report("IProblem.goalFunctionByArgsBatch: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    const double *p;
+    int ec;
+
+    if ((ec = getFixed(BY_ARGS, p, "IProblem.goalFunctionByArgsBatch: Params are not set\n")) != ERR_OK)
+        return ec;
+
+    _value[BY_ARGS].run(count, args, _dimArgs, p, res);
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::goalFunctionByParamsBatch(size_t count, double const* params, double* res) const {
+    if (count > 0 && (!params || !res)) {
+        ILog::report("IProblem.goalFunctionByParamsBatch: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    const double *a;
+    int ec;
+
+    if ((ec = getFixed(BY_PARAMS, a, "IProblem.goalFunctionByParamsBatch: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    _value[BY_PARAMS].run(count, params, _dimParams, a, res);
+
+    return ERR_OK;
+}
+
+/*value and gradient are outputs of one program*/
+int ExpressionProblem::gradient(DerivedType dr, IVector const* point,
+                                double* value, IVector* grad, const char* message) const {
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+
+    if (!point || !grad) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    if (dim != point->getDim() || dim != grad->getDim()) {
+        ILog::report("IProblem.gradient: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimX;
+    const double *x, *f;
+    int ec;
+
+    if ((ec = getFixed(dr, f, dr == BY_ARGS ? "IProblem.gradientByArgs: Params are not set\n" : "IProblem.gradientByParams: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = point->getCoordsPtr(dimX, x)) != ERR_OK)
+        return ec;
+
+    QVector<double> res(dim + 1);
+    _gradient[dr].run(1, x, dim, f, res.data());
+
+    if (value)
+        *value = res[0];
+
+    return grad->setAllCoords(dim, res.data() + 1);
+}
+
+int ExpressionProblem::valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const {
+    return gradient(BY_ARGS, args, &value, grad, "IProblem.valueAndGradientByArgs: Input argument is nullptr\n");
+}
+
+int ExpressionProblem::valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const {
+    return gradient(BY_PARAMS, params, &value, grad, "IProblem.valueAndGradientByParams: Input argument is nullptr\n");
+}
+
+int ExpressionProblem::gradientByArgs(IVector const* args, IVector* grad) const {
+    return gradient(BY_ARGS, args, NULL, grad, "IProblem.gradientByArgs: Input argument is nullptr\n");
+}
+
+int ExpressionProblem::gradientByParams(IVector const* params, IVector* grad) const {
+    return gradient(BY_PARAMS, params, NULL, grad, "IProblem.gradientByParams: Input argument is nullptr\n");
+}
+
+int ExpressionProblem::hessian(DerivedType dr, IVector const* point, double* hessian, const char* message) const {
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+
+    if (!point || !hessian) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    if (dim != point->getDim()) {
+        ILog::report("IProblem.hessian: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimX;
+    const double *x, *f;
+    int ec;
+
+    if ((ec = getFixed(dr, f, dr == BY_ARGS ? "IProblem.hessianByArgs: Params are not set\n" : "IProblem.hessianByParams: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = point->getCoordsPtr(dimX, x)) != ERR_OK)
+        return ec;
+
+    compileSecondOrder(dr);
+    _hessian[dr].run(1, x, dim, f, hessian);
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::hessianByArgs(IVector const* args, double* hessian) const {
+    return this->hessian(BY_ARGS, args, hessian, "IProblem.hessianByArgs: Input argument is nullptr\n");
+}
+
+int ExpressionProblem::hessianByParams(IVector const* params, double* hessian) const {
+    return this->hessian(BY_PARAMS, params, hessian, "IProblem.hessianByParams: Input argument is nullptr\n");
+}
+
+/*entries of Hessian which are constant zero after simplification are structural zeros*/
+int ExpressionProblem::getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const {
+    if (dr != BY_ARGS && dr != BY_PARAMS) {
+        ILog::report("IProblem.getHessianSparsity: Input argument dr is unknown\n");
+        return ERR_WRONG_ARG;
+    }
+
+    compileSecondOrder(dr);
+
+    QMutexLocker locker(&_mutex);
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams, nonzeros = 0;
+    QVector<int> const& nodes = _hessianNodes[dr];
+
+    for (size_t i = 0; i < dim; i++) {
+        for (size_t j = i; j < dim; j++) {
+            Node const& node = _expr.node(nodes[i * dim + j]);
+            if (node.op != OP_CONST || node.value != 0)
+                nonzeros++;
+        }
+    }
+
+    rows = new (std::nothrow) size_t[nonzeros];
+    cols = new (std::nothrow) size_t[nonzeros];
+
+    if (!rows || !cols) {
+        ILog::report("IProblem.getHessianSparsity: Not enough memory\n");
+        delete[] rows;
+        delete[] cols;
+        rows = cols = NULL;
+        return ERR_MEMORY_ALLOCATION;
+    }
+
+    count = 0;
+    for (size_t i = 0; i < dim; i++) {
+        for (size_t j = i; j < dim; j++) {
+            Node const& node = _expr.node(nodes[i * dim + j]);
+            if (node.op == OP_CONST && node.value == 0)
+                continue;
+            rows[count] = i;
+            cols[count] = j;
+            count++;
+        }
+    }
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::getArgsDim(size_t& dim) const {
+    dim = _dimArgs;
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::getParamsDim(size_t& dim) const {
+    dim = _dimParams;
+
+    return ERR_OK;
+}
+
+/*stored vector is reused, so repeated calls don't allocate*/
+int ExpressionProblem::setParams(IVector const* params) {
+    if (!params) {
+        ILog::report("IProblem.setParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.setParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dim;
+    const double *p;
+    int ec;
+
+    if ((ec = params->getCoordsPtr(dim, p)) != ERR_OK)
+        return ec;
+
+    if (_params) {
+        if ((ec = _params->setAllCoords(dim, const_cast<double*>(p))) != ERR_OK)
+            return ec;
+    } else {
+        _params = params->clone();
+
+        if (!_params) {
+            ILog::report("IProblem.setParams: Not enough memory\n");
+            return ERR_MEMORY_ALLOCATION;
+        }
+    }
+
+    _boundParams = NULL;
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::setArgs(IVector const* args) {
+    if (!args) {
+        ILog::report("IProblem.setArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.setArgs: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dim;
+    const double *a;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dim, a)) != ERR_OK)
+        return ec;
+
+    if (_args) {
+        if ((ec = _args->setAllCoords(dim, const_cast<double*>(a))) != ERR_OK)
+            return ec;
+    } else {
+        _args = args->clone();
+
+        if (!_args) {
+            ILog::report("IProblem.setArgs: Not enough memory\n");
+            return ERR_MEMORY_ALLOCATION;
+        }
+    }
+
+    _boundArgs = NULL;
+
+    return ERR_OK;
+}
+
+/*programs read fixed vector on every call, so nothing is cached and default notifications are enough*/
+int ExpressionProblem::bindParams(double const* params, size_t dim) {
+    if (params && _dimParams != dim) {
+        ILog::report("IProblem.bindParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    _boundParams = params;
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::bindArgs(double const* args, size_t dim) {
+    if (args && _dimArgs != dim) {
+        ILog::report("IProblem.bindArgs: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    _boundArgs = args;
+
+    return ERR_OK;
+}
+
+/*registers of programs are local to every thread, graph is changed only under mutex*/
+bool ExpressionProblem::isReentrant() const {
+    return true;
+}
+
+/*programs and native kernels are shared by value, library stays loaded by the original problem*/
+IProblem* ExpressionProblem::createWorkerInstance() const {
+    QMutexLocker locker(&_mutex);
+    ExpressionProblem *worker = new (std::nothrow) ExpressionProblem(_expr);
+
+    if (!worker) {
+        ILog::report("IProblem.createWorkerInstance: Not enough memory\n");
+        return NULL;
+    }
+
+    for (int dr = BY_ARGS; dr < DIMENSION_DERIVED; dr++) {
+        worker->_value[dr] = _value[dr];
+        worker->_gradient[dr] = _gradient[dr];
+        worker->_diagonal[dr] = _diagonal[dr];
+        worker->_hessian[dr] = _hessian[dr];
+        worker->_hessianNodes[dr] = _hessianNodes[dr];
+        worker->_secondOrder[dr] = _secondOrder[dr];
+    }
+
+    locker.unlock();
+
+    if ((_args && worker->setArgs(_args) != ERR_OK) || (_params && worker->setParams(_params) != ERR_OK)) {
+        delete worker;
+        return NULL;
+    }
+
+    worker->_boundArgs = _boundArgs;
+    worker->_boundParams = _boundParams;
+    worker->_isWorker = true;
+
+    return worker;
+}
+
+/*problem of brocker is released by the brocker*/
+int ExpressionProblem::releaseWorkerInstance() {
+    if (!_isWorker) {
+        ILog::report("IProblem.releaseWorkerInstance: Problem isn't a worker instance\n");
+        return ERR_WRONG_ARG;
+    }
+
+    delete this;
+
+    return ERR_OK;
+}
+
+/*derivatives above the second order aren't compiled beforehand, they are built on a copy of graph*/
+int ExpressionProblem::higherDerivative(size_t order, size_t idx, DerivedType dr, double& value,
+                                        double const* point, double const* fixed) const {
+    QMutexLocker locker(&_mutex);
+    Expression expr(_expr);
+    locker.unlock();
+    int op = dr == BY_ARGS ? OP_ARG : OP_PARAM, node = expr.getRoot();
+
+    for (size_t i = 0; i < order; i++) {
+        QMap<int, int> memo;
+        node = expr.derivative(node, op, idx, memo);
+    }
+
+    Program program;
+    program.compile(expr, QVector<int>(1, node), dr);
+    program.run(1, point, dr == BY_ARGS ? _dimArgs : _dimParams, fixed, &value);
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::derivativeGoalFunction(size_t order,
+                                              size_t idx,
+                                              DerivedType dr,
+                                              double& value,
+                                              IVector const* args,
+                                              IVector const* params) const {
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA, dimP;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
+}
+
+int ExpressionProblem::derivative(size_t order, size_t idx, DerivedType dr, double& value, double const* a, double const* p) const {
+    if (order == 0) {
+        _value[BY_ARGS].run(1, a, _dimArgs, p, &value);
+        return ERR_OK;
+    }
+
+    if (dr != BY_ARGS && dr != BY_PARAMS) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument dr is unknown\n");
+        return ERR_WRONG_ARG;
+    }
+
+    size_t dim = dr == BY_ARGS ? _dimArgs : _dimParams;
+
+    if (idx >= dim) {
+        ILog::report("IProblem.derivativeGoalFunction: idx out of range\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    const double *point = dr == BY_ARGS ? a : p, *fixed = dr == BY_ARGS ? p : a;
+
+    if (order > 2)
+        return higherDerivative(order, idx, dr, value, point, fixed);
+
+    QVector<double> res(order == 1 ? dim + 1 : dim);
+
+    if (order == 1) {
+        _gradient[dr].run(1, point, dim, fixed, res.data());
+        value = res[idx + 1];
+    } else {
+        compileSecondOrder(dr);
+        _diagonal[dr].run(1, point, dim, fixed, res.data());
+        value = res[idx];
+    }
+
+    return ERR_OK;
+}
+
+int ExpressionProblem::derivativeGoalFunctionByArgs(size_t order,
+                                                    size_t idx,
+                                                    DerivedType dr,
+                                                    double& value,
+                                                    IVector const* args) const {
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = getFixed(BY_ARGS, p, "IProblem.derivativeGoalFunctionByArgs: Params are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
+}
+
+int ExpressionProblem::derivativeGoalFunctionByParams(size_t order,
+                                                      size_t idx,
+                                                      DerivedType dr,
+                                                      double& value,
+                                                      IVector const* params) const {
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimP;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = getFixed(BY_PARAMS, a, "IProblem.derivativeGoalFunctionByParams: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
+}
+
+ExpressionProblem::ExpressionProblem(Expression const& expr):
+    _expr(expr), _dimArgs(expr.getArgsDim()), _dimParams(expr.getParamsDim()), _args(NULL), _params(NULL),
+    _boundArgs(NULL), _boundParams(NULL), _library(NULL), _isWorker(false)
+{
+    _secondOrder[BY_ARGS] = _secondOrder[BY_PARAMS] = false;
+}
+
+/*library stays loaded, kernels may be referenced by other problems of the same formula*/
+ExpressionProblem::~ExpressionProblem() {
+    delete _args;
+    delete _params;
+    delete _library;
+}
+
+int ExpressionBrocker::getId() const {
+    return IBrocker::INTERFACE_1;
+}
+
+bool ExpressionBrocker::canCastTo(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void* ExpressionBrocker::getInterfaceImpl(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+        return _problem;
+    default:
+        return NULL;
+    }
+}
+
+int ExpressionBrocker::release() {
+    delete this;
+
+    return ERR_OK;
+}
+
+IBrocker* ExpressionBrocker::createWorkerBrocker() const {
+    ExpressionProblem *problem = static_cast<ExpressionProblem*>(_problem->createWorkerInstance());
+
+    if (!problem)
+        return NULL;
+
+    ExpressionBrocker *brocker = new (std::nothrow) ExpressionBrocker(problem);
+
+    if (!brocker) {
+        ILog::report("IBrocker.createWorkerBrocker: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    return brocker;
+}
+
+ExpressionBrocker::ExpressionBrocker(ExpressionProblem *problem):
+    _problem(problem)
+{}
+
+ExpressionBrocker::~ExpressionBrocker() {
+    delete _problem;
+}
+
+namespace {
+
+void* createBrocker(char const* formula, bool native) {
+    ExpressionProblem *problem = ExpressionProblem::createProblem(formula, native);
+
+    if (!problem)
+        return NULL;
+
+    ExpressionBrocker *brocker = new (std::nothrow) ExpressionBrocker(problem);
+
+    if (!brocker) {
+        ILog::report("getExpressionBrocker: not enough memory\n");
+        delete problem;
+        return NULL;
+    }
+
+    return brocker;
+}
+
+}
+
+extern "C" {
+/*goal function is given by formula over args x0, x1, ... and params p0, p1, ...,
+  e.g. "(x0 - p0)^2 + 100 * (x1 - x0^2)^2"; dimensions are the highest indices used plus one*/
+SHARED_EXPORT void* getExpressionBrocker(char const* formula) {
+    return createBrocker(formula, false);
+}
+
+/*the same with native code built by compiler from EXPRESSION_PROBLEM_CXX (c++ by default)
+  and cached in EXPRESSION_PROBLEM_CACHE (cache directory of the user by default)*/
+SHARED_EXPORT void* getNativeExpressionBrocker(char const* formula) {
+    return createBrocker(formula, true);
+}
+
+/*formula is taken from environment variable EXPRESSION_PROBLEM,
+  native code is used if EXPRESSION_PROBLEM_NATIVE is set to 1*/
+SHARED_EXPORT void* getBrocker() {
+    QByteArray formula = qgetenv("EXPRESSION_PROBLEM");
+
+    if (formula.isEmpty()) {
+        ILog::report("getBrocker: EXPRESSION_PROBLEM is not set\n");
+        return NULL;
+    }
+
+    return createBrocker(formula.constData(), qgetenv("EXPRESSION_PROBLEM_NATIVE") == "1");
+}
+}
@@ -0,0 +1,635 @@
+#include <new>
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+#include <QVector>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "ILog.h"
+#include "IBrocker.h"
+#include "IProblem.h"
+#include "IVector.h"
+#include "Interface0Problem.h"
+
+namespace {
+
+/*perturbed points of gradient evaluated by one batch, so memory doesn't grow as dim^2*/
+size_t const BLOCK_POINTS = 256;
+
+/*range of points of one batch evaluated by one thread*/
+struct Chunk {
+    IProblem const* problem;
+    IProblem::DerivedType dr;
+    size_t count;
+    double const* points;
+    double* values;
+    int errCode;
+};
+
+void evaluateChunk(Chunk& chunk) {
+    chunk.errCode = chunk.dr == IProblem::BY_ARGS
+            ? chunk.problem->goalFunctionByArgsBatch(chunk.count, chunk.points, chunk.values)
+            : chunk.problem->goalFunctionByParamsBatch(chunk.count, chunk.points, chunk.values);
+}
+
+class FiniteDifferenceProblem : public IProblem {
+
+public:
+
+    int getId() const;
+
+    int goalFunction(IVector const* args, IVector const* params, double& res) const;
+    int goalFunctionByArgs(IVector const*  args, double& res) const;
+    int goalFunctionByParams(IVector const*  params, double& res) const;
+    int goalFunctionByArgsBatch(size_t count, double const* args, double* res) const;
+    int goalFunctionByParamsBatch(size_t count, double const* params, double* res) const;
+    int valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const;
+    int valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const;
+    int gradientByArgs(IVector const* args, IVector* grad) const;
+    int gradientByParams(IVector const* params, IVector* grad) const;
+    int getArgsDim(size_t& dim) const;
+    int getParamsDim(size_t& dim) const;
+
+    int setParams(IVector const* params);
+    int setArgs(IVector const* args);
+    int bindParams(double const* params, size_t dim);
+    int bindArgs(double const* args, size_t dim);
+    int paramsChanged();
+    int argsChanged();
+
+    bool isReentrant() const;
+    IProblem* createWorkerInstance() const;
+    int releaseWorkerInstance();
+
+    int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
+    int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const;
+    int derivativeGoalFunctionByParams(size_t order, size_t idx, DerivedType dr, double& value, IVector const* params) const;
+
+    /*workers for threads when problem isn't reentrant*/
+    void createWorkers();
+
+    /*ctor*/
+    FiniteDifferenceProblem(IProblem *problem, DifferenceScheme scheme, double step, unsigned int threads, bool ownsProblem);
+
+    /*dtor*/
+    ~FiniteDifferenceProblem();
+
+private:
+
+    double getStep(double coord, size_t order) const;
+    int evaluate(DerivedType dr, size_t count, double const* points, double* values) const;
+    int differences(DerivedType dr, IVector const* point, bool withValue, double& value, IVector* grad) const;
+    int evaluateAt(DerivedType dr, IVector const* args, IVector const* params, IVector const* shifted, double& res) const;
+    int derivative(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
+
+    IProblem *_problem;
+    DifferenceScheme _scheme;
+    double _step;
+    unsigned int _threads;
+    /*adapter made by createWorkerInstance releases worker of wrapped problem*/
+    bool _ownsProblem;
+    /*made by createWorkerInstance, so it may be released by releaseWorkerInstance*/
+    bool _isWorker;
+    QVector<IProblem*> _workers;
+
+};
+
+class FiniteDifferenceBrocker : public IBrocker {
+
+public:
+
+    int getId() const;
+
+    bool canCastTo(Type type) const;
+    void* getInterfaceImpl(Type type) const;
+
+    int release();
+
+    IBrocker* createWorkerBrocker() const;
+
+    /*ctor*/
+    FiniteDifferenceBrocker(FiniteDifferenceProblem *problem);
+
+    /*dtor*/
+    ~FiniteDifferenceBrocker();
+
+private:
+
+    FiniteDifferenceProblem *_problem;
+
+};
+
+}
+
+IBrocker* IProblem::createFiniteDifferenceAdapter(IProblem* problem, DifferenceScheme scheme, double step, unsigned int threads) {
+    if (!problem) {
+        ILog::report("IProblem.createFiniteDifferenceAdapter: Input argument problem is nullptr\n");
+        return NULL;
+    }
+
+    if (scheme >= DIMENSION_DIFFERENCE || step < 0) {
+        ILog::report("IProblem.createFiniteDifferenceAdapter: Wrong scheme or step\n");
+        return NULL;
+    }
+
+    /*relative steps balancing truncation and rounding errors of every scheme*/
+    if (step == 0)
+        step = scheme == FORWARD_DIFFERENCE ? std::sqrt(DBL_EPSILON) : std::pow(DBL_EPSILON, 1.0 / 3);
+
+    if (threads == 0)
+        threads = QThread::idealThreadCount() > 0 ? QThread::idealThreadCount() : 1;
+
+    /*problem of INTERFACE_0 has no batch methods and workers, adapter is released with the brocker*/
+    bool legacy = problem->getId() < IProblem::INTERFACE_1;
+
+    if (legacy && !(problem = new (std::nothrow) Interface0Problem(problem))) {
+        ILog::report("IProblem.createFiniteDifferenceAdapter: not enough memory\n");
+        return NULL;
+    }
+
+    FiniteDifferenceProblem *adapter = new (std::nothrow) FiniteDifferenceProblem(problem, scheme, step, threads, legacy);
+
+    if (!adapter) {
+        ILog::report("IProblem.createFiniteDifferenceAdapter: not enough memory\n");
+        if (legacy)
+            problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    adapter->createWorkers();
+
+    FiniteDifferenceBrocker *brocker = new (std::nothrow) FiniteDifferenceBrocker(adapter);
+
+    if (!brocker) {
+        ILog::report("IProblem.createFiniteDifferenceAdapter: not enough memory\n");
+        delete adapter;
+        return NULL;
+    }
+
+    return brocker;
+}
+
+int FiniteDifferenceProblem::getId() const {
+    return IProblem::INTERFACE_1;
+}
+
+int FiniteDifferenceProblem::goalFunction(IVector const* args, IVector const* params, double& res) const {
+    return _problem->goalFunction(args, params, res);
+}
+
+int FiniteDifferenceProblem::goalFunctionByArgs(IVector const*  args, double& res) const {
+    return _problem->goalFunctionByArgs(args, res);
+}
+
+int FiniteDifferenceProblem::goalFunctionByParams(IVector const*  params, double& res) const {
+    return _problem->goalFunctionByParams(params, res);
+}
+
+int FiniteDifferenceProblem::goalFunctionByArgsBatch(size_t count, double const* args, double* res) const {
+    return evaluate(BY_ARGS, count, args, res);
+}
+
+int FiniteDifferenceProblem::goalFunctionByParamsBatch(size_t count, double const* params, double* res) const {
+    return evaluate(BY_PARAMS, count, params, res);
+}
+
+int FiniteDifferenceProblem::getArgsDim(size_t& dim) const {
+    return _problem->getArgsDim(dim);
+}
+
+int FiniteDifferenceProblem::getParamsDim(size_t& dim) const {
+    return _problem->getParamsDim(dim);
+}
+
+/*fixed vectors are set to workers too*/
+int FiniteDifferenceProblem::setParams(IVector const* params) {
+    int errCode = _problem->setParams(params);
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->setParams(params);
+
+    return errCode;
+}
+
+int FiniteDifferenceProblem::setArgs(IVector const* args) {
+    int errCode = _problem->setArgs(args);
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->setArgs(args);
+
+    return errCode;
+}
+
+int FiniteDifferenceProblem::bindParams(double const* params, size_t dim) {
+    int errCode = _problem->bindParams(params, dim);
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->bindParams(params, dim);
+
+    return errCode;
+}
+
+int FiniteDifferenceProblem::bindArgs(double const* args, size_t dim) {
+    int errCode = _problem->bindArgs(args, dim);
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->bindArgs(args, dim);
+
+    return errCode;
+}
+
+int FiniteDifferenceProblem::paramsChanged() {
+    int errCode = _problem->paramsChanged();
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->paramsChanged();
+
+    return errCode;
+}
+
+int FiniteDifferenceProblem::argsChanged() {
+    int errCode = _problem->argsChanged();
+
+    for (int i = 0; i < _workers.size() && errCode == ERR_OK; i++)
+        errCode = _workers[i]->argsChanged();
+
+    return errCode;
+}
+
+/*step is relative to coordinate and exactly representable, so (x + h) - x == h;
+  second difference loses twice as many digits, so its step isn't less than eps^(1/4)*/
+double FiniteDifferenceProblem::getStep(double coord, size_t order) const {
+    double step = order == 2 ? std::max(_step, std::pow(DBL_EPSILON, 0.25)) : _step;
+    double h = step * std::max(1.0, std::fabs(coord));
+    volatile double shifted = coord + h;
+    return shifted - coord;
+}
+
+/*batch is split into chunks evaluated by threads, every thread has its own worker if problem isn't reentrant*/
+int FiniteDifferenceProblem::evaluate(DerivedType dr, size_t count, double const* points, double* values) const {
+    size_t dim;
+    int errCode = dr == BY_ARGS ? _problem->getArgsDim(dim) : _problem->getParamsDim(dim);
+
+    if (errCode != ERR_OK)
+        return errCode;
+
+    size_t chunks = std::min<size_t>(_threads, count);
+
+    if (chunks <= 1) {
+        Chunk chunk = {_problem, dr, count, points, values, ERR_OK};
+        evaluateChunk(chunk);
+        return chunk.errCode;
+    }
+
+    QVector<Chunk> work(chunks);
+    size_t first = 0;
+
+    for (size_t i = 0; i < chunks; i++) {
+        size_t size = count / chunks + (i < count % chunks ? 1 : 0);
+        IProblem const* problem = i > 0 && !_workers.isEmpty() ? _workers[i - 1] : _problem;
+        Chunk chunk = {problem, dr, size, points + first * dim, values + first, ERR_OK};
+        work[i] = chunk;
+        first += size;
+    }
+
+    QtConcurrent::blockingMap(work, evaluateChunk);
+
+    for (size_t i = 0; i < chunks; i++) {
+        if (work[i].errCode != ERR_OK)
+            return work[i].errCode;
+    }
+
+    return ERR_OK;
+}
+
+/*perturbed points are evaluated by batches of bounded size, the point itself (if needed) goes with the first one*/
+int FiniteDifferenceProblem::differences(DerivedType dr, IVector const* point, bool withValue, double& value, IVector* grad) const {
+    if (!point || !grad) {
+        ILog::report("IProblem.gradient: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    size_t dim;
+    int errCode = dr == BY_ARGS ? _problem->getArgsDim(dim) : _problem->getParamsDim(dim);
+
+    if (errCode != ERR_OK)
+        return errCode;
+
+    if (dim != point->getDim() || dim != grad->getDim()) {
+        ILog::report("IProblem.gradient: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimP;
+    double const* x;
+
+    if ((errCode = point->getCoordsPtr(dimP, x)) != ERR_OK)
+        return errCode;
+
+    bool central = _scheme == CENTRAL_DIFFERENCE, withBase = !central || withValue;
+    size_t perCoord = central ? 2 : 1;
+    size_t block = std::max<size_t>(1, std::min(dim, std::max<size_t>(BLOCK_POINTS, _threads) / perCoord));
+    QVector<double> points((block * perCoord + 1) * dim), values(block * perCoord + 1), steps(block);
+    double base = 0;
+    size_t first = 0;
+
+    do {
+        size_t size = std::min(block, dim - first), count = size * perCoord + (withBase && first == 0 ? 1 : 0);
+
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < dim; j++)
+                points[i * dim + j] = x[j];
+        }
+
+        for (size_t k = 0; k < size; k++) {
+            steps[k] = getStep(x[first + k], 1);
+            points[k * dim + first + k] += steps[k];
+            if (central)
+                points[(size + k) * dim + first + k] -= steps[k];
+        }
+
+        if ((errCode = evaluate(dr, count, points.constData(), values.data())) != ERR_OK)
+            return errCode;
+
+        if (withBase && first == 0)
+            base = values[size * perCoord];
+
+        for (size_t k = 0; k < size; k++) {
+            double d = central ? (values[k] - values[size + k]) / (2 * steps[k]) : (values[k] - base) / steps[k];
+            if ((errCode = grad->setCoord(first + k, d)) != ERR_OK)
+                return errCode;
+        }
+
+        first += size;
+    } while (first < dim);
+
+    if (withValue)
+        value = base;
+
+    return ERR_OK;
+}
+
+int FiniteDifferenceProblem::gradientByArgs(IVector const* args, IVector* grad) const {
+    double value;
+    return differences(BY_ARGS, args, false, value, grad);
+}
+
+int FiniteDifferenceProblem::gradientByParams(IVector const* params, IVector* grad) const {
+    double value;
+    return differences(BY_PARAMS, params, false, value, grad);
+}
+
+int FiniteDifferenceProblem::valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const {
+    return differences(BY_ARGS, args, true, value, grad);
+}
+
+int FiniteDifferenceProblem::valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const {
+    return differences(BY_PARAMS, params, true, value, grad);
+}
+
+/*nullptr args or params means the one fixed in wrapped problem*/
+int FiniteDifferenceProblem::evaluateAt(DerivedType dr, IVector const* args, IVector const* params, IVector const* shifted, double& res) const {
+    if (!args || !params)
+        return dr == BY_ARGS ? _problem->goalFunctionByArgs(shifted, res) : _problem->goalFunctionByParams(shifted, res);
+
+    return _problem->goalFunction(dr == BY_ARGS ? shifted : args, dr == BY_ARGS ? params : shifted, res);
+}
+
+/*one coordinate of args or params is perturbed, second derivative is the diagonal one*/
+int FiniteDifferenceProblem::derivative(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const {
+    if (order > 2) {
+        ILog::report("IProblem.derivativeGoalFunction: order isn't supported by finite differences\n");
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    if (dr != BY_ARGS && dr != BY_PARAMS) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument dr is unknown\n");
+        return ERR_WRONG_ARG;
+    }
+
+    IVector const* point = dr == BY_ARGS ? args : params;
+
+    if (idx >= point->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunction: idx out of range\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    IVector *shifted = point->clone();
+
+    if (!shifted) {
+        ILog::report("IProblem.derivativeGoalFunction: not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+
+    double x, h, fp, fm, f = 0;
+    int ec = point->getCoord(idx, x);
+    bool central = order == 2 || _scheme == CENTRAL_DIFFERENCE;
+
+    h = getStep(x, order);
+
+    if (ec == ERR_OK && (ec = shifted->setCoord(idx, x + h)) == ERR_OK)
+        ec = evaluateAt(dr, args, params, shifted, fp);
+
+    if (ec == ERR_OK && (ec = shifted->setCoord(idx, central ? x - h : x)) == ERR_OK)
+        ec = evaluateAt(dr, args, params, shifted, fm);
+
+    if (ec == ERR_OK && order == 2)
+        ec = evaluateAt(dr, args, params, point, f);
+
+    delete shifted;
+
+    if (ec != ERR_OK)
+        return ec;
+
+    if (order == 2)
+        value = (fp - 2 * f + fm) / (h * h);
+    else
+        value = central ? (fp - fm) / (2 * h) : (fp - fm) / h;
+
+    return ERR_OK;
+}
+
+int FiniteDifferenceProblem::derivativeGoalFunction(size_t order,
+                                                    size_t idx,
+                                                    DerivedType dr,
+                                                    double& value,
+                                                    IVector const* args,
+                                                    IVector const* params) const {
+    if (!args || !params) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (order == 0)
+        return _problem->goalFunction(args, params, value);
+
+    return derivative(order, idx, dr, value, args, params);
+}
+
+/*fixed vector is kept by wrapped problem, so only the other one is perturbed, at coordinate idx only*/
+int FiniteDifferenceProblem::derivativeGoalFunctionByArgs(size_t order,
+                                                          size_t idx,
+                                                          DerivedType dr,
+                                                          double& value,
+                                                          IVector const* args) const {
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (order > 0 && dr != BY_ARGS) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: only derivatives by args are supported\n");
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    if (order == 0)
+        return _problem->goalFunctionByArgs(args, value);
+
+    return derivative(order, idx, BY_ARGS, value, args, NULL);
+}
+
+int FiniteDifferenceProblem::derivativeGoalFunctionByParams(size_t order,
+                                                            size_t idx,
+                                                            DerivedType dr,
+                                                            double& value,
+                                                            IVector const* params) const {
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (order > 0 && dr != BY_PARAMS) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: only derivatives by params are supported\n");
+        return ERR_NOT_IMPLEMENTED;
+    }
+
+    if (order == 0)
+        return _problem->goalFunctionByParams(params, value);
+
+    return derivative(order, idx, BY_PARAMS, value, NULL, params);
+}
+
+/*workers are shared by calls, so adapter is reentrant only when wrapped problem is*/
+bool FiniteDifferenceProblem::isReentrant() const {
+    return _problem->isReentrant();
+}
+
+IProblem* FiniteDifferenceProblem::createWorkerInstance() const {
+    IProblem *problem = _problem->createWorkerInstance();
+
+    if (!problem)
+        return NULL;
+
+    FiniteDifferenceProblem *worker = new (std::nothrow) FiniteDifferenceProblem(problem, _scheme, _step, _threads, true);
+
+    if (!worker) {
+        ILog::report("IProblem.createWorkerInstance: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    worker->_isWorker = true;
+    worker->createWorkers();
+
+    return worker;
+}
+
+/*adapter of brocker is released by the brocker*/
+int FiniteDifferenceProblem::releaseWorkerInstance() {
+    if (!_isWorker) {
+        ILog::report("IProblem.releaseWorkerInstance: Problem isn't a worker instance\n");
+        return ERR_WRONG_ARG;
+    }
+
+    delete this;
+
+    return ERR_OK;
+}
+
+/*problem which can't be copied is evaluated by one thread*/
+void FiniteDifferenceProblem::createWorkers() {
+    if (_threads <= 1 || _problem->isReentrant())
+        return;
+
+    for (unsigned int i = 1; i < _threads; i++) {
+        IProblem *worker = _problem->createWorkerInstance();
+
+        if (!worker) {
+            ILog::report("IProblem.createFiniteDifferenceAdapter: problem isn't reentrant and has no workers, one thread is used\n");
+            for (int j = 0; j < _workers.size(); j++)
+                _workers[j]->releaseWorkerInstance();
+            _workers.clear();
+            _threads = 1;
+            return;
+        }
+
+        _workers.append(worker);
+    }
+}
+
+FiniteDifferenceProblem::FiniteDifferenceProblem(IProblem *problem, DifferenceScheme scheme, double step, unsigned int threads, bool ownsProblem):
+    _problem(problem), _scheme(scheme), _step(step), _threads(threads), _ownsProblem(ownsProblem), _isWorker(false)
+{}
+
+FiniteDifferenceProblem::~FiniteDifferenceProblem() {
+    for (int i = 0; i < _workers.size(); i++)
+        _workers[i]->releaseWorkerInstance();
+
+    if (_ownsProblem)
+        _problem->releaseWorkerInstance();
+}
+
+int FiniteDifferenceBrocker::getId() const {
+    return IBrocker::INTERFACE_1;
+}
+
+bool FiniteDifferenceBrocker::canCastTo(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void* FiniteDifferenceBrocker::getInterfaceImpl(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+        return _problem;
+    default:
+        return NULL;
+    }
+}
+
+int FiniteDifferenceBrocker::release() {
+    delete this;
+
+    return ERR_OK;
+}
+
+IBrocker* FiniteDifferenceBrocker::createWorkerBrocker() const {
+    FiniteDifferenceProblem *problem = static_cast<FiniteDifferenceProblem*>(_problem->createWorkerInstance());
+
+    if (!problem)
+        return NULL;
+
+    FiniteDifferenceBrocker *brocker = new (std::nothrow) FiniteDifferenceBrocker(problem);
+
+    if (!brocker) {
+        ILog::report("IBrocker.createWorkerBrocker: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    return brocker;
+}
+
+FiniteDifferenceBrocker::FiniteDifferenceBrocker(FiniteDifferenceProblem *problem):
+    _problem(problem)
+{}
+
+/*wrapped problem belongs to its own brocker*/
+FiniteDifferenceBrocker::~FiniteDifferenceBrocker() {
+    delete _problem;
+}
@@ -1,13 +1,18 @@
 #include <QVector>
+#include <climits>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 #include "ISet.h"
 #include "error.h"
 #include "ILog.h"
+#include "PointIndex.h"
+#include "SetIterators.h"
 
 const double EPS = 1e-8;
 
 namespace {
-    class ISetImpl : public ISet
+    class ISetImpl : public ISet, public PointSource
     {
     public:
         int getId() const;
@@ -19,25 +24,29 @@ namespace {
         unsigned int getSize() const;
         int clear();
 
+        int setInsertMode(InsertMode mode);
+
+        int putMany(unsigned int count, double const* coords);
+        int exportTo(unsigned int bufferSize, double* buffer) const;
+        int removeIf(Predicate predicate, void* context);
+        int remove(unsigned int count, unsigned int const* indices);
+
+        int getNearest(IVector const* const pItem, unsigned int k, unsigned int*& indices, unsigned int& count) const;
+        int getInRadius(IVector const* const pItem, double radius, unsigned int*& indices, unsigned int& count) const;
+
+        int getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const;
+        int getData(unsigned int& count, unsigned int& dim, double const*& data) const;
+
+        unsigned int getPointsAmount() const;
+        double const* getPointCoords(unsigned int index) const;
+
         IIterator* end();
         IIterator* begin();
 
         int deleteIterator(IIterator * pIter);
         int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+        int getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const;
 
-        class IIteratorImpl : public ISet::IIterator
-        {
-        public:
-            int next();
-            int prev();
-            bool isEnd() const;
-            bool isBegin() const;
-
-            ISet const* const _set;
-            unsigned int _pos;
-
-            IIteratorImpl(ISet const* const set, int pos);
-        };
 
         /*ctor*/
         ISetImpl(uint dim);
@@ -46,16 +55,22 @@ namespace {
 
 
     private:
-        int findIterator(IIterator const * pIter) const;
-        QVector<IVector*> _ptr_points;
-        QVector<IIteratorImpl*> _ptr_iterators;
+        void removeMarked(QVector<bool> const& marked);
+        static int copyIndices(QVector<unsigned int> const& found, unsigned int*& indices, unsigned int& count);
+        /*coordinates of all points one after another, point 'i' starts at i * _dim*/
+        QVector<double> _coords;
+        /*indices are rebuilt lazily by const queries*/
+        mutable PointGrid _grid;
+        mutable KdTree _tree;
+        IndexIterators _iterators;
         unsigned int _dim;
+        InsertMode _insertMode;
     };
 
 } //end anonymous namespace
 
 int ISetImpl::getId() const {
-    return ISet::INTERFACE_0;
+    return ISet::INTERFACE_1;
 }
 
 ISet* ISet::createSet(unsigned int R_dim) {
@@ -72,17 +87,12 @@ ISet* ISet::createSet(unsigned int R_dim) {
     return set;
 }
 
-ISetImpl::ISetImpl(uint dim) {
+ISetImpl::ISetImpl(uint dim): _grid(dim, EPS), _tree(dim) {
     _dim = dim;
+    _insertMode = INSERT_ALL;
 }
 
 ISetImpl::~ISetImpl() {
-    for (int i = 0; i < _ptr_points.size(); i++) {
-        delete _ptr_points[i];
-    }
-    for (int i = 0; i < _ptr_iterators.size(); i++) {
-        delete _ptr_iterators[i];
-    }
 }
 
 int ISetImpl::put(IVector const* const item) {
@@ -95,23 +105,24 @@ int ISetImpl::put(IVector const* const item) {
         return ERR_DIMENSIONS_MISMATCH;
     }
 
-    IVector* temp = item->clone();
-    if (!temp) {
-        ILog::report("ISet.put: Not enough memory\n");
-        return ERR_MEMORY_ALLOCATION;
+    unsigned int dim;
+    double const* coords;
+    int errCode = item->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK) {
+        ILog::report("ISet.put: Can't get coordinates of input argument\n");
+        return errCode;
     }
 
-    _ptr_points.append(temp);
-    return ERR_OK;
+    return putMany(1, coords);
 }
 
 int ISetImpl::get(unsigned int index, IVector*& pItem) const {
-    if  (index >= (uint)_ptr_points.size()) {
+    if  (index >= getSize()) {
         ILog::report("ISet.get: Wrong index (out of range)\n");
         return ERR_OUT_OF_RANGE;
     }
 
-    pItem = _ptr_points[index]->clone();
+    pItem = IVector::createVector(_dim, getPointCoords(index));
     if (!pItem) {
         ILog::report("ISet.get: Not enough memory\n");
         return ERR_MEMORY_ALLOCATION;
@@ -120,167 +131,273 @@ int ISetImpl::get(unsigned int index, IVector*& pItem) const {
     return ERR_OK;
 }
 
-int ISetImpl::remove(unsigned int index) {
-    if  (index >= (uint)_ptr_points.size()) {
-        ILog::report("ISet.remove: Wrong index (out of range)\n");
+int ISetImpl::getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const {
+    if  (index >= getSize()) {
+        ILog::report("ISet.getCoordsPtr: Wrong index (out of range)\n");
         return ERR_OUT_OF_RANGE;
     }
 
-    for (int i = 0; i < _ptr_iterators.size(); i++) {
-        if (_ptr_iterators[i]->_pos > index) {
-            _ptr_iterators[i]->_pos--;
-        }
-        else if (_ptr_iterators[i]->_pos == index) {
-            deleteIterator(_ptr_iterators[i]);
-        }
+    dim = _dim;
+    coords = getPointCoords(index);
+    return ERR_OK;
+}
+
+int ISetImpl::getData(unsigned int& count, unsigned int& dim, double const*& data) const {
+    count = getSize();
+    dim = _dim;
+    data = _coords.constData();
+    return ERR_OK;
+}
+
+int ISetImpl::remove(unsigned int index) {
+    if  (index >= getSize()) {
+        ILog::report("ISet.remove: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
     }
 
-    _ptr_points.remove(index);
+    QVector<bool> marked(getSize(), false);
+    marked[index] = true;
+    removeMarked(marked);
 
     return ERR_OK;
 }
 
-int ISetImpl::contains(IVector const* const pItem, bool& rc) const {
-    if (!pItem) {
-        ILog::report("ISet.contains: Input argument is nullptr\n");
+int ISetImpl::putMany(unsigned int count, double const* coords) {
+    if (!coords && count > 0) {
+        ILog::report("ISet.putMany: Input argument is nullptr\n");
         return ERR_WRONG_ARG;
     }
-    if  (_dim != pItem->getDim()) {
-        ILog::report("ISet.contains: Input argument has another dimension\n");
-        return ERR_DIMENSIONS_MISMATCH;
+
+    /*coordinates of all points are kept in one QVector indexed by int*/
+    qint64 total = _coords.size() + static_cast<qint64>(count) * _dim;
+    if (total > INT_MAX) {
+        ILog::report("ISet.putMany: Too many points\n");
+        return ERR_OUT_OF_RANGE;
     }
 
-    int errCode;
-    rc = false;
-    for (int i = 0; i < _ptr_points.size(); i++) {
-        errCode = pItem->eq(_ptr_points[i], IVector::NORM_INF, rc, EPS);
-        if (errCode != ERR_OK)
-            return errCode;
-        if (rc)
-            break;
+    /*storage grows geometrically, so appending is amortized O(dim) per point*/
+    int size = _coords.size(), added = static_cast<int>(total) - size;
+    if (total > _coords.capacity())
+        _coords.reserve(static_cast<int>(std::min(std::max(2 * static_cast<qint64>(_coords.capacity()), total), static_cast<qint64>(INT_MAX))));
+    if (_insertMode == INSERT_UNIQUE) {
+        /*grid lookup probes only cells near point, so every check is O(1) expected*/
+        for (unsigned int i = 0; i < count; i++) {
+            bool found = false;
+            _grid.find(*this, coords + i * _dim, found);
+            if (found)
+                continue;
+            size = _coords.size();
+            _coords.resize(size + _dim);
+            memcpy(_coords.data() + size, coords + i * _dim, _dim * sizeof(double));
+            _grid.insert(*this, getSize() - 1);
+        }
+        return ERR_OK;
     }
+    _coords.resize(size + added);
+    memcpy(_coords.data() + size, coords, added * sizeof(double));
+    for (unsigned int i = size / _dim; i < getSize(); i++)
+        _grid.insert(*this, i);
     return ERR_OK;
 }
 
-unsigned int ISetImpl::getSize() const {
-    return _ptr_points.size();
+int ISetImpl::setInsertMode(InsertMode mode) {
+    if (mode >= DIMENSION_INSERT_MODE) {
+        ILog::report("ISet.setInsertMode: Wrong insert mode\n");
+        return ERR_WRONG_ARG;
+    }
+    _insertMode = mode;
+    return ERR_OK;
 }
 
-int ISetImpl::clear() {
-    for (int i = 0; i < _ptr_points.size(); i++) {
-        delete _ptr_points[i];
+int ISetImpl::exportTo(unsigned int bufferSize, double* buffer) const {
+    if (!buffer) {
+        ILog::report("ISet.exportTo: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
     }
-    _ptr_points.clear();
-
-    for (int i = 0; i < _ptr_iterators.size(); i++) {
-        delete _ptr_iterators[i];
+    if (bufferSize < (unsigned int)_coords.size()) {
+        ILog::report("ISet.exportTo: Buffer is too small\n");
+        return ERR_OUT_OF_RANGE;
     }
-    _ptr_iterators.clear();
 
+    memcpy(buffer, _coords.constData(), _coords.size() * sizeof(double));
     return ERR_OK;
 }
 
-ISetImpl::IIterator* ISetImpl::end() {
-    if (_ptr_points.size() == 0) {
-        ILog::report("ISet.end: Can not create iterator of empty set\n");
-        return NULL;
-    }
-    ISetImpl::IIteratorImpl* iterator
-            = new(std::nothrow) ISetImpl::IIteratorImpl::IIteratorImpl(this, _ptr_points.size() - 1);
-    if (!iterator) {
-        ILog::report("ISet.end: Not enough memory\n");
-        return NULL;
+int ISetImpl::removeIf(Predicate predicate, void* context) {
+    if (!predicate) {
+        ILog::report("ISet.removeIf: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
     }
-     _ptr_iterators.append(iterator);
-    return iterator;
+
+    QVector<bool> marked(getSize());
+    for (unsigned int i = 0; i < getSize(); i++)
+        marked[i] = predicate(getPointCoords(i), _dim, context);
+    removeMarked(marked);
+    return ERR_OK;
 }
 
-ISetImpl::IIterator* ISetImpl::begin() {
-    if (_ptr_points.size() == 0) {
-        ILog::report("ISet.begin: Can not create iterator of empty set\n");
-        return NULL;
-    }
-    ISetImpl::IIteratorImpl* iterator
-            = new(std::nothrow) ISetImpl::IIteratorImpl::IIteratorImpl(this, 0);
-    if (!iterator) {
-        ILog::report("ISet.begin: Not enough memory\n");
-        return NULL;
+int ISetImpl::remove(unsigned int count, unsigned int const* indices) {
+    if (!indices && count > 0) {
+        ILog::report("ISet.remove: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
     }
-    _ptr_iterators.append(iterator);
-    return iterator;
-}
 
-int ISetImpl::findIterator(ISet::IIterator const * pIter) const {
-    for (int i = 0; i < _ptr_iterators.size(); i++) {
-        if (dynamic_cast<ISet::IIterator*>(_ptr_iterators[i]) == pIter) {
-            return i;
+    QVector<bool> marked(getSize(), false);
+    for (unsigned int i = 0; i < count; i++) {
+        if (indices[i] >= getSize()) {
+            ILog::report("ISet.remove: Wrong index (out of range)\n");
+            return ERR_OUT_OF_RANGE;
         }
+        marked[indices[i]] = true;
     }
-    return -1;
+    removeMarked(marked);
+    return ERR_OK;
 }
 
-int ISetImpl::deleteIterator(IIterator * pIter) {
-    if (!pIter) {
-        ILog::report("ISet.deleteIterator: Input argument is nullptr\n");
-        return ERR_WRONG_ARG;
+/*compacts points in one pass, iterators of removed points are deleted, others are shifted*/
+void ISetImpl::removeMarked(QVector<bool> const& marked) {
+    unsigned int size = getSize(), kept = 0;
+    QVector<unsigned int> newIndex(size);
+    double* data = _coords.data();
+    for (unsigned int i = 0; i < size; i++) {
+        newIndex[i] = kept;
+        if (marked[i])
+            continue;
+        if (kept != i)
+            memmove(data + kept * _dim, data + i * _dim, _dim * sizeof(double));
+        kept++;
     }
+    if (kept == size)
+        return;
+    _coords.resize(kept * _dim);
+    _grid.invalidate();
+    _tree.invalidate();
 
-    int indIterator = findIterator(pIter);
+    _iterators.erase(marked, newIndex);
+}
 
-    if (indIterator == -1) {
-        ILog::report("ISet.deleteIterator: Set does not contain input iterator\n");
+int ISetImpl::contains(IVector const* const pItem, bool& rc) const {
+    if (!pItem) {
+        ILog::report("ISet.contains: Input argument is nullptr\n");
         return ERR_WRONG_ARG;
     }
-    else {
-        delete _ptr_iterators[indIterator];
-        _ptr_iterators.remove(indIterator);
-        return ERR_OK;
+    if  (_dim != pItem->getDim()) {
+        ILog::report("ISet.contains: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
     }
+
+    unsigned int dim;
+    double const* coords;
+    int errCode = pItem->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    return _grid.find(*this, coords, rc);
 }
 
-int ISetImpl::getByIterator(IIterator const* pIter, IVector*& pItem) const {
-    if (!pIter) {
-        ILog::report("ISet.getByIterator: Input argument is nullptr\n");
+int ISetImpl::getNearest(IVector const* const pItem, unsigned int k, unsigned int*& indices, unsigned int& count) const {
+    if (!pItem) {
+        ILog::report("ISet.getNearest: Input argument is nullptr\n");
         return ERR_WRONG_ARG;
     }
+    if  (_dim != pItem->getDim()) {
+        ILog::report("ISet.getNearest: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
 
-    int indIterator = findIterator(pIter);
+    unsigned int dim;
+    double const* coords;
+    QVector<unsigned int> found;
+    int errCode = pItem->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    errCode = _tree.getNearest(*this, coords, k, found);
+    if (errCode != ERR_OK)
+        return errCode;
+    return copyIndices(found, indices, count);
+}
 
-    if (indIterator == -1) {
-        ILog::report("ISet.getByIterator: Set does not contain input iterator\n");
+int ISetImpl::getInRadius(IVector const* const pItem, double radius, unsigned int*& indices, unsigned int& count) const {
+    if (!pItem) {
+        ILog::report("ISet.getInRadius: Input argument is nullptr\n");
         return ERR_WRONG_ARG;
     }
-    else {
-        return get(_ptr_iterators[indIterator]->_pos, pItem);
+    if  (_dim != pItem->getDim()) {
+        ILog::report("ISet.getInRadius: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+    if (radius < 0) {
+        ILog::report("ISet.getInRadius: Radius is negative\n");
+        return ERR_WRONG_ARG;
     }
+
+    unsigned int dim;
+    double const* coords;
+    QVector<unsigned int> found;
+    int errCode = pItem->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    errCode = _tree.getInRadius(*this, coords, radius, found);
+    if (errCode != ERR_OK)
+        return errCode;
+    return copyIndices(found, indices, count);
 }
 
-int ISetImpl::IIteratorImpl::next() {
-    if (_pos + 1 >= _set->getSize()) {
-        ILog::report("ISet.next: Iterator already at the end of the set\n");
-        return ERR_OUT_OF_RANGE;
+int ISetImpl::copyIndices(QVector<unsigned int> const& found, unsigned int*& indices, unsigned int& count) {
+    unsigned int* res = new(std::nothrow) unsigned int[found.size() > 0 ? found.size() : 1];
+    if (!res) {
+        ILog::report("ISet.copyIndices: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
     }
-    _pos++;
+    for (int i = 0; i < found.size(); i++)
+        res[i] = found[i];
+    indices = res;
+    count = found.size();
     return ERR_OK;
 }
 
-int ISetImpl::IIteratorImpl::prev() {
-    if (_pos == 0) {
-        ILog::report("ISet.next: Iterator already at the begin of the set\n");
-        return ERR_OUT_OF_RANGE;
-    }
-    _pos--;
+unsigned int ISetImpl::getPointsAmount() const {
+    return getSize();
+}
+
+double const* ISetImpl::getPointCoords(unsigned int index) const {
+    return _coords.constData() + index * _dim;
+}
+
+unsigned int ISetImpl::getSize() const {
+    return _coords.size() / _dim;
+}
+
+int ISetImpl::clear() {
+    _coords.clear();
+    _grid.invalidate();
+    _tree.invalidate();
+
+    _iterators.clear();
+
     return ERR_OK;
 }
 
-bool ISetImpl::IIteratorImpl::isEnd() const {
-    return _pos == _set->getSize() - 1;
+ISetImpl::IIterator* ISetImpl::end() {
+    return _iterators.create(this, true);
 }
 
-bool ISetImpl::IIteratorImpl::isBegin() const {
-    return _pos == 0;
+ISetImpl::IIterator* ISetImpl::begin() {
+    return _iterators.create(this, false);
 }
 
-ISet::IIterator::IIterator(const ISet *const set, int pos) {}
+int ISetImpl::deleteIterator(IIterator * pIter) {
+    return _iterators.remove(pIter);
+}
 
-ISetImpl::IIteratorImpl::IIteratorImpl(ISet const* const set, int pos): ISet::IIterator(set, pos), _set(set), _pos(pos) {}
+int ISetImpl::getByIterator(IIterator const* pIter, IVector*& pItem) const {
+    return _iterators.getByIterator(this, pIter, pItem);
+}
+
+int ISetImpl::getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    return _iterators.getCoordsPtrByIterator(this, pIter, dim, coords);
+}
+
+ISet::IIterator::IIterator(const ISet *const set, int pos) {}
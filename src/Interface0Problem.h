@@ -0,0 +1,72 @@
+#ifndef INTERFACE0PROBLEM_H
+#define INTERFACE0PROBLEM_H
+
+#include "IProblem.h"
+
+/*problem of INTERFACE_0 (plugin built before INTERFACE_1) seen through INTERFACE_1: only methods
+  of INTERFACE_0 are forwarded to it, the newer ones are default adapters of IProblem over them;
+  adapter isn't reentrant and has no workers, it is released by releaseWorkerInstance*/
+class Interface0Problem : public IProblem
+{
+public:
+    Interface0Problem(IProblem *problem): _problem(problem) {}
+
+    int getId() const
+    {
+        return IProblem::INTERFACE_1;
+    }
+
+    int goalFunction(IVector const* args, IVector const* params, double& res) const
+    {
+        return _problem->goalFunction(args, params, res);
+    }
+    int goalFunctionByArgs(IVector const*  args, double& res) const
+    {
+        return _problem->goalFunctionByArgs(args, res);
+    }
+    int goalFunctionByParams(IVector const*  params, double& res) const
+    {
+        return _problem->goalFunctionByParams(params, res);
+    }
+    int getArgsDim(size_t& dim) const
+    {
+        return _problem->getArgsDim(dim);
+    }
+    int getParamsDim(size_t& dim) const
+    {
+        return _problem->getParamsDim(dim);
+    }
+
+    int setParams(IVector const* params)
+    {
+        return _problem->setParams(params);
+    }
+    int setArgs(IVector const* args)
+    {
+        return _problem->setArgs(args);
+    }
+
+    int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const
+    {
+        return _problem->derivativeGoalFunction(order, idx, dr, value, args, params);
+    }
+    int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const
+    {
+        return _problem->derivativeGoalFunctionByArgs(order, idx, dr, value, args);
+    }
+    int derivativeGoalFunctionByParams(size_t order, size_t idx, DerivedType dr, double& value, IVector const* params) const
+    {
+        return _problem->derivativeGoalFunctionByParams(order, idx, dr, value, params);
+    }
+
+    int releaseWorkerInstance()
+    {
+        delete this;
+        return ERR_OK;
+    }
+
+private:
+    IProblem *_problem;
+};
+
+#endif // INTERFACE0PROBLEM_H
@@ -0,0 +1,155 @@
+#include <new>
+#include <qvector.h>
+
+#include "ILog.h"
+#include "ILatticeCache.h"
+
+#define nullptr 0
+
+namespace {
+	unsigned const MIN_TABLE_SIZE = 16;
+	unsigned const MAX_TABLE_SIZE = 1u << 30;
+	unsigned const PROBE_LIMIT = 8;				// slots checked for a key before overwriting
+	unsigned const HASH_MULTIPLIER = 2654435769u;	// 2^32 / golden ratio
+	unsigned const EMPTY_KEY = 0;				// keys are stored as index + 1
+
+	class LatticeCache : public ILatticeCache
+	{
+	public:
+		unsigned _shift;				// 32 - log2 of table size
+		unsigned _mask;					// table size - 1
+		unsigned _victim;				// rotates the slot overwritten in full probe window
+		unsigned _hits;					// amount of successful 'find' calls
+		unsigned _misses;				// amount of failed 'find' calls
+		QVector<unsigned> _keys;		// lattice indices of values (shifted by one)
+		QVector<double> _values;		// cached values
+
+		LatticeCache(unsigned tableSize, unsigned shift);
+
+		// ILatticeCache interface methods:
+		int getId() const;
+
+		int find(unsigned int index, double& value, bool& found);
+		int put(unsigned int index, double value);
+		int clear();
+
+		unsigned int getHits() const;
+		unsigned int getMisses() const;
+
+		// other utility methods:
+		unsigned getHome(unsigned key) const;
+	};// end LatticeCache
+}// end anonymous namespace
+
+ILatticeCache* ILatticeCache::createCache(unsigned int capacity)
+{
+	unsigned tableSize = MIN_TABLE_SIZE, shift = 32 - 4;
+	LatticeCache *cache;
+	if (capacity == 0)
+	{
+		ILog::report("ILatticeCache::createCache: zero capacity\n");
+		return nullptr;
+	}
+	// table size is the power of two not less than capacity
+	while (tableSize < capacity && tableSize < MAX_TABLE_SIZE)
+	{
+		tableSize <<= 1;
+		shift--;
+	}
+	if (!(cache = new(std::nothrow) LatticeCache(tableSize, shift)))
+	{
+		ILog::report("ILatticeCache::createCache: failed with memory allocation\n");
+		return nullptr;
+	}
+	return cache;
+}// end factory method
+
+LatticeCache::LatticeCache(unsigned tableSize, unsigned shift)
+	: _keys(static_cast<int>(tableSize), EMPTY_KEY), _values(static_cast<int>(tableSize), 0.0)
+{
+	_shift = shift;
+	_mask = tableSize - 1;
+	_victim = 0;
+	_hits = 0;
+	_misses = 0;
+}
+
+int LatticeCache::getId() const
+{
+	return ILatticeCache::INTERFACE_0;
+}
+
+unsigned LatticeCache::getHome(unsigned key) const
+{
+	return (key * HASH_MULTIPLIER) >> _shift;
+}
+
+int LatticeCache::find(unsigned int index, double& value, bool& found)
+{
+	unsigned key = index + 1, slot = getHome(key);
+	if (key == EMPTY_KEY)
+	{
+		ILog::report("ILatticeCache::find: index out of range\n");
+		return ERR_OUT_OF_RANGE;
+	}
+	for (unsigned i = 0; i < PROBE_LIMIT; i++, slot = (slot + 1) & _mask)
+	{
+		if (_keys[slot] == key)
+		{
+			value = _values[slot];
+			found = true;
+			_hits++;
+			return ERR_OK;
+		}
+		if (_keys[slot] == EMPTY_KEY)
+		{
+			break;
+		}
+	}
+	found = false;
+	_misses++;
+	return ERR_OK;
+}// end find
+
+int LatticeCache::put(unsigned int index, double value)
+{
+	unsigned key = index + 1, home = getHome(key), slot = home;
+	if (key == EMPTY_KEY)
+	{
+		ILog::report("ILatticeCache::put: index out of range\n");
+		return ERR_OUT_OF_RANGE;
+	}
+	for (unsigned i = 0; i < PROBE_LIMIT; i++, slot = (slot + 1) & _mask)
+	{
+		if (_keys[slot] == key || _keys[slot] == EMPTY_KEY)
+		{
+			_keys[slot] = key;
+			_values[slot] = value;
+			return ERR_OK;
+		}
+	}
+	// probe window is full: overwrite one of its slots
+	slot = (home + _victim) & _mask;
+	_victim = (_victim + 1) % PROBE_LIMIT;
+	_keys[slot] = key;
+	_values[slot] = value;
+	return ERR_OK;
+}// end put
+
+int LatticeCache::clear()
+{
+	_keys.fill(EMPTY_KEY);
+	_hits = 0;
+	_misses = 0;
+	return ERR_OK;
+}
+
+unsigned int LatticeCache::getHits() const
+{
+	return _hits;
+}
+
+unsigned int LatticeCache::getMisses() const
+{
+	return _misses;
+}
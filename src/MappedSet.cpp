@@ -0,0 +1,369 @@
+#include <QVector>
+#include <QFile>
+#include <cstring>
+#include "ISet.h"
+#include "error.h"
+#include "ILog.h"
+#include "PointIndex.h"
+#include "SetIterators.h"
+
+namespace {
+    const double MAPPED_EPS = 1e-8;
+
+    const char SET_FILE_MAGIC[8] = {'O', 'P', 'T', 'S', 'E', 'T', '\0', '\0'};
+    const quint32 SET_FILE_VERSION = 1;
+
+    /*doubles follow the header, its size keeps them aligned*/
+    struct SetFileHeader
+    {
+        char magic[8];
+        quint32 version;
+        quint32 dim;
+        quint64 count;
+        quint64 reserved[2];    // zeros, layout changes bump version
+    };
+
+    int readHeader(QFile& file, SetFileHeader& header, char const* message) {
+        if (file.size() < static_cast<qint64>(sizeof(SetFileHeader))
+                || !file.seek(0)
+                || file.read(reinterpret_cast<char*>(&header), sizeof(SetFileHeader)) != sizeof(SetFileHeader)) {
+            ILog::report(message);
+            return ERR_WRONG_ARG;
+        }
+        if (memcmp(header.magic, SET_FILE_MAGIC, sizeof(SET_FILE_MAGIC)) != 0
+                || header.version != SET_FILE_VERSION || header.dim == 0) {
+            ILog::report(message);
+            return ERR_WRONG_ARG;
+        }
+        /*count is checked by division, its product with dim may overflow for damaged header*/
+        if (static_cast<quint64>(file.size() - sizeof(SetFileHeader)) / sizeof(double) / header.dim < header.count) {
+            ILog::report(message);
+            return ERR_WRONG_ARG;
+        }
+        return ERR_OK;
+    }
+
+    class MappedSet : public ISet, public PointSource
+    {
+    public:
+        int getId() const;
+
+        int put(IVector const* const item);
+        int get(unsigned int index, IVector*& pItem) const;
+        int remove(unsigned int index);
+        using ISet::remove;
+        int contains(IVector const* const pItem, bool& rc) const;
+        unsigned int getSize() const;
+        int clear();
+
+        int exportTo(unsigned int bufferSize, double* buffer) const;
+
+        int getNearest(IVector const* const pItem, unsigned int k, unsigned int*& indices, unsigned int& count) const;
+        int getInRadius(IVector const* const pItem, double radius, unsigned int*& indices, unsigned int& count) const;
+
+        int getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const;
+        int getData(unsigned int& count, unsigned int& dim, double const*& data) const;
+
+        unsigned int getPointsAmount() const;
+        double const* getPointCoords(unsigned int index) const;
+
+        IIterator* end();
+        IIterator* begin();
+
+        int deleteIterator(IIterator * pIter);
+        int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+        int getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const;
+
+
+        /*ctor*/
+        MappedSet(unsigned int dim, unsigned int count);
+        /*dtor*/
+        ~MappedSet();
+
+        bool mapFile(char const* fileName);
+
+    private:
+        int getCoords(IVector const* const pItem, double const*& coords, char const* nullMessage, char const* dimMessage) const;
+        static int copyIndices(QVector<unsigned int> const& found, unsigned int*& indices, unsigned int& count);
+        /*set owns mapping, it is released with the file*/
+        QFile _file;
+        uchar* _map;
+        /*points live in mapped file and are never copied*/
+        double const* _data;
+        unsigned int _count;
+        /*indices are built in memory by the first queries*/
+        mutable PointGrid _grid;
+        mutable KdTree _tree;
+        IndexIterators _iterators;
+        unsigned int _dim;
+    };
+
+} //end anonymous namespace
+
+int MappedSet::getId() const {
+    return ISet::INTERFACE_1;
+}
+
+ISet* ISet::openMappedSet(char const* fileName) {
+    if (!fileName) {
+        ILog::report("ISet.openMappedSet: Input argument is nullptr\n");
+        return NULL;
+    }
+
+    QFile file(fileName);
+    SetFileHeader header;
+    if (!file.open(QIODevice::ReadOnly)) {
+        ILog::report("ISet.openMappedSet: Can't open file\n");
+        return NULL;
+    }
+    if (readHeader(file, header, "ISet.openMappedSet: File is not a set file or is truncated\n") != ERR_OK)
+        return NULL;
+    if (header.count * header.dim > 0xFFFFFFFFULL) {
+        ILog::report("ISet.openMappedSet: Too many points in file\n");
+        return NULL;
+    }
+
+    file.close();
+
+    MappedSet* set = new(std::nothrow) MappedSet(header.dim, header.count);
+    if (!set) {
+        ILog::report("ISet.openMappedSet: Not enough memory\n");
+        return NULL;
+    }
+    if (!set->mapFile(fileName)) {
+        delete set;
+        ILog::report("ISet.openMappedSet: Can't map file\n");
+        return NULL;
+    }
+    return set;
+}
+
+int ISet::appendToFile(char const* fileName, unsigned int dim, unsigned int count, double const* coords) {
+    if (!fileName || (!coords && count > 0)) {
+        ILog::report("ISet.appendToFile: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if (dim == 0) {
+        ILog::report("ISet.appendToFile: Zero dimension\n");
+        return ERR_WRONG_ARG;
+    }
+
+    QFile file(fileName);
+    SetFileHeader header;
+    if (!file.open(QIODevice::ReadWrite)) {
+        ILog::report("ISet.appendToFile: Can't open file\n");
+        return ERR_WRONG_ARG;
+    }
+    if (file.size() == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SET_FILE_MAGIC, sizeof(SET_FILE_MAGIC));
+        header.version = SET_FILE_VERSION;
+        header.dim = dim;
+    } else {
+        int errCode = readHeader(file, header, "ISet.appendToFile: File is not a set file or is truncated\n");
+        if (errCode != ERR_OK)
+            return errCode;
+        if (header.dim != dim) {
+            ILog::report("ISet.appendToFile: File has another dimension\n");
+            return ERR_DIMENSIONS_MISMATCH;
+        }
+    }
+
+    /*points are written first and counted by header after, so interrupted append loses only new points*/
+    qint64 dataEnd = sizeof(SetFileHeader) + header.count * dim * sizeof(double);
+    qint64 size = static_cast<qint64>(count) * dim * sizeof(double);
+    if (!file.seek(dataEnd) || file.write(reinterpret_cast<char const*>(coords), size) != size || !file.flush()) {
+        ILog::report("ISet.appendToFile: Can't write points\n");
+        return ERR_ANY_OTHER;
+    }
+    header.count += count;
+    if (!file.seek(0) || file.write(reinterpret_cast<char const*>(&header), sizeof(header)) != sizeof(header)) {
+        ILog::report("ISet.appendToFile: Can't write header\n");
+        return ERR_ANY_OTHER;
+    }
+    return ERR_OK;
+}
+
+MappedSet::MappedSet(unsigned int dim, unsigned int count):
+    _map(NULL), _data(NULL), _count(count), _grid(dim, MAPPED_EPS), _tree(dim), _dim(dim)
+{}
+
+/*mapping only makes the range addressable, pages are read on first access*/
+bool MappedSet::mapFile(char const* fileName) {
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly))
+        return false;
+    _map = _file.map(0, sizeof(SetFileHeader) + static_cast<qint64>(_count) * _dim * sizeof(double));
+    if (!_map)
+        return false;
+    _data = reinterpret_cast<double const*>(_map + sizeof(SetFileHeader));
+    return true;
+}
+
+MappedSet::~MappedSet() {
+    if (_map)
+        _file.unmap(_map);
+}
+
+int MappedSet::put(IVector const* const item) {
+    ILog::report("ISet.put: Mapped set is read-only\n");
+    return ERR_NOT_IMPLEMENTED;
+}
+
+int MappedSet::remove(unsigned int index) {
+    ILog::report("ISet.remove: Mapped set is read-only\n");
+    return ERR_NOT_IMPLEMENTED;
+}
+
+int MappedSet::clear() {
+    ILog::report("ISet.clear: Mapped set is read-only\n");
+    return ERR_NOT_IMPLEMENTED;
+}
+
+int MappedSet::get(unsigned int index, IVector*& pItem) const {
+    if  (index >= getSize()) {
+        ILog::report("ISet.get: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    pItem = IVector::createVector(_dim, getPointCoords(index));
+    if (!pItem) {
+        ILog::report("ISet.get: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+    return ERR_OK;
+}
+
+int MappedSet::getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const {
+    if  (index >= getSize()) {
+        ILog::report("ISet.getCoordsPtr: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    dim = _dim;
+    coords = getPointCoords(index);
+    return ERR_OK;
+}
+
+int MappedSet::getData(unsigned int& count, unsigned int& dim, double const*& data) const {
+    count = _count;
+    dim = _dim;
+    data = _data;
+    return ERR_OK;
+}
+
+int MappedSet::exportTo(unsigned int bufferSize, double* buffer) const {
+    if (!buffer) {
+        ILog::report("ISet.exportTo: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if (bufferSize < _count * _dim) {
+        ILog::report("ISet.exportTo: Buffer is too small\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    memcpy(buffer, _data, _count * _dim * sizeof(double));
+    return ERR_OK;
+}
+
+int MappedSet::getCoords(IVector const* const pItem, double const*& coords, char const* nullMessage, char const* dimMessage) const {
+    if (!pItem) {
+        ILog::report(nullMessage);
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != pItem->getDim()) {
+        ILog::report(dimMessage);
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+
+    unsigned int dim;
+    return pItem->getCoordsPtr(dim, coords);
+}
+
+int MappedSet::contains(IVector const* const pItem, bool& rc) const {
+    double const* coords;
+    int errCode = getCoords(pItem, coords, "ISet.contains: Input argument is nullptr\n",
+                            "ISet.contains: Input argument has another dimension\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    return _grid.find(*this, coords, rc);
+}
+
+int MappedSet::getNearest(IVector const* const pItem, unsigned int k, unsigned int*& indices, unsigned int& count) const {
+    double const* coords;
+    QVector<unsigned int> found;
+    int errCode = getCoords(pItem, coords, "ISet.getNearest: Input argument is nullptr\n",
+                            "ISet.getNearest: Input argument has another dimension\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    errCode = _tree.getNearest(*this, coords, k, found);
+    if (errCode != ERR_OK)
+        return errCode;
+    return copyIndices(found, indices, count);
+}
+
+int MappedSet::getInRadius(IVector const* const pItem, double radius, unsigned int*& indices, unsigned int& count) const {
+    if (radius < 0) {
+        ILog::report("ISet.getInRadius: Radius is negative\n");
+        return ERR_WRONG_ARG;
+    }
+
+    double const* coords;
+    QVector<unsigned int> found;
+    int errCode = getCoords(pItem, coords, "ISet.getInRadius: Input argument is nullptr\n",
+                            "ISet.getInRadius: Input argument has another dimension\n");
+    if (errCode != ERR_OK)
+        return errCode;
+
+    errCode = _tree.getInRadius(*this, coords, radius, found);
+    if (errCode != ERR_OK)
+        return errCode;
+    return copyIndices(found, indices, count);
+}
+
+int MappedSet::copyIndices(QVector<unsigned int> const& found, unsigned int*& indices, unsigned int& count) {
+    unsigned int* res = new(std::nothrow) unsigned int[found.size() > 0 ? found.size() : 1];
+    if (!res) {
+        ILog::report("ISet.copyIndices: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+    for (int i = 0; i < found.size(); i++)
+        res[i] = found[i];
+    indices = res;
+    count = found.size();
+    return ERR_OK;
+}
+
+unsigned int MappedSet::getPointsAmount() const {
+    return _count;
+}
+
+double const* MappedSet::getPointCoords(unsigned int index) const {
+    return _data + static_cast<size_t>(index) * _dim;
+}
+
+unsigned int MappedSet::getSize() const {
+    return _count;
+}
+
+MappedSet::IIterator* MappedSet::end() {
+    return _iterators.create(this, true);
+}
+
+MappedSet::IIterator* MappedSet::begin() {
+    return _iterators.create(this, false);
+}
+
+int MappedSet::deleteIterator(IIterator * pIter) {
+    return _iterators.remove(pIter);
+}
+
+int MappedSet::getByIterator(IIterator const* pIter, IVector*& pItem) const {
+    return _iterators.getByIterator(this, pIter, pItem);
+}
+
+int MappedSet::getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    return _iterators.getCoordsPtrByIterator(this, pIter, dim, coords);
+}
@@ -0,0 +1,642 @@
+#include <QVector>
+#include <QMap>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include "ISet.h"
+#include "error.h"
+#include "ILog.h"
+#include "SetIterators.h"
+
+namespace {
+    const double PARETO_EPS = 1e-8;
+    /*bucket is split in two when it gets more points, node when it gets more buckets*/
+    const unsigned int MAX_BUCKET_SIZE = 64;
+    const unsigned int MAX_NODE_BUCKETS = 16;
+
+    /*orders indices of points by one objective*/
+    class ObjectiveLess
+    {
+    public:
+        ObjectiveLess(QVector<double> const& coords, unsigned int dim, unsigned int objective):
+            _coords(coords), _dim(dim), _objective(objective) {}
+
+        bool operator()(unsigned int left, unsigned int right) const {
+            return _coords[left * _dim + _objective] < _coords[right * _dim + _objective];
+        }
+
+    private:
+        QVector<double> const& _coords;
+        unsigned int _dim;
+        unsigned int _objective;
+    };
+
+    class ParetoSet : public ISet
+    {
+    public:
+        int getId() const;
+
+        int put(IVector const* const item);
+        int putUnique(IVector const* const item, bool& added);
+        int get(unsigned int index, IVector*& pItem) const;
+        int remove(unsigned int index);
+        using ISet::remove;
+        int contains(IVector const* const pItem, bool& rc) const;
+        unsigned int getSize() const;
+        int clear();
+
+        int putMany(unsigned int count, double const* coords);
+        int exportTo(unsigned int bufferSize, double* buffer) const;
+
+        int getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const;
+        int getData(unsigned int& count, unsigned int& dim, double const*& data) const;
+
+        IIterator* end();
+        IIterator* begin();
+
+        int deleteIterator(IIterator * pIter);
+        int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+        int getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const;
+
+
+        /*ctor*/
+        ParetoSet(unsigned int dim, unsigned int objectives, unsigned int capacity);
+        /*dtor*/
+        ~ParetoSet();
+
+    private:
+        /*points below node of ND-tree lie in the box from ideal to nadir point*/
+        struct Box
+        {
+            QVector<double> ideal;
+            QVector<double> nadir;
+        };
+        struct Node;
+        /*leaf of ND-tree*/
+        struct Bucket : Box
+        {
+            Node* node;
+            QVector<unsigned int> points;
+        };
+        /*inner node of two-level ND-tree, its box covers boxes of its buckets*/
+        struct Node : Box
+        {
+            QVector<Bucket*> buckets;
+        };
+
+        int putPoint(double const* coords, bool& added);
+        bool isDominated(double const* point) const;
+        void removeDominated(double const* point);
+        void link(unsigned int index);
+        void unlink(unsigned int index);
+        void removePoint(unsigned int index);
+        unsigned int prune();
+
+        Bucket* chooseBucket(double const* point) const;
+        double getGrowth(Box const& box, double const* point) const;
+        void updateBox(Box& box, double const* point) const;
+        void rebuildBox(Bucket& bucket) const;
+        void rebuildBox(Node& node) const;
+        void splitBucket(Bucket* bucket);
+        void splitNode(Node* node);
+        void removeBucket(Bucket* bucket);
+
+        /*'left' is not worse than 'right' by every objective (within EPS)*/
+        bool isWeaklyDominating(double const* left, double const* right) const;
+        /*'left' is not worse than 'right' by every objective exactly*/
+        bool isCovering(double const* left, double const* right) const;
+        double const* getPointCoords(unsigned int index) const;
+
+        /*coordinates of all points one after another, point 'i' starts at i * _dim*/
+        QVector<double> _coords;
+        /*two objectives: front ordered by first objective, second one decreases along it*/
+        QMap<double, unsigned int> _front;
+        /*more objectives: nodes of ND-tree and the bucket of every point*/
+        QVector<Node*> _nodes;
+        QVector<Bucket*> _bucketOf;
+        IndexIterators _iterators;
+        unsigned int _dim;
+        unsigned int _objectives;
+        unsigned int _capacity;
+    };
+
+} //end anonymous namespace
+
+int ParetoSet::getId() const {
+    return ISet::INTERFACE_1;
+}
+
+ISet* ISet::createParetoSet(unsigned int R_dim, unsigned int objectives, unsigned int capacity) {
+    if (R_dim == 0) {
+        ILog::report("ISet.createParetoSet: Can't create Set with zero dimension\n");
+        return NULL;
+    }
+    if (objectives > R_dim) {
+        ILog::report("ISet.createParetoSet: More objectives than dimension\n");
+        return NULL;
+    }
+
+    ISet* set = new(std::nothrow) ParetoSet(R_dim, objectives == 0 ? R_dim : objectives, capacity);
+    if (!set) {
+        ILog::report("ISet.createParetoSet: Not enough memory\n");
+        return NULL;
+    }
+    return set;
+}
+
+ParetoSet::ParetoSet(unsigned int dim, unsigned int objectives, unsigned int capacity):
+    _dim(dim), _objectives(objectives), _capacity(capacity)
+{}
+
+ParetoSet::~ParetoSet() {
+    clear();
+}
+
+bool ParetoSet::isWeaklyDominating(double const* left, double const* right) const {
+    for (unsigned int i = 0; i < _objectives; i++) {
+        if (!(left[i] <= right[i] + PARETO_EPS))
+            return false;
+    }
+    return true;
+}
+
+bool ParetoSet::isCovering(double const* left, double const* right) const {
+    for (unsigned int i = 0; i < _objectives; i++) {
+        if (!(left[i] <= right[i]))
+            return false;
+    }
+    return true;
+}
+
+double const* ParetoSet::getPointCoords(unsigned int index) const {
+    return _coords.constData() + index * _dim;
+}
+
+/*new point is rejected if archive has a point not worse by every objective*/
+bool ParetoSet::isDominated(double const* point) const {
+    if (_objectives == 2) {
+        /*among points with first objective not greater, the last one has the least second one*/
+        QMap<double, unsigned int>::const_iterator it = _front.upperBound(point[0] + PARETO_EPS);
+        if (it == _front.begin())
+            return false;
+        --it;
+        return getPointCoords(it.value())[1] <= point[1] + PARETO_EPS;
+    }
+    /*only boxes with ideal point dominating new one may contain its dominators*/
+    for (int i = 0; i < _nodes.size(); i++) {
+        Node const* node = _nodes[i];
+        if (!isWeaklyDominating(node->ideal.constData(), point))
+            continue;
+        for (int j = 0; j < node->buckets.size(); j++) {
+            Bucket const* bucket = node->buckets[j];
+            if (!isWeaklyDominating(bucket->ideal.constData(), point))
+                continue;
+            for (int k = 0; k < bucket->points.size(); k++) {
+                if (isWeaklyDominating(getPointCoords(bucket->points[k]), point))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ParetoSet::removeDominated(double const* point) {
+    QVector<unsigned int> dominated;
+    if (_objectives == 2) {
+        /*dominated points follow new one in front while their second objective isn't less*/
+        QMap<double, unsigned int>::iterator it = _front.lowerBound(point[0]);
+        for (; it != _front.end() && getPointCoords(it.value())[1] >= point[1]; ++it)
+            dominated.append(it.value());
+    }
+    else {
+        /*new point dominates points of box only if it isn't worse than its nadir point*/
+        for (int i = 0; i < _nodes.size(); i++) {
+            Node const* node = _nodes[i];
+            if (!isCovering(point, node->nadir.constData()))
+                continue;
+            for (int j = 0; j < node->buckets.size(); j++) {
+                Bucket const* bucket = node->buckets[j];
+                if (!isCovering(point, bucket->nadir.constData()))
+                    continue;
+                for (int k = 0; k < bucket->points.size(); k++) {
+                    if (isCovering(point, getPointCoords(bucket->points[k])))
+                        dominated.append(bucket->points[k]);
+                }
+            }
+        }
+    }
+    /*points are removed from the highest index, so the last point moved by removal is never in the list*/
+    std::sort(dominated.begin(), dominated.end());
+    for (int i = dominated.size(); i > 0; i--)
+        removePoint(dominated[i - 1]);
+}
+
+void ParetoSet::updateBox(Box& box, double const* point) const {
+    if (box.ideal.isEmpty()) {
+        box.ideal.resize(_objectives);
+        box.nadir.resize(_objectives);
+        for (unsigned int i = 0; i < _objectives; i++)
+            box.ideal[i] = box.nadir[i] = point[i];
+        return;
+    }
+    for (unsigned int i = 0; i < _objectives; i++) {
+        box.ideal[i] = std::min(box.ideal[i], point[i]);
+        box.nadir[i] = std::max(box.nadir[i], point[i]);
+    }
+}
+
+void ParetoSet::rebuildBox(Bucket& bucket) const {
+    bucket.ideal.clear();
+    bucket.nadir.clear();
+    for (int i = 0; i < bucket.points.size(); i++)
+        updateBox(bucket, getPointCoords(bucket.points[i]));
+}
+
+void ParetoSet::rebuildBox(Node& node) const {
+    node.ideal.clear();
+    node.nadir.clear();
+    for (int i = 0; i < node.buckets.size(); i++) {
+        updateBox(node, node.buckets[i]->ideal.constData());
+        updateBox(node, node.buckets[i]->nadir.constData());
+    }
+}
+
+double ParetoSet::getGrowth(Box const& box, double const* point) const {
+    double growth = 0;
+    for (unsigned int i = 0; i < _objectives; i++)
+        growth += std::max(0.0, box.ideal[i] - point[i]) + std::max(0.0, point[i] - box.nadir[i]);
+    return growth;
+}
+
+/*node and then its bucket whose box grows least, as in R-trees*/
+ParetoSet::Bucket* ParetoSet::chooseBucket(double const* point) const {
+    Node* node = _nodes[0];
+    double bestGrowth = std::numeric_limits<double>::max();
+    for (int i = 0; i < _nodes.size(); i++) {
+        double growth = getGrowth(*_nodes[i], point);
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            node = _nodes[i];
+        }
+    }
+    Bucket* best = node->buckets[0];
+    bestGrowth = std::numeric_limits<double>::max();
+    for (int i = 0; i < node->buckets.size(); i++) {
+        double growth = getGrowth(*node->buckets[i], point);
+        if (growth < bestGrowth) {
+            bestGrowth = growth;
+            best = node->buckets[i];
+        }
+    }
+    return best;
+}
+
+/*splits points by median of objective with the widest spread*/
+void ParetoSet::splitBucket(Bucket* bucket) {
+    Bucket* half = new(std::nothrow) Bucket;
+    if (!half)
+        return;
+    unsigned int axis = 0;
+    for (unsigned int i = 1; i < _objectives; i++) {
+        if (bucket->nadir[i] - bucket->ideal[i] > bucket->nadir[axis] - bucket->ideal[axis])
+            axis = i;
+    }
+    QVector<unsigned int>& points = bucket->points;
+    unsigned int* order = points.data();
+    std::nth_element(order, order + points.size() / 2, order + points.size(), ObjectiveLess(_coords, _dim, axis));
+    for (int i = points.size() / 2; i < points.size(); i++) {
+        half->points.append(points[i]);
+        _bucketOf[points[i]] = half;
+    }
+    points.resize(points.size() / 2);
+    rebuildBox(*bucket);
+    rebuildBox(*half);
+    half->node = bucket->node;
+    bucket->node->buckets.append(half);
+    if (static_cast<unsigned int>(bucket->node->buckets.size()) > MAX_NODE_BUCKETS)
+        splitNode(bucket->node);
+}
+
+/*splits buckets by median of centers of their boxes along objective with the widest spread*/
+void ParetoSet::splitNode(Node* node) {
+    Node* half = new(std::nothrow) Node;
+    if (!half)
+        return;
+    unsigned int axis = 0;
+    for (unsigned int i = 1; i < _objectives; i++) {
+        if (node->nadir[i] - node->ideal[i] > node->nadir[axis] - node->ideal[axis])
+            axis = i;
+    }
+    QVector<Bucket*>& buckets = node->buckets;
+    QVector<std::pair<double, Bucket*> > centers;
+    for (int i = 0; i < buckets.size(); i++)
+        centers.append(std::make_pair(buckets[i]->ideal[axis] + buckets[i]->nadir[axis], buckets[i]));
+    std::sort(centers.begin(), centers.end());
+    buckets.clear();
+    for (int i = 0; i < centers.size(); i++) {
+        Bucket* bucket = centers[i].second;
+        bucket->node = i < centers.size() / 2 ? node : half;
+        bucket->node->buckets.append(bucket);
+    }
+    rebuildBox(*node);
+    rebuildBox(*half);
+    _nodes.append(half);
+}
+
+void ParetoSet::removeBucket(Bucket* bucket) {
+    Node* node = bucket->node;
+    node->buckets.remove(node->buckets.indexOf(bucket));
+    delete bucket;
+    if (!node->buckets.isEmpty()) {
+        rebuildBox(*node);
+        return;
+    }
+    _nodes.remove(_nodes.indexOf(node));
+    delete node;
+}
+
+/*adds stored point to dominance structure*/
+void ParetoSet::link(unsigned int index) {
+    double const* point = getPointCoords(index);
+    if (_objectives == 2) {
+        _front.insert(point[0], index);
+        return;
+    }
+    Bucket* bucket;
+    if (_nodes.isEmpty()) {
+        Node* root = new(std::nothrow) Node;
+        if (!root || !(bucket = new(std::nothrow) Bucket)) {
+            delete root;
+            return;
+        }
+        bucket->node = root;
+        root->buckets.append(bucket);
+        _nodes.append(root);
+    }
+    else {
+        bucket = chooseBucket(point);
+    }
+    bucket->points.append(index);
+    _bucketOf[index] = bucket;
+    updateBox(*bucket, point);
+    updateBox(*bucket->node, point);
+    if (static_cast<unsigned int>(bucket->points.size()) > MAX_BUCKET_SIZE)
+        splitBucket(bucket);
+}
+
+void ParetoSet::unlink(unsigned int index) {
+    if (_objectives == 2) {
+        _front.remove(getPointCoords(index)[0]);
+        return;
+    }
+    Bucket* bucket = _bucketOf[index];
+    if (!bucket)
+        return;
+    QVector<unsigned int>& points = bucket->points;
+    for (int i = 0; i < points.size(); i++) {
+        if (points[i] == index) {
+            points[i] = points.last();
+            points.resize(points.size() - 1);
+            break;
+        }
+    }
+    if (points.isEmpty()) {
+        removeBucket(bucket);
+        return;
+    }
+    rebuildBox(*bucket);
+    rebuildBox(*bucket->node);
+}
+
+/*last point takes place of removed one, iterators of removed point are deleted*/
+void ParetoSet::removePoint(unsigned int index) {
+    unsigned int last = getSize() - 1;
+    unlink(index);
+    if (index != last) {
+        double const* moved = getPointCoords(last);
+        if (_objectives == 2) {
+            _front[moved[0]] = index;
+        }
+        else {
+            if (_bucketOf[last]) {
+                QVector<unsigned int>& points = _bucketOf[last]->points;
+                for (int i = 0; i < points.size(); i++) {
+                    if (points[i] == last)
+                        points[i] = index;
+                }
+            }
+            _bucketOf[index] = _bucketOf[last];
+        }
+        memcpy(_coords.data() + index * _dim, moved, _dim * sizeof(double));
+    }
+    _coords.resize(last * _dim);
+    if (_objectives != 2)
+        _bucketOf.resize(last);
+
+    _iterators.erase(index, last);
+}
+
+/*removes point with the least crowding distance, extreme points of every objective are kept*/
+unsigned int ParetoSet::prune() {
+    unsigned int size = getSize();
+    QVector<double> distance(size, 0.0);
+    QVector<unsigned int> order(size);
+    for (unsigned int j = 0; j < _objectives; j++) {
+        for (unsigned int i = 0; i < size; i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), ObjectiveLess(_coords, _dim, j));
+        double range = getPointCoords(order[size - 1])[j] - getPointCoords(order[0])[j];
+        distance[order[0]] = distance[order[size - 1]] = std::numeric_limits<double>::max();
+        if (range <= 0)
+            continue;
+        for (unsigned int i = 1; i + 1 < size; i++) {
+            if (distance[order[i]] < std::numeric_limits<double>::max())
+                distance[order[i]] += (getPointCoords(order[i + 1])[j] - getPointCoords(order[i - 1])[j]) / range;
+        }
+    }
+    unsigned int crowded = std::min_element(distance.begin(), distance.end()) - distance.begin();
+    removePoint(crowded);
+    return crowded;
+}
+
+int ParetoSet::putPoint(double const* coords, bool& added) {
+    added = false;
+    if (isDominated(coords))
+        return ERR_OK;
+    removeDominated(coords);
+
+    int size = _coords.size();
+    _coords.resize(size + _dim);
+    memcpy(_coords.data() + size, coords, _dim * sizeof(double));
+    if (_objectives != 2)
+        _bucketOf.append(NULL);
+    link(getSize() - 1);
+    added = true;
+
+    /*new point is the last one, so it was pruned itself if the last point is gone*/
+    if (_capacity > 0 && getSize() > _capacity)
+        added = prune() != getSize();
+    return ERR_OK;
+}
+
+int ParetoSet::put(IVector const* const item) {
+    bool added;
+    return putUnique(item, added);
+}
+
+int ParetoSet::putUnique(IVector const* const item, bool& added) {
+    if (!item) {
+        ILog::report("ISet.put: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != item->getDim()) {
+        ILog::report("ISet.put: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+
+    unsigned int dim;
+    double const* coords;
+    int errCode = item->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK) {
+        ILog::report("ISet.put: Can't get coordinates of input argument\n");
+        return errCode;
+    }
+
+    return putPoint(coords, added);
+}
+
+int ParetoSet::putMany(unsigned int count, double const* coords) {
+    if (!coords && count > 0) {
+        ILog::report("ISet.putMany: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    bool added;
+    for (unsigned int i = 0; i < count; i++)
+        putPoint(coords + i * _dim, added);
+    return ERR_OK;
+}
+
+int ParetoSet::get(unsigned int index, IVector*& pItem) const {
+    if  (index >= getSize()) {
+        ILog::report("ISet.get: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    pItem = IVector::createVector(_dim, getPointCoords(index));
+    if (!pItem) {
+        ILog::report("ISet.get: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+    return ERR_OK;
+}
+
+int ParetoSet::getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const {
+    if  (index >= getSize()) {
+        ILog::report("ISet.getCoordsPtr: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    dim = _dim;
+    coords = getPointCoords(index);
+    return ERR_OK;
+}
+
+int ParetoSet::getData(unsigned int& count, unsigned int& dim, double const*& data) const {
+    count = getSize();
+    dim = _dim;
+    data = _coords.constData();
+    return ERR_OK;
+}
+
+int ParetoSet::exportTo(unsigned int bufferSize, double* buffer) const {
+    if (!buffer) {
+        ILog::report("ISet.exportTo: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if (bufferSize < (unsigned int)_coords.size()) {
+        ILog::report("ISet.exportTo: Buffer is too small\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    memcpy(buffer, _coords.constData(), _coords.size() * sizeof(double));
+    return ERR_OK;
+}
+
+int ParetoSet::remove(unsigned int index) {
+    if  (index >= getSize()) {
+        ILog::report("ISet.remove: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    removePoint(index);
+    return ERR_OK;
+}
+
+int ParetoSet::contains(IVector const* const pItem, bool& rc) const {
+    if (!pItem) {
+        ILog::report("ISet.contains: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != pItem->getDim()) {
+        ILog::report("ISet.contains: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+
+    unsigned int dim;
+    double const* coords;
+    int errCode = pItem->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    rc = false;
+    for (unsigned int i = 0; i < getSize() && !rc; i++) {
+        double const* point = getPointCoords(i);
+        rc = true;
+        for (unsigned int j = 0; j < _dim && rc; j++)
+            rc = std::fabs(point[j] - coords[j]) < PARETO_EPS;
+    }
+    return ERR_OK;
+}
+
+unsigned int ParetoSet::getSize() const {
+    return _coords.size() / _dim;
+}
+
+int ParetoSet::clear() {
+    _coords.clear();
+    _front.clear();
+    for (int i = 0; i < _nodes.size(); i++) {
+        for (int j = 0; j < _nodes[i]->buckets.size(); j++)
+            delete _nodes[i]->buckets[j];
+        delete _nodes[i];
+    }
+    _nodes.clear();
+    _bucketOf.clear();
+
+    _iterators.clear();
+
+    return ERR_OK;
+}
+
+ParetoSet::IIterator* ParetoSet::end() {
+    return _iterators.create(this, true);
+}
+
+ParetoSet::IIterator* ParetoSet::begin() {
+    return _iterators.create(this, false);
+}
+
+int ParetoSet::deleteIterator(IIterator * pIter) {
+    return _iterators.remove(pIter);
+}
+
+int ParetoSet::getByIterator(IIterator const* pIter, IVector*& pItem) const {
+    return _iterators.getByIterator(this, pIter, pItem);
+}
+
+int ParetoSet::getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    return _iterators.getCoordsPtrByIterator(this, pIter, dim, coords);
+}
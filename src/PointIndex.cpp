@@ -0,0 +1,280 @@
+#include <cmath>
+#include <algorithm>
+#include "PointIndex.h"
+#include "error.h"
+
+namespace {
+    /*orders indices of points by one coordinate*/
+    class AxisLess
+    {
+    public:
+        AxisLess(PointSource const& source, unsigned int axis): _source(source), _axis(axis) {}
+
+        bool operator()(unsigned int left, unsigned int right) const {
+            return _source.getPointCoords(left)[_axis] < _source.getPointCoords(right)[_axis];
+        }
+
+    private:
+        PointSource const& _source;
+        unsigned int _axis;
+    };
+} //end anonymous namespace
+
+PointGrid::PointGrid(unsigned int dim, double eps):
+    _dim(dim), _eps(eps), _valid(false)
+{}
+
+void PointGrid::invalidate() {
+    _valid = false;
+}
+
+long long PointGrid::getCell(double coord, double eps) {
+    /*far points share the boundary cells, which keeps lookups correct*/
+    const double limit = 1e18;
+    double cell = std::floor(coord / (eps * CELL_SIZE_IN_EPS));
+    if (!(cell > -limit))
+        return static_cast<long long>(-limit);
+    if (cell > limit)
+        return static_cast<long long>(limit);
+    return static_cast<long long>(cell);
+}
+
+unsigned long long PointGrid::hashCell(long long const* cell, unsigned int dim) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < dim; i++) {
+        hash ^= static_cast<unsigned long long>(cell[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ (hash >> 29);
+}
+
+/*query box crosses at most two cells by every axis as cells are wider than 2 * eps*/
+bool PointGrid::getTouchedCells(double const* point, unsigned int dim, double eps, QVector<long long>& low, QVector<unsigned int>& split) {
+    low.resize(dim);
+    split.clear();
+    for (unsigned int i = 0; i < dim; i++) {
+        low[i] = getCell(point[i] - eps, eps);
+        if (getCell(point[i] + eps, eps) != low[i])
+            split.append(i);
+    }
+    return static_cast<unsigned int>(split.size()) <= MAX_SPLIT_AXES;
+}
+
+unsigned int PointGrid::getBucket(long long const* cell) const {
+    return static_cast<unsigned int>(hashCell(cell, _dim)) & (_heads.size() - 1);
+}
+
+bool PointGrid::isEqual(double const* left, double const* right) const {
+    for (unsigned int i = 0; i < _dim; i++) {
+        if (!(std::fabs(left[i] - right[i]) < _eps))
+            return false;
+    }
+    return true;
+}
+
+void PointGrid::link(unsigned int bucket, unsigned int index) {
+    _next[index] = _heads[bucket];
+    _heads[bucket] = index;
+}
+
+void PointGrid::rebuild(PointSource const& source) {
+    unsigned int count = source.getPointsAmount(), buckets = MIN_BUCKETS;
+    while (buckets < count)
+        buckets <<= 1;
+    _heads.fill(-1, buckets);
+    _next.fill(-1, count);
+    QVector<long long> cell(_dim);
+    for (unsigned int i = 0; i < count; i++) {
+        double const* coords = source.getPointCoords(i);
+        for (unsigned int j = 0; j < _dim; j++)
+            cell[j] = getCell(coords[j], _eps);
+        link(getBucket(cell.constData()), i);
+    }
+    _valid = true;
+}
+
+void PointGrid::insert(PointSource const& source, unsigned int index) {
+    if (!_valid)
+        return;
+    if (index != static_cast<unsigned int>(_next.size())) {
+        _valid = false;
+        return;
+    }
+    /*load factor is kept under one point per bucket*/
+    if (index >= static_cast<unsigned int>(_heads.size())) {
+        rebuild(source);
+        return;
+    }
+    QVector<long long> cell(_dim);
+    double const* coords = source.getPointCoords(index);
+    for (unsigned int j = 0; j < _dim; j++)
+        cell[j] = getCell(coords[j], _eps);
+    _next.append(-1);
+    link(getBucket(cell.constData()), index);
+}
+
+int PointGrid::find(PointSource const& source, double const* point, bool& found) {
+    if (!_valid)
+        rebuild(source);
+    found = false;
+    QVector<long long> low, cell;
+    QVector<unsigned int> split;
+    /*too many cells to probe, scanning all points is cheaper*/
+    if (!getTouchedCells(point, _dim, _eps, low, split)) {
+        for (unsigned int index = 0; index < source.getPointsAmount(); index++) {
+            if (isEqual(source.getPointCoords(index), point)) {
+                found = true;
+                return ERR_OK;
+            }
+        }
+        return ERR_OK;
+    }
+    for (unsigned int mask = 0; mask < (1u << split.size()); mask++) {
+        cell = low;
+        for (int j = 0; j < split.size(); j++) {
+            if (mask & (1u << j))
+                cell[split[j]]++;
+        }
+        for (int index = _heads[getBucket(cell.constData())]; index >= 0; index = _next[index]) {
+            if (isEqual(source.getPointCoords(index), point)) {
+                found = true;
+                return ERR_OK;
+            }
+        }
+    }
+    return ERR_OK;
+}
+
+KdTree::KdTree(unsigned int dim):
+    _dim(dim), _built(0)
+{}
+
+void KdTree::invalidate() {
+    _built = 0;
+    _order.clear();
+    _axes.clear();
+}
+
+void KdTree::update(PointSource const& source) {
+    unsigned int count = source.getPointsAmount();
+    if (_built > count) {
+        invalidate();
+    }
+    unsigned int tail = count - _built;
+    if (tail <= MIN_TAIL || tail <= _built / 4)
+        return;
+    _order.resize(count);
+    _axes.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+        _order[i] = i;
+    build(source, 0, count);
+    _built = count;
+}
+
+/*median of the range by the axis of the biggest spread becomes the node of the range*/
+void KdTree::build(PointSource const& source, unsigned int lo, unsigned int hi) {
+    if (hi - lo < 2) {
+        if (hi > lo)
+            _axes[lo] = 0;
+        return;
+    }
+    unsigned int axis = 0, mid = lo + (hi - lo) / 2;
+    double bestSpread = -1;
+    for (unsigned int j = 0; j < _dim; j++) {
+        double minCoord = source.getPointCoords(_order[lo])[j], maxCoord = minCoord;
+        for (unsigned int i = lo + 1; i < hi; i++) {
+            double coord = source.getPointCoords(_order[i])[j];
+            minCoord = std::min(minCoord, coord);
+            maxCoord = std::max(maxCoord, coord);
+        }
+        if (maxCoord - minCoord > bestSpread) {
+            bestSpread = maxCoord - minCoord;
+            axis = j;
+        }
+    }
+    unsigned int* order = _order.data();
+    std::nth_element(order + lo, order + mid, order + hi, AxisLess(source, axis));
+    _axes[mid] = axis;
+    build(source, lo, mid);
+    build(source, mid + 1, hi);
+}
+
+double KdTree::distance2(double const* left, double const* right) const {
+    double res = 0;
+    for (unsigned int i = 0; i < _dim; i++)
+        res += (left[i] - right[i]) * (left[i] - right[i]);
+    return res;
+}
+
+/*'heap' is a max-heap of at most 'k' nearest points found so far*/
+void KdTree::pushNeighbor(unsigned int k, Neighbor const& neighbor, QVector<Neighbor>& heap) const {
+    if (static_cast<unsigned int>(heap.size()) < k) {
+        heap.append(neighbor);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (neighbor < heap.first()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.last() = neighbor;
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
+void KdTree::searchNearest(PointSource const& source, double const* point, unsigned int k, unsigned int lo, unsigned int hi, QVector<Neighbor>& heap) const {
+    if (lo >= hi)
+        return;
+    unsigned int mid = lo + (hi - lo) / 2, index = _order[mid];
+    double const* coords = source.getPointCoords(index);
+    pushNeighbor(k, Neighbor(distance2(coords, point), index), heap);
+    double diff = point[_axes[mid]] - coords[_axes[mid]];
+    if (diff < 0) {
+        searchNearest(source, point, k, lo, mid, heap);
+        if (static_cast<unsigned int>(heap.size()) < k || diff * diff <= heap.first().first)
+            searchNearest(source, point, k, mid + 1, hi, heap);
+    } else {
+        searchNearest(source, point, k, mid + 1, hi, heap);
+        if (static_cast<unsigned int>(heap.size()) < k || diff * diff <= heap.first().first)
+            searchNearest(source, point, k, lo, mid, heap);
+    }
+}
+
+void KdTree::searchInRadius(PointSource const& source, double const* point, double radius2, unsigned int lo, unsigned int hi, QVector<unsigned int>& result) const {
+    if (lo >= hi)
+        return;
+    unsigned int mid = lo + (hi - lo) / 2, index = _order[mid];
+    double const* coords = source.getPointCoords(index);
+    if (distance2(coords, point) <= radius2)
+        result.append(index);
+    double diff = point[_axes[mid]] - coords[_axes[mid]];
+    if (diff <= 0 || diff * diff <= radius2)
+        searchInRadius(source, point, radius2, lo, mid, result);
+    if (diff >= 0 || diff * diff <= radius2)
+        searchInRadius(source, point, radius2, mid + 1, hi, result);
+}
+
+int KdTree::getNearest(PointSource const& source, double const* point, unsigned int k, QVector<unsigned int>& result) {
+    QVector<Neighbor> heap;
+    result.clear();
+    if (k == 0)
+        return ERR_OK;
+    update(source);
+    searchNearest(source, point, k, 0, _built, heap);
+    for (unsigned int i = _built; i < source.getPointsAmount(); i++)
+        pushNeighbor(k, Neighbor(distance2(source.getPointCoords(i), point), i), heap);
+    std::sort_heap(heap.begin(), heap.end());
+    for (int i = 0; i < heap.size(); i++)
+        result.append(heap[i].second);
+    return ERR_OK;
+}
+
+int KdTree::getInRadius(PointSource const& source, double const* point, double radius, QVector<unsigned int>& result) {
+    result.clear();
+    if (radius < 0)
+        return ERR_WRONG_ARG;
+    update(source);
+    searchInRadius(source, point, radius * radius, 0, _built, result);
+    for (unsigned int i = _built; i < source.getPointsAmount(); i++) {
+        if (distance2(source.getPointCoords(i), point) <= radius * radius)
+            result.append(i);
+    }
+    std::sort(result.begin(), result.end());
+    return ERR_OK;
+}
@@ -0,0 +1,87 @@
+#ifndef POINTINDEX_H
+#define POINTINDEX_H
+
+#include <QVector>
+#include <utility>
+
+/*points indexed by PointGrid and KdTree, indices are positions in the source*/
+class PointSource
+{
+public:
+    virtual unsigned int getPointsAmount() const = 0;
+    virtual double const* getPointCoords(unsigned int index) const = 0;
+
+protected:
+    virtual ~PointSource() {}
+};
+
+/*hash grid with cells much bigger than 'eps', finds points equal within 'eps' by NORM_INF
+  probing only the cells which the query box intersects; points are added incrementally,
+  any other change of the source invalidates the grid and it is rebuilt by the next query*/
+class PointGrid
+{
+public:
+    PointGrid(unsigned int dim, double eps);
+
+    void invalidate();
+    void insert(PointSource const& source, unsigned int index);
+    int find(PointSource const& source, double const* point, bool& found);
+
+    /*cells are shared with other structures spreading points by the same grid (shards of concurrent set)*/
+    static const unsigned int CELL_SIZE_IN_EPS = 64;
+    static const unsigned int MAX_SPLIT_AXES = 10;
+
+    /*cell of coordinate, far coordinates share the boundary cells*/
+    static long long getCell(double coord, double eps);
+    static unsigned long long hashCell(long long const* cell, unsigned int dim);
+    /*the lowest cell which the box of 'eps' around point touches and axes along which the box crosses
+      into the next cell, false if there are more than MAX_SPLIT_AXES of them to probe*/
+    static bool getTouchedCells(double const* point, unsigned int dim, double eps, QVector<long long>& low, QVector<unsigned int>& split);
+
+private:
+    static const unsigned int MIN_BUCKETS = 16;
+
+    void rebuild(PointSource const& source);
+    void link(unsigned int bucket, unsigned int index);
+    bool isEqual(double const* left, double const* right) const;
+    unsigned int getBucket(long long const* cell) const;
+
+    unsigned int _dim;
+    double _eps;
+    bool _valid;
+    QVector<int> _heads;    // first point of every bucket, -1 for empty ones
+    QVector<int> _next;     // next point of the same bucket for every point
+};
+
+/*k-d tree over the first points of the source, the rest are scanned linearly
+  until there are enough of them to rebuild the tree*/
+class KdTree
+{
+public:
+    KdTree(unsigned int dim);
+
+    void invalidate();
+    /*indices of 'k' nearest points by NORM_2 sorted by distance*/
+    int getNearest(PointSource const& source, double const* point, unsigned int k, QVector<unsigned int>& result);
+    /*indices of points not farther than 'radius' by NORM_2 sorted by index*/
+    int getInRadius(PointSource const& source, double const* point, double radius, QVector<unsigned int>& result);
+
+private:
+    typedef std::pair<double, unsigned int> Neighbor;
+
+    static const unsigned int MIN_TAIL = 64;
+
+    void update(PointSource const& source);
+    void build(PointSource const& source, unsigned int lo, unsigned int hi);
+    void searchNearest(PointSource const& source, double const* point, unsigned int k, unsigned int lo, unsigned int hi, QVector<Neighbor>& heap) const;
+    void searchInRadius(PointSource const& source, double const* point, double radius2, unsigned int lo, unsigned int hi, QVector<unsigned int>& result) const;
+    void pushNeighbor(unsigned int k, Neighbor const& neighbor, QVector<Neighbor>& heap) const;
+    double distance2(double const* left, double const* right) const;
+
+    unsigned int _dim;
+    unsigned int _built;        // amount of points in tree
+    QVector<unsigned int> _order;   // indices of points, median of every range is its node
+    QVector<unsigned int> _axes;    // splitting axis of every node
+};
+
+#endif // POINTINDEX_H
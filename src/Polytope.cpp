@@ -0,0 +1,1280 @@
+#include <math.h>
+#include <new>
+#include <algorithm>
+#include <qvector.h>
+#include <qlist.h>
+#include <qmutex.h>
+
+#include "ILog.h"
+#include "ICompact.h"
+
+#define nullptr 0
+
+namespace {
+	unsigned const MAX_DYKSTRA_SWEEPS = 100000;
+	unsigned const MAX_ACTIVE_SET_ITERATIONS_FACTOR = 10;
+	unsigned const MAX_EXTREME_STEPS = 100;			// projections of far points looking for extreme coordinate
+	unsigned const MAX_CELL_CORNERS_DIM = 16;		// nearest neighbor checks all corners of lattice cell up to this dim
+	double const FAR_SHIFT_FACTOR = 1e3;			// distance of far points in widths of box
+	double const DOUBLE_EPS = 1e-8;
+	double const SOLVER_EPS = 1e-12;
+
+	class Polytope : public ICompact
+	{
+	public:
+		// walks lattice points of polytope in index order of its box (or by step),
+		// sequence iterators walk points of box iterator skipping the ones out of polytope
+		class PolytopeIterator : public ICompact::IIterator
+		{
+		public:
+			PolytopeIterator(Polytope const *polytope, IIterator *boxIterator, IVector *step);
+			~PolytopeIterator();
+
+			// IIterator intarface methods:
+			int setStep(IVector const* const step);
+			int doStep();
+
+			// other utility methods:
+			int doLatticeStep();
+			int doBoxStep();
+			IVector* getPoint() const;
+
+			Polytope const* _polytope;		// polytope for iterating
+			IIterator *_boxIterator;		// iterator over bounding box (sequences only)
+			IVector *_current;				// last visited point of polytope (sequences only)
+			IVector *_step;					// step (only for non-default behaviour)
+			QVector<unsigned> _counters;	// lattice counters of current point
+			QVector<unsigned> _next;		// lattice counters of candidate point
+			QVector<double> _point;			// coordinates of candidate point
+		}; // end PolytopeIterator
+
+		unsigned _dim;						// dimension of vectors in compact
+		unsigned _rows;						// amount of half-spaces without box faces
+		ICompact *_box;						// bounding box with sampling
+		QVector<double> _begin;				// "bottom-left" corner of box
+		QVector<double> _end;				// "top-right" corner of box
+		QVector<double> _normals;			// normals of half-spaces, _rows x _dim
+		QVector<double> _offsets;			// offsets of half-spaces
+		QVector<unsigned> _samplingCounters; // amounts of lattice points of box by every axis
+		QVector<double> _samplingValues;	// distance between lattice points by every axis
+		QList<PolytopeIterator*> _iterators; // list of iterators
+
+		// warm start of projection: last projection and its active constraints,
+		// shared by threads projecting onto the same polytope, so it is copied under the lock
+		mutable QMutex _warmStartMutex;
+		mutable QVector<double> _lastPoint;
+		mutable QVector<int> _workingSet;
+
+		Polytope(ICompact *box, QVector<double> const &begin, QVector<double> const &end, QVector<double> const &normals, QVector<double> const &offsets);
+		~Polytope();
+
+		// ICompact intarface methods:
+		ICompact* clone() const;
+
+		int getId() const;
+		int getNearestNeighbor(IVector const* vec, IVector *& nn) const;
+		int getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const;
+		int isContains(IVector const* const vec, bool& result) const;
+		int isSubSet(ICompact const* const other, bool& result) const;
+		using ICompact::isSubSet;
+		int isIntersects(ICompact const* const other, bool& result) const;
+		int getBoundingBox(IVector *& begin, IVector *& end) const;
+
+		int Intersection(ICompact const& c);
+
+		IIterator* begin(IVector const* const step);
+		IIterator* end(IVector const* const step = 0);
+		IIterator* beginSequence(SequenceType type, unsigned first = 0, unsigned stride = 1);
+		int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+		int deleteIterator(IIterator *pIter);
+
+		// other utility methods:
+		int findFeasiblePoint(QVector<double> &point) const;
+		void getWarmStart(QVector<double> &point, QVector<int> &workingSet) const;
+		void setWarmStart(QVector<double> const &point, QVector<int> const &workingSet) const;
+		int project(double const *vec, QVector<double> &result) const;
+		bool isFeasible(double const *point) const;
+		int getBoxCorners(ICompact const *compact, QVector<double> &begin, QVector<double> &end) const;
+		int findIterator(IIterator const *iterator) const;
+		PolytopeIterator* createIterator(IVector const *step, bool toEnd);
+		PolytopeIterator* createSequenceIterator(IIterator *boxIterator);
+
+		// lattice of bounding box
+		int initSampling();
+		void getLatticePoint(QVector<unsigned> const &counters, QVector<double> &point) const;
+		void snapToBox(double const *point, QVector<unsigned> &counters) const;
+		int snapToLattice(double const *vec, QVector<double> const &projection, QVector<unsigned> &result) const;
+		int findLatticePoint(bool last, QVector<unsigned> const *after, QVector<unsigned> &counters) const;
+		bool searchLattice(Polytope const &slice, unsigned axis, QVector<double> const &feasible, bool last, unsigned from,
+						   QVector<unsigned> &counters) const;
+		int findAxisExtreme(QVector<double> const &feasible, bool biggest, QVector<double> &result) const;
+		bool getSlice(double const *values, unsigned count, QVector<double> &begin, QVector<double> &end,
+					  QVector<double> &normals, QVector<double> &offsets) const;
+
+		// constraints are half-spaces first, then upper and lower faces of box
+		unsigned getConstraintsAmount() const;
+		double constraintProduct(unsigned k, double const *x) const;
+		double constraintOffset(unsigned k) const;
+		void addConstraintRow(unsigned k, double scalar, double *x) const;
+	};// end Polytope
+}// end anonymous namespace
+
+ICompact* ICompact::createPolytope(IVector const* const begin, IVector const* const end, unsigned int count,
+								   IVector const* const* normals, IVector const* const offsets, IVector const* const step)
+{
+	unsigned dimension, dim;
+	double const *coords;
+	double norm;
+	ICompact *box;
+	Polytope *polytope;
+
+	if (!begin || !end || !offsets || (count > 0 && !normals))
+	{
+		ILog::report("ICompact::createPolytope: nullptr in params\n");
+		return nullptr;
+	}
+	dimension = begin->getDim();
+	if (offsets->getDim() != count)
+	{
+		ILog::report("ICompact::createPolytope: dimensions mismatch in 'offsets' param\n");
+		return nullptr;
+	}
+	QVector<double> normalsCoords(static_cast<int>(count * dimension)), offsetsCoords(static_cast<int>(count));
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (!normals[i] || normals[i]->getDim() != dimension)
+		{
+			ILog::report("ICompact::createPolytope: nullptr or dimensions mismatch in 'normals' param\n");
+			return nullptr;
+		}
+		if (normals[i]->norm(IVector::NORM_INF, norm) != ERR_OK || norm <= DOUBLE_EPS)
+		{
+			ILog::report("ICompact::createPolytope: zero normal of half-space\n");
+			return nullptr;
+		}
+		if (normals[i]->getCoordsPtr(dim, coords) != ERR_OK || offsets->getCoord(i, offsetsCoords[i]) != ERR_OK)
+		{
+			ILog::report("ICompact::createPolytope: failed to get coords from 'normals' or 'offsets' params\n");
+			return nullptr;
+		}
+		std::copy(coords, coords + dimension, normalsCoords.data() + i * dimension);
+	}
+
+	if (!(box = createCompact(begin, end, step)))
+	{
+		ILog::report("ICompact::createPolytope: failed to create bounding box\n");
+		return nullptr;
+	}
+	QVector<double> beginCoords(static_cast<int>(dimension)), endCoords(static_cast<int>(dimension));
+	for (unsigned i = 0; i < dimension; i++)
+	{
+		if (begin->getCoord(i, beginCoords[i]) != ERR_OK || end->getCoord(i, endCoords[i]) != ERR_OK)
+		{
+			ILog::report("ICompact::createPolytope: failed to get coords from 'begin' or 'end' params\n");
+			delete box;
+			return nullptr;
+		}
+	}
+	if (!(polytope = new(std::nothrow) Polytope(box, beginCoords, endCoords, normalsCoords, offsetsCoords)))
+	{
+		ILog::report("ICompact::createPolytope: failed with memory allocation\n");
+		delete box;
+		return nullptr;
+	}
+	if (polytope->initSampling() != ERR_OK)
+	{
+		ILog::report("ICompact::createPolytope: failed to get sampling of bounding box\n");
+		delete polytope;
+		return nullptr;
+	}
+	if (polytope->findFeasiblePoint(polytope->_lastPoint) != ERR_OK)
+	{
+		ILog::report("ICompact::createPolytope: polytope is empty\n");
+		delete polytope;
+		return nullptr;
+	}
+	return polytope;
+}// end factory method
+
+Polytope::Polytope(ICompact *box, QVector<double> const &begin, QVector<double> const &end, QVector<double> const &normals, QVector<double> const &offsets)
+	: _begin(begin), _end(end), _normals(normals), _offsets(offsets)
+{
+	_box = box;
+	_dim = begin.size();
+	_rows = offsets.size();
+}
+
+Polytope::~Polytope()
+{
+	// iterators refer to the box, so they go first
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		delete _iterators[i];
+	}
+	delete _box;
+}
+
+ICompact* Polytope::clone() const
+{
+	ICompact *box = _box->clone();
+	Polytope *polytope;
+	if (!box)
+	{
+		ILog::report("ICompact::clone: failed to clone bounding box\n");
+		return nullptr;
+	}
+	if (!(polytope = new(std::nothrow) Polytope(box, _begin, _end, _normals, _offsets)))
+	{
+		ILog::report("ICompact::clone: failed with memory allocation\n");
+		delete box;
+		return nullptr;
+	}
+	polytope->_samplingCounters = _samplingCounters;
+	polytope->_samplingValues = _samplingValues;
+	getWarmStart(polytope->_lastPoint, polytope->_workingSet);
+	return polytope;
+}
+
+int Polytope::getId() const
+{
+	return ICompact::INTERFACE_1;
+}
+
+unsigned Polytope::getConstraintsAmount() const
+{
+	return _rows + 2 * _dim;
+}
+
+double Polytope::constraintProduct(unsigned k, double const *x) const
+{
+	double res = 0.0;
+	if (k < _rows)
+	{
+		double const *normal = _normals.constData() + k * _dim;
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			res += normal[i] * x[i];
+		}
+		return res;
+	}
+	k -= _rows;
+	return k < _dim ? x[k] : -x[k - _dim];
+}
+
+double Polytope::constraintOffset(unsigned k) const
+{
+	if (k < _rows)
+	{
+		return _offsets[k];
+	}
+	k -= _rows;
+	return k < _dim ? _end[k] : -_begin[k - _dim];
+}
+
+// x += scalar * (row of constraint k)
+void Polytope::addConstraintRow(unsigned k, double scalar, double *x) const
+{
+	if (k < _rows)
+	{
+		double const *normal = _normals.constData() + k * _dim;
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			x[i] += scalar * normal[i];
+		}
+		return;
+	}
+	k -= _rows;
+	if (k < _dim)
+	{
+		x[k] += scalar;
+	}
+	else
+	{
+		x[k - _dim] -= scalar;
+	}
+}
+
+bool Polytope::isFeasible(double const *point) const
+{
+	for (unsigned k = 0; k < getConstraintsAmount(); k++)
+	{
+		if (constraintProduct(k, point) > constraintOffset(k) + DOUBLE_EPS)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Dykstra's alternating projections from the center of box
+int Polytope::findFeasiblePoint(QVector<double> &point) const
+{
+	QVector<double> increments(static_cast<int>((_rows + 1) * _dim), 0.0), prev(static_cast<int>(_dim));
+	point.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		point[i] = (_begin[i] + _end[i]) / 2.0;
+	}
+	for (unsigned sweep = 0; sweep < MAX_DYKSTRA_SWEEPS; sweep++)
+	{
+		if (isFeasible(point.constData()))
+		{
+			return ERR_OK;
+		}
+		for (unsigned k = 0; k <= _rows; k++)
+		{
+			double *increment = increments.data() + k * _dim;
+			for (unsigned i = 0; i < _dim; i++)
+			{
+				prev[i] = point[i] + increment[i];
+			}
+			if (k < _rows)
+			{
+				double normSquare = 0.0, excess = constraintProduct(k, prev.constData()) - _offsets[k];
+				double const *normal = _normals.constData() + k * _dim;
+				for (unsigned i = 0; i < _dim; i++)
+				{
+					normSquare += normal[i] * normal[i];
+				}
+				for (unsigned i = 0; i < _dim; i++)
+				{
+					point[i] = excess > 0.0 ? prev[i] - excess / normSquare * normal[i] : prev[i];
+				}
+			}
+			else
+			{
+				for (unsigned i = 0; i < _dim; i++)
+				{
+					point[i] = std::min(std::max(prev[i], _begin[i]), _end[i]);
+				}
+			}
+			for (unsigned i = 0; i < _dim; i++)
+			{
+				increment[i] = prev[i] - point[i];
+			}
+		}
+	}
+	ILog::report("findFeasiblePoint: failed to find point in polytope\n");
+	return ERR_ANY_OTHER;
+}// end findFeasiblePoint
+
+void Polytope::getWarmStart(QVector<double> &point, QVector<int> &workingSet) const
+{
+	QMutexLocker locker(&_warmStartMutex);
+	point = _lastPoint;
+	workingSet = _workingSet;
+}
+
+void Polytope::setWarmStart(QVector<double> const &point, QVector<int> const &workingSet) const
+{
+	QMutexLocker locker(&_warmStartMutex);
+	_lastPoint = point;
+	_workingSet = workingSet;
+}
+
+/* Euclidean projection by primal active-set method: as the Hessian is identity,
+   every iteration only solves the small system (G_W G_W^T) lambda = G_W (vec - x)
+   of active constraints W. Iterations start from the previous projection and its
+   active set, so successive projections of close points take a few iterations. */
+int Polytope::project(double const *vec, QVector<double> &result) const
+{
+	unsigned constraints = getConstraintsAmount(), maxIterations = MAX_ACTIVE_SET_ITERATIONS_FACTOR * constraints + _dim;
+	QVector<double> x, dir(static_cast<int>(_dim)), rowI(static_cast<int>(_dim)), rowJ(static_cast<int>(_dim));
+	QVector<double> gram, lambda;
+	QVector<int> working, workingSet;
+
+	getWarmStart(x, workingSet);
+	for (int i = 0; i < workingSet.size(); i++)
+	{
+		unsigned k = workingSet[i];
+		if (fabs(constraintProduct(k, x.constData()) - constraintOffset(k)) <= DOUBLE_EPS)
+		{
+			working.append(k);
+		}
+	}
+
+	for (unsigned iteration = 0; iteration < maxIterations; iteration++)
+	{
+		int active = working.size();
+		// Cholesky factorization of Gram matrix of active constraints
+		gram.fill(0.0, active * active);
+		lambda.resize(active);
+		for (int i = 0; i < active; i++)
+		{
+			rowI.fill(0.0);
+			addConstraintRow(working[i], 1.0, rowI.data());
+			for (int j = 0; j <= i; j++)
+			{
+				gram[i * active + j] = constraintProduct(working[j], rowI.constData());
+			}
+		}
+		for (int i = 0; i < active; i++)
+		{
+			for (int j = 0; j <= i; j++)
+			{
+				double sum = gram[i * active + j];
+				for (int l = 0; l < j; l++)
+				{
+					sum -= gram[i * active + l] * gram[j * active + l];
+				}
+				if (i == j)
+				{
+					if (sum <= SOLVER_EPS)
+					{
+						ILog::report("project: active constraints are linearly dependent\n");
+						return ERR_ANY_OTHER;
+					}
+					gram[i * active + i] = sqrt(sum);
+				}
+				else
+				{
+					gram[i * active + j] = sum / gram[j * active + j];
+				}
+			}
+		}
+		// lambda = (G_W G_W^T)^-1 G_W (vec - x), dir = (vec - x) - G_W^T lambda
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			dir[i] = vec[i] - x[i];
+		}
+		for (int i = 0; i < active; i++)
+		{
+			double sum = constraintProduct(working[i], dir.constData());
+			for (int l = 0; l < i; l++)
+			{
+				sum -= gram[i * active + l] * lambda[l];
+			}
+			lambda[i] = sum / gram[i * active + i];
+		}
+		for (int i = active - 1; i >= 0; i--)
+		{
+			double sum = lambda[i];
+			for (int l = i + 1; l < active; l++)
+			{
+				sum -= gram[l * active + i] * lambda[l];
+			}
+			lambda[i] = sum / gram[i * active + i];
+		}
+		double dirNorm = 0.0;
+		for (int i = 0; i < active; i++)
+		{
+			addConstraintRow(working[i], -lambda[i], dir.data());
+		}
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			dirNorm = std::max(dirNorm, fabs(dir[i]));
+		}
+
+		if (dirNorm <= SOLVER_EPS * (1.0 + fabs(vec[0]) + fabs(x[0])))
+		{
+			// x minimizes over active constraints: optimal if all multipliers are nonnegative
+			int worst = -1;
+			for (int i = 0; i < active; i++)
+			{
+				if (lambda[i] < -SOLVER_EPS && (worst < 0 || lambda[i] < lambda[worst]))
+				{
+					worst = i;
+				}
+			}
+			if (worst < 0)
+			{
+				result = x;
+				setWarmStart(x, working);
+				return ERR_OK;
+			}
+			working.remove(worst);
+			continue;
+		}
+
+		// step along dir until the first blocking constraint
+		double alpha = 1.0;
+		int blocking = -1;
+		for (unsigned k = 0; k < constraints; k++)
+		{
+			if (working.contains(k))
+			{
+				continue;
+			}
+			double product = constraintProduct(k, dir.constData());
+			if (product > SOLVER_EPS)
+			{
+				double t = (constraintOffset(k) - constraintProduct(k, x.constData())) / product;
+				if (t < alpha)
+				{
+					alpha = std::max(t, 0.0);
+					blocking = k;
+				}
+			}
+		}
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			x[i] += alpha * dir[i];
+		}
+		if (blocking >= 0)
+		{
+			working.append(blocking);
+		}
+	}
+	ILog::report("project: too many iterations of active-set method\n");
+	return ERR_ANY_OTHER;
+}// end project
+
+int Polytope::getNearestNeighbor(IVector const* vec, IVector *& nn) const
+{
+	return getProjection(vec, PROJECTION_LATTICE, nn);
+}
+
+// lattice projection snaps continuous one to the sampling of box
+int Polytope::getProjection(IVector const* vec, ProjectionType type, IVector *& nn) const
+{
+	unsigned dim;
+	double const *coords;
+	QVector<double> projection;
+	QVector<unsigned> counters;
+	IVector *neighbor;
+	int errCode;
+	if (!vec)
+	{
+		ILog::report("ICompact::getProjection: nullptr in 'vec' param\n");
+		return ERR_WRONG_ARG;
+	}
+	if (vec->getDim() != _dim)
+	{
+		ILog::report("ICompact::getProjection: dimensions mismatch in 'vec' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+	if (type != PROJECTION_LATTICE && type != PROJECTION_CONTINUOUS)
+	{
+		ILog::report("ICompact::getProjection: wrong projection type\n");
+		return ERR_WRONG_ARG;
+	}
+	if ((errCode = vec->getCoordsPtr(dim, coords)) != ERR_OK)
+	{
+		ILog::report("ICompact::getProjection: failed to get coords from 'vec'\n");
+		return errCode;
+	}
+	if ((errCode = project(coords, projection)) != ERR_OK)
+	{
+		ILog::report("ICompact::getProjection: failed to project 'vec' onto polytope\n");
+		return errCode;
+	}
+	if (type == PROJECTION_LATTICE)
+	{
+		if ((errCode = snapToLattice(coords, projection, counters)) != ERR_OK)
+		{
+			ILog::report("ICompact::getProjection: no sampling points in polytope\n");
+			return errCode;
+		}
+		getLatticePoint(counters, projection);
+	}
+	if (!(neighbor = IVector::createVector(_dim, projection.constData())))
+	{
+		ILog::report("ICompact::getProjection: failed to create neighbor\n");
+		return ERR_MEMORY_ALLOCATION;
+	}
+	nn = neighbor;
+	return ERR_OK;
+}// end getProjection
+
+int Polytope::isContains(IVector const* const vec, bool& result) const
+{
+	unsigned dim;
+	double const *coords;
+	if (!vec)
+	{
+		ILog::report("ICompact::isContains: nullptr in 'vec' param\n");
+		return ERR_WRONG_ARG;
+	}
+	if (vec->getDim() != _dim)
+	{
+		ILog::report("ICompact::isContains: dimensions mismatch in 'vec' param\n");
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+	if (vec->getCoordsPtr(dim, coords) != ERR_OK)
+	{
+		ILog::report("ICompact::isContains: failed to get coords from 'vec'\n");
+		return ERR_ANY_OTHER;
+	}
+	result = isFeasible(coords);
+	return ERR_OK;
+}
+
+// only the sufficient check is supported: bounding box is a subset of 'other'
+int Polytope::isSubSet(ICompact const* const other, bool& result) const
+{
+	int errCode = _box->isSubSet(other, result);
+	if (errCode != ERR_OK)
+	{
+		ILog::report("ICompact::isSubSet: failed to compare bounding box of polytope\n");
+		return errCode;
+	}
+	if (!result)
+	{
+		ILog::report("ICompact::isSubSet: ERR_NOT_IMPLEMENTED for polytope out of 'other'\n");
+		return ERR_NOT_IMPLEMENTED;
+	}
+	return ERR_OK;
+}
+
+// supported for boxes only: polytope cut by 'other' box must be nonempty
+int Polytope::isIntersects(ICompact const* const other, bool& result) const
+{
+	QVector<double> begin, end, point;
+	int errCode;
+	if ((errCode = getBoxCorners(other, begin, end)) != ERR_OK)
+	{
+		ILog::report("ICompact::isIntersects: failed to get box of 'other'\n");
+		return errCode;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		begin[i] = std::max(begin[i], _begin[i]);
+		end[i] = std::min(end[i], _end[i]);
+		if (begin[i] > end[i] + DOUBLE_EPS)
+		{
+			result = false;
+			return ERR_OK;
+		}
+	}
+	Polytope cut(nullptr, begin, end, _normals, _offsets);
+	result = cut.findFeasiblePoint(point) == ERR_OK;
+	return ERR_OK;
+}
+
+int Polytope::getBoundingBox(IVector *& begin, IVector *& end) const
+{
+	return _box->getBoundingBox(begin, end);
+}
+
+// intersection with box keeps polytope, other operations aren't supported
+int Polytope::Intersection(ICompact const& c)
+{
+	QVector<double> begin, end, point;
+	ICompact *box;
+	int errCode;
+	if (!_iterators.isEmpty())
+	{
+		ILog::report("ICompact::Intersection: polytope can't be changed while it has iterators\n");
+		return ERR_WRONG_ARG;
+	}
+	if ((errCode = getBoxCorners(&c, begin, end)) != ERR_OK)
+	{
+		ILog::report("ICompact::Intersection: failed to get box of 'c'\n");
+		return errCode;
+	}
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		begin[i] = std::max(begin[i], _begin[i]);
+		end[i] = std::min(end[i], _end[i]);
+		if (begin[i] > end[i] + DOUBLE_EPS)
+		{
+			ILog::report("ICompact::Intersection: result of operation is empty\n");
+			return ERR_WRONG_ARG;
+		}
+		end[i] = std::max(begin[i], end[i]);
+	}
+	Polytope cut(nullptr, begin, end, _normals, _offsets);
+	if (cut.findFeasiblePoint(point) != ERR_OK)
+	{
+		ILog::report("ICompact::Intersection: result of operation is empty\n");
+		return ERR_WRONG_ARG;
+	}
+	if (!(box = ICompact::Intersection(_box, &c)))
+	{
+		ILog::report("ICompact::Intersection: failed to intersect bounding boxes\n");
+		return ERR_ANY_OTHER;
+	}
+	delete _box;
+	_box = box;
+	_begin = begin;
+	_end = end;
+	setWarmStart(point, QVector<int>());
+	return initSampling();
+}// end Intersection
+
+// 'compact' must be a box: its bounding box must be a subset of it
+int Polytope::getBoxCorners(ICompact const *compact, QVector<double> &begin, QVector<double> &end) const
+{
+	IVector *beginVec = nullptr, *endVec = nullptr;
+	ICompact *bounds;
+	bool isBox = false;
+	int errCode;
+	if (!compact)
+	{
+		return ERR_WRONG_ARG;
+	}
+	// compacts of INTERFACE_0 have no bounding box
+	if (compact->getId() < ICompact::INTERFACE_1)
+	{
+		ILog::report("getBoxCorners: compact of INTERFACE_0 isn't supported\n");
+		return ERR_NOT_IMPLEMENTED;
+	}
+	if ((errCode = compact->getBoundingBox(beginVec, endVec)) != ERR_OK)
+	{
+		return errCode;
+	}
+	if (beginVec->getDim() != _dim)
+	{
+		delete beginVec;
+		delete endVec;
+		return ERR_DIMENSIONS_MISMATCH;
+	}
+	if (!(bounds = ICompact::createCompact(beginVec, endVec)) || (errCode = bounds->isSubSet(compact, isBox)) != ERR_OK || !isBox)
+	{
+		ILog::report("getBoxCorners: only boxes are supported\n");
+		delete bounds;
+		delete beginVec;
+		delete endVec;
+		return ERR_NOT_IMPLEMENTED;
+	}
+	delete bounds;
+	begin.resize(static_cast<int>(_dim));
+	end.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		beginVec->getCoord(i, begin[i]);
+		endVec->getCoord(i, end[i]);
+	}
+	delete beginVec;
+	delete endVec;
+	return ERR_OK;
+}// end getBoxCorners
+
+// default iterators start from the extreme lattice point found directly,
+// iterators with non-default step walk from the "bottom-left" corner of box
+Polytope::PolytopeIterator* Polytope::createIterator(IVector const *step, bool toEnd)
+{
+	PolytopeIterator *iterator;
+	IVector *stepClone = nullptr;
+	QVector<unsigned> counters;
+	if (step && (step->getDim() != _dim || !(stepClone = step->clone())))
+	{
+		ILog::report("createIterator: not correct 'step' param\n");
+		return nullptr;
+	}
+	if (!step && findLatticePoint(toEnd, nullptr, counters) != ERR_OK)
+	{
+		ILog::report("createIterator: no sampling points in polytope\n");
+		return nullptr;
+	}
+	if (!(iterator = new(std::nothrow) PolytopeIterator(this, nullptr, stepClone)))
+	{
+		ILog::report("createIterator: failed with memory allocation\n");
+		delete stepClone;
+		return nullptr;
+	}
+	if (step)
+	{
+		counters.fill(0, static_cast<int>(_dim));
+	}
+	iterator->_counters = counters;
+	getLatticePoint(counters, iterator->_point);
+	if (step && !isFeasible(iterator->_point.constData()) && iterator->doStep() != ERR_OK)
+	{
+		ILog::report("createIterator: no sampling points in polytope\n");
+		delete iterator;
+		return nullptr;
+	}
+	// the last point reached by non-default step is found by walking
+	while (step && toEnd && iterator->doStep() == ERR_OK)
+	{
+	}
+	_iterators.append(iterator);
+	return iterator;
+}// end createIterator
+
+Polytope::PolytopeIterator* Polytope::createSequenceIterator(IIterator *boxIterator)
+{
+	PolytopeIterator *iterator;
+	IVector *point = nullptr;
+	bool contains = false;
+	if (!boxIterator)
+	{
+		return nullptr;
+	}
+	if (!(iterator = new(std::nothrow) PolytopeIterator(this, boxIterator, nullptr)))
+	{
+		ILog::report("createSequenceIterator: failed with memory allocation\n");
+		_box->deleteIterator(boxIterator);
+		return nullptr;
+	}
+	// move to the first point of polytope
+	if (_box->getByIterator(boxIterator, point) == ERR_OK && isContains(point, contains) == ERR_OK && contains)
+	{
+		iterator->_current = point;
+	}
+	else
+	{
+		delete point;
+		if (iterator->doStep() != ERR_OK)
+		{
+			ILog::report("createSequenceIterator: no sequence points in polytope\n");
+			delete iterator;
+			return nullptr;
+		}
+	}
+	_iterators.append(iterator);
+	return iterator;
+}// end createSequenceIterator
+
+ICompact::IIterator* Polytope::begin(IVector const* const step)
+{
+	IIterator *iterator = createIterator(step, false);
+	if (!iterator)
+	{
+		ILog::report("ICompact::begin: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+ICompact::IIterator* Polytope::end(IVector const* const step)
+{
+	IIterator *iterator = createIterator(step, true);
+	if (!iterator)
+	{
+		ILog::report("ICompact::end: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+ICompact::IIterator* Polytope::beginSequence(SequenceType type, unsigned first, unsigned stride)
+{
+	IIterator *iterator = createSequenceIterator(_box->beginSequence(type, first, stride));
+	if (!iterator)
+	{
+		ILog::report("ICompact::beginSequence: failed to create iterator\n");
+	}
+	return iterator;
+}
+
+int Polytope::getByIterator(IIterator const* pIter, IVector*& pItem) const
+{
+	IVector *point;
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::getByIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	if (!(point = _iterators[index]->getPoint()))
+	{
+		ILog::report("ICompact::getByIterator: failed to create point\n");
+		return ERR_MEMORY_ALLOCATION;
+	}
+	pItem = point;
+	return ERR_OK;
+}
+
+int Polytope::deleteIterator(IIterator * pIter)
+{
+	int index = findIterator(pIter);
+	if (index < 0)
+	{
+		ILog::report("ICompact::deleteIterator: failed to find iterator\n");
+		return ERR_WRONG_ARG;
+	}
+	delete _iterators[index];
+	_iterators.removeAt(index);
+	return ERR_OK;
+}
+
+int Polytope::findIterator(IIterator const *iterator) const
+{
+	for (int i = 0; i < _iterators.count(); i++)
+	{
+		if (iterator == dynamic_cast<IIterator*>(_iterators[i]))
+		{
+			return i;
+		}
+	}
+	ILog::report("findIterator: no iterator found\n");
+	return -1;
+}
+
+Polytope::PolytopeIterator::PolytopeIterator(Polytope const *polytope, IIterator *boxIterator, IVector *step) : IIterator(polytope, 0, step)
+{
+	_polytope = polytope;
+	_boxIterator = boxIterator;
+	_current = nullptr;
+	_step = step;
+}
+
+Polytope::PolytopeIterator::~PolytopeIterator()
+{
+	if (_boxIterator)
+	{
+		_polytope->_box->deleteIterator(_boxIterator);
+	}
+	delete _current;
+	delete _step;
+}
+
+int Polytope::PolytopeIterator::setStep(IVector const* const step)
+{
+	IVector *tmp = nullptr;
+	if (_boxIterator)
+	{
+		return _boxIterator->setStep(step);
+	}
+	if (step && (step->getDim() != _polytope->_dim || !(tmp = step->clone())))
+	{
+		ILog::report("ICompact::IIterator::setStep: not correct 'step' param\n");
+		return ERR_WRONG_ARG;
+	}
+	delete _step;
+	_step = tmp;
+	return ERR_OK;
+}
+
+IVector* Polytope::PolytopeIterator::getPoint() const
+{
+	if (_boxIterator)
+	{
+		return _current->clone();
+	}
+	QVector<double> point;
+	_polytope->getLatticePoint(_counters, point);
+	return IVector::createVector(_polytope->_dim, point.constData());
+}
+
+int Polytope::PolytopeIterator::doStep()
+{
+	return _boxIterator ? doBoxStep() : doLatticeStep();
+}
+
+/* default step goes to the next lattice point of box and checks it without allocations;
+   when it is out of polytope, the next point of polytope is found by search over slices */
+int Polytope::PolytopeIterator::doLatticeStep()
+{
+	unsigned dim = _polytope->_dim;
+	if (!_step)
+	{
+		int axis = static_cast<int>(dim) - 1;
+		_next = _counters;
+		while (axis >= 0 && ++_next[axis] == _polytope->_samplingCounters[axis])
+		{
+			_next[axis--] = 0;
+		}
+		if (axis >= 0)
+		{
+			_polytope->getLatticePoint(_next, _point);
+			if (_polytope->isFeasible(_point.constData()))
+			{
+				std::swap(_counters, _next);
+				return ERR_OK;
+			}
+		}
+		if (_polytope->findLatticePoint(false, &_counters, _next) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::doStep: step out of range (default behavour)\n");
+			return ERR_OUT_OF_RANGE;
+		}
+		std::swap(_counters, _next);
+		return ERR_OK;
+	}
+	// non-default step moves to the nearest lattice point of box until it gets into polytope
+	unsigned stepDim;
+	double const *step;
+	_step->getCoordsPtr(stepDim, step);
+	_polytope->getLatticePoint(_counters, _point);
+	for (;;)
+	{
+		for (unsigned i = 0; i < dim; i++)
+		{
+			_point[i] += step[i];
+		}
+		_polytope->snapToBox(_point.constData(), _next);
+		if (_next == _counters)
+		{
+			ILog::report("ICompact::IIterator::doStep: step out of range (non-default behavour)\n");
+			return ERR_OUT_OF_RANGE;
+		}
+		std::swap(_counters, _next);
+		_polytope->getLatticePoint(_counters, _point);
+		if (_polytope->isFeasible(_point.constData()))
+		{
+			return ERR_OK;
+		}
+	}
+}// end doLatticeStep
+
+int Polytope::PolytopeIterator::doBoxStep()
+{
+	IVector *point;
+	bool contains = false;
+	int errCode;
+	while ((errCode = _boxIterator->doStep()) == ERR_OK)
+	{
+		point = nullptr;
+		if ((errCode = _polytope->_box->getByIterator(_boxIterator, point)) != ERR_OK ||
+			(errCode = _polytope->isContains(point, contains)) != ERR_OK)
+		{
+			ILog::report("ICompact::IIterator::doStep: failed to check point of bounding box\n");
+			delete point;
+			return errCode;
+		}
+		if (contains)
+		{
+			delete _current;
+			_current = point;
+			return ERR_OK;
+		}
+		delete point;
+	}
+	return errCode;
+}// end doBoxStep
+
+// lattice of box is read through its indices: the index of "begin" moved to "end" along an axis
+// is (amount of points by the axis - 1) * (product of amounts by the next axes)
+int Polytope::initSampling()
+{
+	QVector<double> corner = _begin;
+	unsigned index, stride = 1;
+	IVector *vec;
+	int errCode;
+	_samplingCounters.fill(1, static_cast<int>(_dim));
+	_samplingValues.fill(0.0, static_cast<int>(_dim));
+	for (unsigned i = _dim; i > 0; i--)
+	{
+		corner[i - 1] = _end[i - 1];
+		if (!(vec = IVector::createVector(_dim, corner.constData())))
+		{
+			return ERR_MEMORY_ALLOCATION;
+		}
+		errCode = _box->getIndexByPoint(vec, index);
+		delete vec;
+		if (errCode != ERR_OK)
+		{
+			return errCode;
+		}
+		corner[i - 1] = _begin[i - 1];
+		_samplingCounters[i - 1] = index / stride + 1;
+		if (_samplingCounters[i - 1] > 1)
+		{
+			_samplingValues[i - 1] = (_end[i - 1] - _begin[i - 1]) / (_samplingCounters[i - 1] - 1);
+		}
+		stride *= _samplingCounters[i - 1];
+	}
+	return ERR_OK;
+}// end initSampling
+
+void Polytope::getLatticePoint(QVector<unsigned> const &counters, QVector<double> &point) const
+{
+	point.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		point[i] = _begin[i] + counters[i] * _samplingValues[i];
+	}
+}
+
+// nearest lattice point of box
+void Polytope::snapToBox(double const *point, QVector<unsigned> &counters) const
+{
+	counters.resize(static_cast<int>(_dim));
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		double k = _samplingCounters[i] > 1 ? round((point[i] - _begin[i]) / _samplingValues[i]) : 0.0;
+		counters[i] = static_cast<unsigned>(std::min(std::max(k, 0.0), _samplingCounters[i] - 1.0));
+	}
+}
+
+/* the nearest to 'vec' corner of lattice cell of 'projection' lying in polytope, or the nearest
+   lattice point of box if dim is too big for all corners; polytope thinner than the sampling
+   may have no such points, then its first lattice point is taken */
+int Polytope::snapToLattice(double const *vec, QVector<double> const &projection, QVector<unsigned> &result) const
+{
+	QVector<unsigned> low, counters;
+	QVector<double> point;
+	double bestDist = -1.0;
+	unsigned corners = _dim <= MAX_CELL_CORNERS_DIM ? 1u << _dim : 1u;
+	snapToBox(projection.constData(), low);
+	if (corners > 1)
+	{
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			double k = _samplingCounters[i] > 1 ? floor((projection[i] - _begin[i]) / _samplingValues[i]) : 0.0;
+			low[i] = static_cast<unsigned>(std::min(std::max(k, 0.0), std::max(_samplingCounters[i] - 2.0, 0.0)));
+		}
+	}
+	for (unsigned corner = 0; corner < corners; corner++)
+	{
+		counters = low;
+		for (unsigned i = 0; i < _dim && corners > 1; i++)
+		{
+			counters[i] = std::min(counters[i] + ((corner >> i) & 1u), _samplingCounters[i] - 1);
+		}
+		getLatticePoint(counters, point);
+		if (!isFeasible(point.constData()))
+		{
+			continue;
+		}
+		double dist = 0.0;
+		for (unsigned i = 0; i < _dim; i++)
+		{
+			dist += (point[i] - vec[i]) * (point[i] - vec[i]);
+		}
+		if (bestDist < 0.0 || dist < bestDist)
+		{
+			bestDist = dist;
+			result = counters;
+		}
+	}
+	if (bestDist < 0.0)
+	{
+		return findLatticePoint(false, nullptr, result);
+	}
+	return ERR_OK;
+}// end snapToLattice
+
+// lattice point of polytope with the smallest or the biggest index, or the smallest index after 'after';
+// ERR_OUT_OF_RANGE if there is no such point
+int Polytope::findLatticePoint(bool last, QVector<unsigned> const *after, QVector<unsigned> &counters) const
+{
+	QVector<double> begin, end, normals, offsets, point, feasible;
+	QVector<int> workingSet;
+	if (!after)
+	{
+		Polytope whole(nullptr, _begin, _end, _normals, _offsets);
+		counters.fill(0, static_cast<int>(_dim));
+		// warm start is a projection, so it is a point of polytope
+		getWarmStart(feasible, workingSet);
+		return searchLattice(whole, 0, feasible, last, 0, counters) ? ERR_OK : ERR_OUT_OF_RANGE;
+	}
+	// the next point keeps the longest prefix of counters of 'after'
+	getLatticePoint(*after, point);
+	for (unsigned axis = _dim; axis > 0; axis--)
+	{
+		if (!getSlice(point.constData(), axis - 1, begin, end, normals, offsets))
+		{
+			continue;
+		}
+		Polytope slice(nullptr, begin, end, normals, offsets);
+		feasible.resize(static_cast<int>(_dim - axis + 1));
+		std::copy(point.constData() + axis - 1, point.constData() + _dim, feasible.data());
+		counters = *after;
+		if (searchLattice(slice, axis - 1, feasible, false, (*after)[axis - 1] + 1, counters))
+		{
+			return ERR_OK;
+		}
+	}
+	return ERR_OUT_OF_RANGE;
+}// end findLatticePoint
+
+/* depth-first search of extreme lattice point of 'slice' (polytope over axes from 'axis' on,
+   'feasible' is its point): range of the first axis over the slice is found by projections,
+   its lattice values are tried from the extreme one, as the slice by every value from the range
+   is nonempty (polytope is convex), so backtracking happens only when a slice has no lattice points */
+bool Polytope::searchLattice(Polytope const &slice, unsigned axis, QVector<double> const &feasible, bool last, unsigned from,
+							 QVector<unsigned> &counters) const
+{
+	QVector<double> low, high, rest, begin, end, normals, offsets, point;
+	if (axis == _dim)
+	{
+		getLatticePoint(counters, point);
+		return isFeasible(point.constData());
+	}
+	if (slice.findAxisExtreme(feasible, false, low) != ERR_OK || slice.findAxisExtreme(feasible, true, high) != ERR_OK)
+	{
+		return false;
+	}
+	double base = _begin[axis], spacing = _samplingValues[axis], first = 0.0, final = 0.0;
+	if (_samplingCounters[axis] > 1)
+	{
+		first = std::max(ceil((low[0] - base - DOUBLE_EPS) / spacing), 0.0);
+		final = std::min(floor((high[0] - base + DOUBLE_EPS) / spacing), _samplingCounters[axis] - 1.0);
+	}
+	first = std::max(first, static_cast<double>(from));
+	rest.resize(low.size() - 1);
+	for (double i = 0.0; first + i <= final; i++)
+	{
+		unsigned k = static_cast<unsigned>(last ? final - i : first + i);
+		double value = base + k * spacing, width = high[0] - low[0];
+		double share = width > SOLVER_EPS ? std::min(std::max((value - low[0]) / width, 0.0), 1.0) : 0.0;
+		for (int j = 1; j < low.size(); j++)
+		{
+			rest[j - 1] = low[j] + share * (high[j] - low[j]);
+		}
+		if (!slice.getSlice(&value, 1, begin, end, normals, offsets))
+		{
+			continue;
+		}
+		Polytope next(nullptr, begin, end, normals, offsets);
+		counters[axis] = k;
+		if (searchLattice(next, axis + 1, rest, last, 0, counters))
+		{
+			return true;
+		}
+	}
+	return false;
+}// end searchLattice
+
+/* point with the smallest or the biggest first coordinate: projections of points moved far along
+   the first axis from the current one stop moving at the face where the coordinate is extreme */
+int Polytope::findAxisExtreme(QVector<double> const &feasible, bool biggest, QVector<double> &result) const
+{
+	QVector<double> far;
+	double shift = 1.0, prev;
+	int errCode;
+	for (unsigned i = 0; i < _dim; i++)
+	{
+		shift += _end[i] - _begin[i];
+	}
+	shift *= biggest ? FAR_SHIFT_FACTOR : -FAR_SHIFT_FACTOR;
+	setWarmStart(feasible, QVector<int>());
+	result = feasible;
+	for (unsigned step = 0; step < MAX_EXTREME_STEPS; step++)
+	{
+		far = result;
+		far[0] += shift;
+		prev = result[0];
+		if ((errCode = project(far.constData(), result)) != ERR_OK)
+		{
+			return errCode;
+		}
+		if (fabs(result[0] - prev) <= SOLVER_EPS * (1.0 + fabs(prev)))
+		{
+			break;
+		}
+	}
+	return ERR_OK;
+}// end findAxisExtreme
+
+// polytope of points with the first 'count' coordinates equal to 'values', over the rest of coordinates;
+// false if a half-space not depending on the rest of coordinates excludes 'values'
+bool Polytope::getSlice(double const *values, unsigned count, QVector<double> &begin, QVector<double> &end,
+						QVector<double> &normals, QVector<double> &offsets) const
+{
+	begin.resize(static_cast<int>(_dim - count));
+	end.resize(static_cast<int>(_dim - count));
+	std::copy(_begin.constData() + count, _begin.constData() + _dim, begin.data());
+	std::copy(_end.constData() + count, _end.constData() + _dim, end.data());
+	normals.clear();
+	offsets.clear();
+	for (unsigned k = 0; k < _rows; k++)
+	{
+		double const *normal = _normals.constData() + k * _dim;
+		double offset = _offsets[k], norm = 0.0;
+		for (unsigned i = 0; i < count; i++)
+		{
+			offset -= normal[i] * values[i];
+		}
+		for (unsigned i = count; i < _dim; i++)
+		{
+			norm = std::max(norm, fabs(normal[i]));
+		}
+		if (norm <= DOUBLE_EPS)
+		{
+			if (offset < -DOUBLE_EPS)
+			{
+				return false;
+			}
+			continue;
+		}
+		for (unsigned i = count; i < _dim; i++)
+		{
+			normals.append(normal[i]);
+		}
+		offsets.append(offset);
+	}
+	return true;
+}// end getSlice
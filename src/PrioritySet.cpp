@@ -0,0 +1,387 @@
+#include <QVector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "IPrioritySet.h"
+#include "error.h"
+#include "ILog.h"
+#include "SetIterators.h"
+
+namespace {
+    const double PRIORITY_EPS = 1e-8;
+
+    /*orders slots by their values*/
+    class ValueLess
+    {
+    public:
+        ValueLess(QVector<double> const& values): _values(values) {}
+
+        bool operator()(unsigned int left, unsigned int right) const {
+            return _values[left] < _values[right];
+        }
+
+    private:
+        QVector<double> const& _values;
+    };
+
+    class PrioritySet : public IPrioritySet
+    {
+    public:
+        int getId() const;
+
+        int put(IVector const* const item);
+        int put(IVector const* const item, double value);
+        int get(unsigned int index, IVector*& pItem) const;
+        int remove(unsigned int index);
+        using ISet::remove;
+        int contains(IVector const* const pItem, bool& rc) const;
+        unsigned int getSize() const;
+        int clear();
+
+        int getValue(unsigned int index, double& value) const;
+        int getBest(IVector*& pItem, double& value) const;
+        unsigned int getCapacity() const;
+        int exportSorted(unsigned int bufferSize, double* coords, double* values) const;
+
+        int exportTo(unsigned int bufferSize, double* buffer) const;
+        int getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const;
+        int getData(unsigned int& count, unsigned int& dim, double const*& data) const;
+
+        IIterator* end();
+        IIterator* begin();
+
+        int deleteIterator(IIterator * pIter);
+        int getByIterator(IIterator const* pIter, IVector*& pItem) const;
+        int getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const;
+
+
+        /*ctor*/
+        PrioritySet(unsigned int dim, unsigned int capacity);
+        /*dtor*/
+        ~PrioritySet();
+
+    private:
+        void siftUp(unsigned int pos);
+        void siftDown(unsigned int pos);
+        void swapHeap(unsigned int left, unsigned int right);
+        void findBest();
+        double const* getPointCoords(unsigned int slot) const;
+
+        /*slots keep points and values, a point stays in its slot while it is in set*/
+        QVector<double> _coords;
+        QVector<double> _values;
+        /*max-heap of slots by value, so the worst point is pushed out in O(log K)*/
+        QVector<unsigned int> _heap;
+        QVector<unsigned int> _heapPos;
+        /*slot of the best point, kept on every put*/
+        unsigned int _best;
+        IndexIterators _iterators;
+        unsigned int _dim;
+        unsigned int _capacity;
+    };
+
+} //end anonymous namespace
+
+int PrioritySet::getId() const {
+    return ISet::INTERFACE_1;
+}
+
+IPrioritySet* IPrioritySet::createPrioritySet(unsigned int R_dim, unsigned int capacity) {
+    if (R_dim == 0) {
+        ILog::report("IPrioritySet.createPrioritySet: Can't create Set with zero dimension\n");
+        return NULL;
+    }
+    if (capacity == 0) {
+        ILog::report("IPrioritySet.createPrioritySet: Zero capacity\n");
+        return NULL;
+    }
+
+    IPrioritySet* set = new(std::nothrow) PrioritySet(R_dim, capacity);
+    if (!set) {
+        ILog::report("IPrioritySet.createPrioritySet: Not enough memory\n");
+        return NULL;
+    }
+    return set;
+}
+
+PrioritySet::PrioritySet(unsigned int dim, unsigned int capacity):
+    _best(0), _dim(dim), _capacity(capacity)
+{}
+
+PrioritySet::~PrioritySet() {
+}
+
+double const* PrioritySet::getPointCoords(unsigned int slot) const {
+    return _coords.constData() + slot * _dim;
+}
+
+void PrioritySet::swapHeap(unsigned int left, unsigned int right) {
+    std::swap(_heap[left], _heap[right]);
+    _heapPos[_heap[left]] = left;
+    _heapPos[_heap[right]] = right;
+}
+
+void PrioritySet::siftUp(unsigned int pos) {
+    while (pos > 0 && _values[_heap[(pos - 1) / 2]] < _values[_heap[pos]]) {
+        swapHeap(pos, (pos - 1) / 2);
+        pos = (pos - 1) / 2;
+    }
+}
+
+void PrioritySet::siftDown(unsigned int pos) {
+    unsigned int size = _heap.size();
+    for (;;) {
+        unsigned int largest = pos, left = 2 * pos + 1, right = 2 * pos + 2;
+        if (left < size && _values[_heap[largest]] < _values[_heap[left]])
+            largest = left;
+        if (right < size && _values[_heap[largest]] < _values[_heap[right]])
+            largest = right;
+        if (largest == pos)
+            return;
+        swapHeap(pos, largest);
+        pos = largest;
+    }
+}
+
+/*the best point is one of heap leaves, it is looked for only when the best one is removed*/
+void PrioritySet::findBest() {
+    _best = 0;
+    for (unsigned int i = 1; i < getSize(); i++) {
+        if (_values[i] < _values[_best])
+            _best = i;
+    }
+}
+
+int PrioritySet::put(IVector const* const item) {
+    ILog::report("IPrioritySet.put: Value of item is required\n");
+    return ERR_NOT_IMPLEMENTED;
+}
+
+int PrioritySet::put(IVector const* const item, double value) {
+    if (!item) {
+        ILog::report("IPrioritySet.put: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != item->getDim()) {
+        ILog::report("IPrioritySet.put: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+    if (value != value) {
+        ILog::report("IPrioritySet.put: Value is NaN\n");
+        return ERR_WRONG_ARG;
+    }
+
+    unsigned int dim;
+    double const* coords;
+    int errCode = item->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK) {
+        ILog::report("IPrioritySet.put: Can't get coordinates of input argument\n");
+        return errCode;
+    }
+
+    unsigned int slot = getSize();
+    if (slot < _capacity) {
+        _coords.resize((slot + 1) * _dim);
+        _values.append(value);
+        _heap.append(slot);
+        _heapPos.append(slot);
+        siftUp(slot);
+    }
+    else {
+        /*full set: new point takes slot of the worst one if it is better*/
+        slot = _heap[0];
+        if (!(value < _values[slot]))
+            return ERR_OK;
+        _iterators.erase(slot, slot);
+        _values[slot] = value;
+        siftDown(0);
+    }
+    memcpy(_coords.data() + slot * _dim, coords, _dim * sizeof(double));
+    /*pushed out worst point may be the best one only if new point is better than it*/
+    if (getSize() == 1 || slot == _best || value < _values[_best])
+        _best = slot;
+    return ERR_OK;
+}
+
+int PrioritySet::get(unsigned int index, IVector*& pItem) const {
+    if  (index >= getSize()) {
+        ILog::report("IPrioritySet.get: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    pItem = IVector::createVector(_dim, getPointCoords(index));
+    if (!pItem) {
+        ILog::report("IPrioritySet.get: Not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
+    return ERR_OK;
+}
+
+int PrioritySet::getValue(unsigned int index, double& value) const {
+    if  (index >= getSize()) {
+        ILog::report("IPrioritySet.getValue: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    value = _values[index];
+    return ERR_OK;
+}
+
+int PrioritySet::getBest(IVector*& pItem, double& value) const {
+    if (getSize() == 0) {
+        ILog::report("IPrioritySet.getBest: Set is empty\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    value = _values[_best];
+    return get(_best, pItem);
+}
+
+unsigned int PrioritySet::getCapacity() const {
+    return _capacity;
+}
+
+int PrioritySet::exportSorted(unsigned int bufferSize, double* coords, double* values) const {
+    if (!coords || !values) {
+        ILog::report("IPrioritySet.exportSorted: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if (bufferSize < (unsigned int)_coords.size()) {
+        ILog::report("IPrioritySet.exportSorted: Buffer is too small\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    QVector<unsigned int> order(_heap);
+    std::sort(order.begin(), order.end(), ValueLess(_values));
+    for (int i = 0; i < order.size(); i++) {
+        memcpy(coords + i * _dim, getPointCoords(order[i]), _dim * sizeof(double));
+        values[i] = _values[order[i]];
+    }
+    return ERR_OK;
+}
+
+/*last slot takes place of removed one*/
+int PrioritySet::remove(unsigned int index) {
+    if  (index >= getSize()) {
+        ILog::report("IPrioritySet.remove: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    unsigned int last = getSize() - 1, pos = _heapPos[index];
+    _iterators.erase(index, last);
+    swapHeap(pos, last);
+    _heap.resize(last);
+    if (pos < last) {
+        siftDown(pos);
+        siftUp(pos);
+    }
+    if (index != last) {
+        memcpy(_coords.data() + index * _dim, getPointCoords(last), _dim * sizeof(double));
+        _values[index] = _values[last];
+        _heap[_heapPos[last]] = index;
+        _heapPos[index] = _heapPos[last];
+    }
+    _coords.resize(last * _dim);
+    _values.resize(last);
+    _heapPos.resize(last);
+
+    if (_best == index)
+        findBest();
+    else if (_best == last)
+        _best = index;
+    return ERR_OK;
+}
+
+int PrioritySet::contains(IVector const* const pItem, bool& rc) const {
+    if (!pItem) {
+        ILog::report("IPrioritySet.contains: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if  (_dim != pItem->getDim()) {
+        ILog::report("IPrioritySet.contains: Input argument has another dimension\n");
+        return ERR_DIMENSIONS_MISMATCH;
+    }
+
+    unsigned int dim;
+    double const* coords;
+    int errCode = pItem->getCoordsPtr(dim, coords);
+    if (errCode != ERR_OK)
+        return errCode;
+
+    rc = false;
+    for (unsigned int i = 0; i < getSize() && !rc; i++) {
+        double const* point = getPointCoords(i);
+        rc = true;
+        for (unsigned int j = 0; j < _dim && rc; j++)
+            rc = std::fabs(point[j] - coords[j]) < PRIORITY_EPS;
+    }
+    return ERR_OK;
+}
+
+unsigned int PrioritySet::getSize() const {
+    return _values.size();
+}
+
+int PrioritySet::clear() {
+    _coords.clear();
+    _values.clear();
+    _heap.clear();
+    _heapPos.clear();
+    _best = 0;
+
+    _iterators.clear();
+
+    return ERR_OK;
+}
+
+int PrioritySet::exportTo(unsigned int bufferSize, double* buffer) const {
+    if (!buffer) {
+        ILog::report("IPrioritySet.exportTo: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+    if (bufferSize < (unsigned int)_coords.size()) {
+        ILog::report("IPrioritySet.exportTo: Buffer is too small\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    memcpy(buffer, _coords.constData(), _coords.size() * sizeof(double));
+    return ERR_OK;
+}
+
+int PrioritySet::getCoordsPtr(unsigned int index, unsigned int& dim, double const*& coords) const {
+    if  (index >= getSize()) {
+        ILog::report("IPrioritySet.getCoordsPtr: Wrong index (out of range)\n");
+        return ERR_OUT_OF_RANGE;
+    }
+
+    dim = _dim;
+    coords = getPointCoords(index);
+    return ERR_OK;
+}
+
+int PrioritySet::getData(unsigned int& count, unsigned int& dim, double const*& data) const {
+    count = getSize();
+    dim = _dim;
+    data = _coords.constData();
+    return ERR_OK;
+}
+
+PrioritySet::IIterator* PrioritySet::end() {
+    return _iterators.create(this, true);
+}
+
+PrioritySet::IIterator* PrioritySet::begin() {
+    return _iterators.create(this, false);
+}
+
+int PrioritySet::deleteIterator(IIterator * pIter) {
+    return _iterators.remove(pIter);
+}
+
+int PrioritySet::getByIterator(IIterator const* pIter, IVector*& pItem) const {
+    return _iterators.getByIterator(this, pIter, pItem);
+}
+
+int PrioritySet::getCoordsPtrByIterator(IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    return _iterators.getCoordsPtrByIterator(this, pIter, dim, coords);
+}
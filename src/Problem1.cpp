@@ -16,11 +16,30 @@ public:
     int goalFunction(IVector const* args, IVector const* params, double& res) const;
     int goalFunctionByArgs(IVector const*  args, double& res) const;
     int goalFunctionByParams(IVector const*  params, double& res) const;
+    int goalFunctionByArgsBatch(size_t count, double const* args, double* res) const;
+    int goalFunctionByParamsBatch(size_t count, double const* params, double* res) const;
+    int valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const;
+    int valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const;
+    int gradientByArgs(IVector const* args, IVector* grad) const;
+    int gradientByParams(IVector const* params, IVector* grad) const;
+    int hessianByArgs(IVector const* args, double* hessian) const;
+    int hessianByParams(IVector const* params, double* hessian) const;
+    int hessianVectorProductByArgs(IVector const* args, IVector const* vec, IVector* res) const;
+    int hessianVectorProductByParams(IVector const* params, IVector const* vec, IVector* res) const;
+    int getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const;
     int getArgsDim(size_t& dim) const;
     int getParamsDim(size_t& dim) const;
 
     int setParams(IVector const* params);
     int setArgs(IVector const* args);
+    int bindParams(double const* params, size_t dim);
+    int bindArgs(double const* args, size_t dim);
+    int paramsChanged();
+    int argsChanged();
+
+    bool isReentrant() const;
+    IProblem* createWorkerInstance() const;
+    int releaseWorkerInstance();
 
     int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
     int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const;
@@ -34,8 +53,23 @@ public:
 
 private:
 
+    static double argsPart(const double* a);
+    static double paramsPart(const double* p);
+    double fixedArgsPart() const;
+    double fixedParamsPart() const;
+    int getFixed(DerivedType dr, const double*& coords, const char* message) const;
+    int derivative(size_t order, size_t idx, DerivedType dr, double& value, const double* a, const double* p) const;
+    int hessian(IVector const* point, size_t dim, double* hessian, const char* message) const;
+    int hessianVectorProduct(IVector const* point, IVector const* vec, IVector* res, size_t dim, const char* message) const;
+
     size_t _dimArgs, _dimParams;
     IVector *_args, *_params;
+    /*buffers bound by caller are used instead of stored vectors*/
+    const double *_boundArgs, *_boundParams;
+    /*parts of goal function by stored args and by stored params*/
+    double _argsPart, _paramsPart;
+    /*made by createWorkerInstance, so it may be released by releaseWorkerInstance*/
+    bool _isWorker;
 
 };
 
@@ -50,6 +84,8 @@ public:
 
     int release();
 
+    IBrocker* createWorkerBrocker() const;
+
     /*ctor*/
     Brocker1(Problem1 *problem);
 
@@ -65,7 +101,7 @@ private:
 }
 
 int Problem1::getId() const {
-    return IProblem::INTERFACE_0;
+    return IProblem::INTERFACE_1;
 }
 
 int Problem1::goalFunction(IVector const* args,
@@ -100,18 +136,297 @@ int Problem1::goalFunction(IVector const* args,
     if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
         return ec;
 
-    res = a[0] * a[0] + a[1] * a[1] +
-            p[0] * p[0] - 4 * p[0] + p[1] * p[1] - 2 * p[1];
+    res = argsPart(a) + paramsPart(p);
 
     return ERR_OK;
 }
 
+/*goal function is a sum of args and params parts, part by fixed vector is computed when it is set*/
+double Problem1::argsPart(const double* a) {
+    return a[0] * a[0] + a[1] * a[1];
+}
+
+double Problem1::paramsPart(const double* p) {
+    return p[0] * p[0] - 4 * p[0] + p[1] * p[1] - 2 * p[1];
+}
+
+/*bound buffer may be written without notifying workers sharing it, so its part is found on every call*/
+double Problem1::fixedArgsPart() const {
+    return _boundArgs ? argsPart(_boundArgs) : _argsPart;
+}
+
+double Problem1::fixedParamsPart() const {
+    return _boundParams ? paramsPart(_boundParams) : _paramsPart;
+}
+
+/*coords of fixed args or params: bound buffer or stored vector*/
+int Problem1::getFixed(DerivedType dr, const double*& coords, const char* message) const {
+    const double *bound = dr == BY_ARGS ? _boundArgs : _boundParams;
+    IVector *stored = dr == BY_ARGS ? _args : _params;
+
+    if (bound) {
+        coords = bound;
+        return ERR_OK;
+    }
+
+    if (!stored) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    unsigned int dim;
+
+    return stored->getCoordsPtr(dim, coords);
+}
+
 int Problem1::goalFunctionByArgs(IVector const*  args, double& res) const {
-    return goalFunction(args, _params, res);
+    if (!args) {
+        ILog::report("IProblem.goalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.goalFunctionByArgs: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    if (!_params && !_boundParams) {
+        ILog::report("IProblem.goalFunctionByArgs: Params are not set\n");
+        return ERR_WRONG_ARG;
+    }
+
+    unsigned int dimA;
+    const double *a;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    res = argsPart(a) + fixedParamsPart();
+
+    return ERR_OK;
 }
 
 int Problem1::goalFunctionByParams(IVector const*  params, double& res) const {
-    return goalFunction(_args, params, res);
+    if (!params) {
+        ILog::report("IProblem.goalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.goalFunctionByParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    if (!_args && !_boundArgs) {
+        ILog::report("IProblem.goalFunctionByParams: Args are not set\n");
+        return ERR_WRONG_ARG;
+    }
+
+    unsigned int dimP;
+    const double *p;
+    int ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    res = fixedArgsPart() + paramsPart(p);
+
+    return ERR_OK;
+}
+
+int Problem1::goalFunctionByArgsBatch(size_t count, double const* args, double* res) const {
+    if (!_params && !_boundParams) {
+        ILog::report("IProblem.goalFunctionByArgsBatch: Params are not set\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (count > 0 && (!args || !res)) {
+        ILog::report("IProblem.goalFunctionByArgsBatch: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    double part = fixedParamsPart();
+
+    for (size_t i = 0; i < count; i++)
+        res[i] = argsPart(args + i * _dimArgs) + part;
+
+    return ERR_OK;
+}
+
+int Problem1::goalFunctionByParamsBatch(size_t count, double const* params, double* res) const {
+    if (!_args && !_boundArgs) {
+        ILog::report("IProblem.goalFunctionByParamsBatch: Args are not set\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (count > 0 && (!params || !res)) {
+        ILog::report("IProblem.goalFunctionByParamsBatch: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    double part = fixedArgsPart();
+
+    for (size_t i = 0; i < count; i++)
+        res[i] = part + paramsPart(params + i * _dimParams);
+
+    return ERR_OK;
+}
+
+int Problem1::valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const {
+    int ec;
+
+    if ((ec = goalFunctionByArgs(args, value)) != ERR_OK)
+        return ec;
+
+    return gradientByArgs(args, grad);
+}
+
+int Problem1::valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const {
+    int ec;
+
+    if ((ec = goalFunctionByParams(params, value)) != ERR_OK)
+        return ec;
+
+    return gradientByParams(params, grad);
+}
+
+int Problem1::gradientByArgs(IVector const* args, IVector* grad) const {
+    if (!args || !grad) {
+        ILog::report("IProblem.gradientByArgs: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim() || _dimArgs != grad->getDim()) {
+        ILog::report("IProblem.gradientByArgs: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA;
+    const double *a;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    double g[2] = {2 * a[0], 2 * a[1]};
+
+    return grad->setAllCoords(2, g);
+}
+
+int Problem1::gradientByParams(IVector const* params, IVector* grad) const {
+    if (!params || !grad) {
+        ILog::report("IProblem.gradientByParams: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimParams != params->getDim() || _dimParams != grad->getDim()) {
+        ILog::report("IProblem.gradientByParams: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimP;
+    const double *p;
+    int ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    double g[2] = {2 * p[0] - 4, 2 * p[1] - 2};
+
+    return grad->setAllCoords(2, g);
+}
+
+/*both parts of goal function are sums of squares, so Hessian is 2 * I by args and by params*/
+int Problem1::hessian(IVector const* point, size_t dim, double* hessian, const char* message) const {
+    if (!point || !hessian) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    if (dim != point->getDim()) {
+        ILog::report("IProblem.hessian: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    for (size_t i = 0; i < dim; i++) {
+        for (size_t j = 0; j < dim; j++)
+            hessian[i * dim + j] = i == j ? 2 : 0;
+    }
+
+    return ERR_OK;
+}
+
+int Problem1::hessianVectorProduct(IVector const* point, IVector const* vec, IVector* res, size_t dim, const char* message) const {
+    if (!point || !vec || !res) {
+        ILog::report(message);
+        return ERR_WRONG_ARG;
+    }
+
+    if (dim != point->getDim() || dim != vec->getDim() || dim != res->getDim()) {
+        ILog::report("IProblem.hessianVectorProduct: Input argument has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimV;
+    const double *v;
+    int ec;
+
+    if ((ec = vec->getCoordsPtr(dimV, v)) != ERR_OK)
+        return ec;
+
+    double hv[2] = {2 * v[0], 2 * v[1]};
+
+    return res->setAllCoords(2, hv);
+}
+
+int Problem1::hessianByArgs(IVector const* args, double* hessian) const {
+    return this->hessian(args, _dimArgs, hessian, "IProblem.hessianByArgs: Input argument is nullptr\n");
+}
+
+int Problem1::hessianByParams(IVector const* params, double* hessian) const {
+    return this->hessian(params, _dimParams, hessian, "IProblem.hessianByParams: Input argument is nullptr\n");
+}
+
+int Problem1::hessianVectorProductByArgs(IVector const* args, IVector const* vec, IVector* res) const {
+    return hessianVectorProduct(args, vec, res, _dimArgs, "IProblem.hessianVectorProductByArgs: Input argument is nullptr\n");
+}
+
+int Problem1::hessianVectorProductByParams(IVector const* params, IVector const* vec, IVector* res) const {
+    return hessianVectorProduct(params, vec, res, _dimParams, "IProblem.hessianVectorProductByParams: Input argument is nullptr\n");
+}
+
+int Problem1::getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const {
+    size_t dim;
+
+    switch (dr) {
+    case IProblem::BY_ARGS:
+        dim = _dimArgs;
+        break;
+    case IProblem::BY_PARAMS:
+        dim = _dimParams;
+        break;
+    default:
+        ILog::report("IProblem.getHessianSparsity: Input argument dr is unknown\n");
+        return ERR_WRONG_ARG;
+    }
+
+    rows = new (std::nothrow) size_t[dim];
+    cols = new (std::nothrow) size_t[dim];
+
+    if (!rows || !cols) {
+        ILog::report("IProblem.getHessianSparsity: Not enough memory\n");
+        delete[] rows;
+        delete[] cols;
+        rows = cols = NULL;
+        return ERR_MEMORY_ALLOCATION;
+    }
+
+    for (size_t i = 0; i < dim; i++)
+        rows[i] = cols[i] = i;
+    count = dim;
+
+    return ERR_OK;
 }
 
 int Problem1::getArgsDim(size_t& dim) const {
@@ -126,6 +441,7 @@ int Problem1::getParamsDim(size_t& dim) const {
     return ERR_OK;
 }
 
+/*stored vector is reused, so repeated calls don't allocate*/
 int Problem1::setParams(IVector const* params) {
     if (!params) {
         ILog::report("IProblem.setParams: Input argument params is nullptr\n");
@@ -137,13 +453,28 @@ int Problem1::setParams(IVector const* params) {
         return ERR_VARIABLES_NUMBER_MISMATCH;
     }
 
-    _params = params->clone();
+    unsigned int dimP;
+    const double *p;
+    int ec;
 
-    if (!_params) {
-        ILog::report("IProblem.setParams: Not enough memory\n");
-        return ERR_MEMORY_ALLOCATION;
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    if (_params) {
+        if ((ec = _params->setAllCoords(dimP, const_cast<double*>(p))) != ERR_OK)
+            return ec;
+    } else {
+        _params = params->clone();
+
+        if (!_params) {
+            ILog::report("IProblem.setParams: Not enough memory\n");
+            return ERR_MEMORY_ALLOCATION;
+        }
     }
 
+    _boundParams = NULL;
+    _paramsPart = paramsPart(p);
+
     return ERR_OK;
 }
 
@@ -158,44 +489,132 @@ int Problem1::setArgs(IVector const* args) {
         return ERR_VARIABLES_NUMBER_MISMATCH;
     }
 
-    _args = args->clone();
+    unsigned int dimA;
+    const double *a;
+    int ec;
 
-    if (!_args) {
-        ILog::report("IProblem.setArgs: Not enough memory\n");
-        return ERR_MEMORY_ALLOCATION;
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    if (_args) {
+        if ((ec = _args->setAllCoords(dimA, const_cast<double*>(a))) != ERR_OK)
+            return ec;
+    } else {
+        _args = args->clone();
+
+        if (!_args) {
+            ILog::report("IProblem.setArgs: Not enough memory\n");
+            return ERR_MEMORY_ALLOCATION;
+        }
     }
 
+    _boundArgs = NULL;
+    _argsPart = argsPart(a);
+
     return ERR_OK;
 }
 
-int Problem1::derivativeGoalFunction(size_t order,
-                                     size_t idx,
-                                     DerivedType dr,
-                                     double& value,
-                                     IVector const* args,
-                                     IVector const* params) const {
-    if (!args) {
-        ILog::report("IProblem.derivativeGoalFunction: Input argument args is nullptr\n");
-        return ERR_WRONG_ARG;
+int Problem1::bindParams(double const* params, size_t dim) {
+    if (params && _dimParams != dim) {
+        ILog::report("IProblem.bindParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
     }
 
-    if (!params) {
-        ILog::report("IProblem.derivativeGoalFunction: Input argument params is nullptr\n");
-        return ERR_WRONG_ARG;
-    }
+    _boundParams = params;
 
-    if (_dimArgs != args->getDim()) {
-        ILog::report("IProblem.derivativeGoalFunction: Input argument args has wrong dim\n");
+    return paramsChanged();
+}
+
+int Problem1::bindArgs(double const* args, size_t dim) {
+    if (args && _dimArgs != dim) {
+        ILog::report("IProblem.bindArgs: Input argument args has wrong dim\n");
         return ERR_VARIABLES_NUMBER_MISMATCH;
     }
 
-    if (_dimParams != params->getDim()) {
-        ILog::report("IProblem.derivativeGoalFunction: Input argument params has wrong dim\n");
-        return ERR_VARIABLES_NUMBER_MISMATCH;
+    _boundArgs = args;
+
+    return argsChanged();
+}
+
+int Problem1::paramsChanged() {
+    const double *p;
+    int ec;
+
+    if (!_boundParams && !_params)
+        return ERR_OK;
+
+    if ((ec = getFixed(BY_PARAMS, p, "IProblem.paramsChanged: Params are not set\n")) != ERR_OK)
+        return ec;
+
+    _paramsPart = paramsPart(p);
+
+    return ERR_OK;
+}
+
+int Problem1::argsChanged() {
+    const double *a;
+    int ec;
+
+    if (!_boundArgs && !_args)
+        return ERR_OK;
+
+    if ((ec = getFixed(BY_ARGS, a, "IProblem.argsChanged: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    _argsPart = argsPart(a);
+
+    return ERR_OK;
+}
+
+/*const methods only read fixed vectors and cached parts*/
+bool Problem1::isReentrant() const {
+    return true;
+}
+
+IProblem* Problem1::createWorkerInstance() const {
+    Problem1 *worker = new (std::nothrow) Problem1();
+
+    if (!worker) {
+        ILog::report("IProblem.createWorkerInstance: Not enough memory\n");
+        return NULL;
+    }
+
+    if ((_args && worker->setArgs(_args) != ERR_OK) || (_params && worker->setParams(_params) != ERR_OK)) {
+        delete worker;
+        return NULL;
     }
 
-    if (order == 0)
-        return goalFunction(args, params, value);
+    worker->_boundArgs = _boundArgs;
+    worker->_boundParams = _boundParams;
+    worker->_argsPart = _argsPart;
+    worker->_paramsPart = _paramsPart;
+    worker->_isWorker = true;
+
+    return worker;
+}
+
+/*problem of brocker is released by the brocker*/
+int Problem1::releaseWorkerInstance() {
+    if (!_isWorker) {
+        ILog::report("IProblem.releaseWorkerInstance: Problem isn't a worker instance\n");
+        return ERR_WRONG_ARG;
+    }
+
+    delete this;
+
+    return ERR_OK;
+}
+
+int Problem1::derivative(size_t order,
+                         size_t idx,
+                         DerivedType dr,
+                         double& value,
+                         const double* a,
+                         const double* p) const {
+    if (order == 0) {
+        value = argsPart(a) + paramsPart(p);
+        return ERR_OK;
+    }
 
     if (order == 2) {
         value = 2;
@@ -207,8 +626,6 @@ int Problem1::derivativeGoalFunction(size_t order,
         return ERR_OK;
     }
 
-    int ec;
-
     switch (dr) {
     case IProblem::BY_ARGS:
         if (idx >= _dimArgs) {
@@ -216,12 +633,6 @@ int Problem1::derivativeGoalFunction(size_t order,
             return ERR_OUT_OF_RANGE;
         }
 
-        unsigned int dimA;
-        const double *a;
-
-        if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
-            return ec;
-
         value = 2 * a[idx];
 
         return ERR_OK;
@@ -232,12 +643,6 @@ int Problem1::derivativeGoalFunction(size_t order,
             return ERR_OUT_OF_RANGE;
         }
 
-        unsigned int dimP;
-        const double *p;
-
-        if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
-            return ec;
-
         if (idx == 0)
             value = 2 * p[0] - 4;
         else
@@ -251,12 +656,71 @@ int Problem1::derivativeGoalFunction(size_t order,
     }
 }
 
+int Problem1::derivativeGoalFunction(size_t order,
+                                     size_t idx,
+                                     DerivedType dr,
+                                     double& value,
+                                     IVector const* args,
+                                     IVector const* params) const {
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA, dimP;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
+}
+
 int Problem1::derivativeGoalFunctionByArgs(size_t order,
                                            size_t idx,
                                            DerivedType dr,
                                            double& value,
                                            IVector const* args) const {
-    return derivativeGoalFunction(order, idx, dr, value, args, _params);
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimArgs != args->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimA;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = getFixed(BY_PARAMS, p, "IProblem.derivativeGoalFunctionByArgs: Params are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = args->getCoordsPtr(dimA, a)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
 }
 
 int Problem1::derivativeGoalFunctionByParams(size_t order,
@@ -264,11 +728,32 @@ int Problem1::derivativeGoalFunctionByParams(size_t order,
                                    DerivedType dr,
                                    double& value,
                                    IVector const* params) const {
-    return derivativeGoalFunction(order, idx, dr, value, _args, params);
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    if (_dimParams != params->getDim()) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params has wrong dim\n");
+        return ERR_VARIABLES_NUMBER_MISMATCH;
+    }
+
+    unsigned int dimP;
+    const double *a, *p;
+    int ec;
+
+    if ((ec = getFixed(BY_ARGS, a, "IProblem.derivativeGoalFunctionByParams: Args are not set\n")) != ERR_OK)
+        return ec;
+
+    if ((ec = params->getCoordsPtr(dimP, p)) != ERR_OK)
+        return ec;
+
+    return derivative(order, idx, dr, value, a, p);
 }
 
 Problem1::Problem1():
-    _dimArgs(2), _dimParams(2), _args(NULL), _params(NULL)
+    _dimArgs(2), _dimParams(2), _args(NULL), _params(NULL),
+    _boundArgs(NULL), _boundParams(NULL), _argsPart(0), _paramsPart(0), _isWorker(false)
 {}
 
 Problem1::~Problem1() {
@@ -277,7 +762,7 @@ Problem1::~Problem1() {
 }
 
 int Brocker1::getId() const {
-    return IBrocker::INTERFACE_0;
+    return IBrocker::INTERFACE_1;
 }
 
 bool Brocker1::canCastTo(Type type) const {
@@ -304,6 +789,23 @@ int Brocker1::release() {
     return ERR_OK;
 }
 
+IBrocker* Brocker1::createWorkerBrocker() const {
+    Problem1 *problem = static_cast<Problem1*>(_problem->createWorkerInstance());
+
+    if (!problem)
+        return NULL;
+
+    Brocker1 *brocker = new (std::nothrow) Brocker1(problem);
+
+    if (!brocker) {
+        ILog::report("IBrocker.createWorkerBrocker: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    return brocker;
+}
+
 Brocker1::Brocker1(Problem1 *problem):
     _problem(problem)
 {}
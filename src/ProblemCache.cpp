@@ -0,0 +1,827 @@
+#include <new>
+#include <climits>
+#include <QVector>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+
+#include "ILog.h"
+#include "IBrocker.h"
+#include "IProblem.h"
+#include "IProblemCache.h"
+#include "IVector.h"
+#include "Interface0Problem.h"
+
+namespace {
+
+/*kinds of cached results, part of key*/
+enum Kind {
+    VALUE,
+    GRADIENT,
+    HESSIAN,
+    DERIVATIVE
+};
+
+/*key is the exact bits of request: header, then args and params one after another,
+  so -0.0 and 0.0 are different points and equal NaNs are the same one*/
+QByteArray makeKey(Kind kind, size_t order, size_t idx, IProblem::DerivedType dr,
+                   double const* args, size_t argsDim, double const* params, size_t paramsDim) {
+    size_t header[] = {size_t(kind), order, idx, size_t(dr), argsDim, paramsDim};
+    QByteArray key;
+
+    key.reserve(int(sizeof(header) + (argsDim + paramsDim) * sizeof(double)));
+    key.append(reinterpret_cast<char const*>(header), int(sizeof(header)));
+    key.append(reinterpret_cast<char const*>(args), int(argsDim * sizeof(double)));
+    key.append(reinterpret_cast<char const*>(params), int(paramsDim * sizeof(double)));
+
+    return key;
+}
+
+/*results shared by decorator and its worker instances, released by the last of them*/
+class ProblemCache : public IProblemCache {
+
+public:
+
+    int getId() const;
+
+    int clear();
+
+    unsigned int getHits() const;
+    unsigned int getMisses() const;
+    unsigned int getSize() const;
+
+    /*copies 'count' cached doubles to 'values' if key is found*/
+    bool find(QByteArray const& key, double* values, size_t count);
+    void insert(QByteArray const& key, double const* values, size_t count);
+
+    void acquire();
+    void release();
+
+    /*ctor*/
+    ProblemCache(unsigned int capacity);
+
+    /*dtor*/
+    ~ProblemCache();
+
+private:
+
+    mutable QMutex _mutex;
+    QCache<QByteArray, QVector<double> > _entries;
+    unsigned int _hits;
+    unsigned int _misses;
+    unsigned int _refs;
+
+};
+
+class CachingProblem : public IProblem {
+
+public:
+
+    int getId() const;
+
+    int goalFunction(IVector const* args, IVector const* params, double& res) const;
+    int goalFunctionByArgs(IVector const*  args, double& res) const;
+    int goalFunctionByParams(IVector const*  params, double& res) const;
+    int goalFunctionByArgsBatch(size_t count, double const* args, double* res) const;
+    int goalFunctionByParamsBatch(size_t count, double const* params, double* res) const;
+    int gradientByArgs(IVector const* args, IVector* grad) const;
+    int gradientByParams(IVector const* params, IVector* grad) const;
+    int valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const;
+    int valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const;
+    int hessianByArgs(IVector const* args, double* hessian) const;
+    int hessianByParams(IVector const* params, double* hessian) const;
+    int hessianVectorProductByArgs(IVector const* args, IVector const* vec, IVector* res) const;
+    int hessianVectorProductByParams(IVector const* params, IVector const* vec, IVector* res) const;
+    int getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const;
+    int getArgsDim(size_t& dim) const;
+    int getParamsDim(size_t& dim) const;
+
+    int setParams(IVector const* params);
+    int setArgs(IVector const* args);
+    int bindParams(double const* params, size_t dim);
+    int bindArgs(double const* args, size_t dim);
+    int paramsChanged();
+    int argsChanged();
+
+    bool isReentrant() const;
+    IProblem* createWorkerInstance() const;
+    int releaseWorkerInstance();
+
+    int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
+    int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const;
+    int derivativeGoalFunctionByParams(size_t order, size_t idx, DerivedType dr, double& value, IVector const* params) const;
+
+    ProblemCache* getCache() const;
+
+    /*ctor*/
+    CachingProblem(IProblem *problem, ProblemCache *cache, bool ownsProblem);
+
+    /*dtor*/
+    ~CachingProblem();
+
+private:
+
+    int getKey(Kind kind, size_t order, size_t idx, DerivedType dr, IVector const* args, IVector const* params, QByteArray& key) const;
+    int value(IVector const* args, IVector const* params, double& res) const;
+    int evaluate(DerivedType dr, size_t count, double const* points, double* res) const;
+    int gradient(DerivedType dr, IVector const* point, bool withValue, double& value, IVector* grad) const;
+    int hessian(DerivedType dr, IVector const* point, double* hessian) const;
+    int derivative(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const;
+
+    static int copyCoords(IVector const* vec, QVector<double>& coords);
+
+    IProblem *_problem;
+    ProblemCache *_cache;
+    /*decorator made by createWorkerInstance releases worker of wrapped problem*/
+    bool _ownsProblem;
+    /*made by createWorkerInstance, so it may be released by releaseWorkerInstance*/
+    bool _isWorker;
+    /*fixed vectors of wrapped problem as they were set through decorator, part of keys*/
+    QVector<double> _args;
+    QVector<double> _params;
+    double const* _boundArgs;
+    double const* _boundParams;
+
+};
+
+class CacheBrocker : public IBrocker {
+
+public:
+
+    int getId() const;
+
+    bool canCastTo(Type type) const;
+    void* getInterfaceImpl(Type type) const;
+
+    int release();
+
+    IBrocker* createWorkerBrocker() const;
+
+    /*ctor*/
+    CacheBrocker(CachingProblem *problem);
+
+    /*dtor*/
+    ~CacheBrocker();
+
+private:
+
+    CachingProblem *_problem;
+
+};
+
+}
+
+IBrocker* IProblemCache::createCache(IProblem* problem, unsigned int capacity) {
+    if (!problem) {
+        ILog::report("IProblemCache.createCache: Input argument problem is nullptr\n");
+        return NULL;
+    }
+
+    if (capacity == 0) {
+        ILog::report("IProblemCache.createCache: zero capacity\n");
+        return NULL;
+    }
+
+    /*QCache counts cost by int*/
+    if (capacity > unsigned(INT_MAX)) {
+        ILog::report("IProblemCache.createCache: capacity is greater than INT_MAX\n");
+        return NULL;
+    }
+
+    ProblemCache *cache = new (std::nothrow) ProblemCache(capacity);
+
+    if (!cache) {
+        ILog::report("IProblemCache.createCache: not enough memory\n");
+        return NULL;
+    }
+
+    /*problem of INTERFACE_0 has no batch and derivative methods, adapter is released with the brocker*/
+    bool legacy = problem->getId() < IProblem::INTERFACE_1;
+
+    if (legacy && !(problem = new (std::nothrow) Interface0Problem(problem))) {
+        ILog::report("IProblemCache.createCache: not enough memory\n");
+        cache->release();
+        return NULL;
+    }
+
+    CachingProblem *decorator = new (std::nothrow) CachingProblem(problem, cache, legacy);
+
+    if (!decorator) {
+        ILog::report("IProblemCache.createCache: not enough memory\n");
+        if (legacy)
+            problem->releaseWorkerInstance();
+        cache->release();
+        return NULL;
+    }
+
+    CacheBrocker *brocker = new (std::nothrow) CacheBrocker(decorator);
+
+    if (!brocker) {
+        ILog::report("IProblemCache.createCache: not enough memory\n");
+        delete decorator;
+        return NULL;
+    }
+
+    return brocker;
+}
+
+int ProblemCache::getId() const {
+    return IProblemCache::INTERFACE_0;
+}
+
+int ProblemCache::clear() {
+    _mutex.lock();
+    _entries.clear();
+    _hits = 0;
+    _misses = 0;
+    _mutex.unlock();
+
+    return ERR_OK;
+}
+
+unsigned int ProblemCache::getHits() const {
+    _mutex.lock();
+    unsigned int hits = _hits;
+    _mutex.unlock();
+
+    return hits;
+}
+
+unsigned int ProblemCache::getMisses() const {
+    _mutex.lock();
+    unsigned int misses = _misses;
+    _mutex.unlock();
+
+    return misses;
+}
+
+unsigned int ProblemCache::getSize() const {
+    _mutex.lock();
+    unsigned int size = _entries.totalCost();
+    _mutex.unlock();
+
+    return size;
+}
+
+/*found entry becomes the most recently used one*/
+bool ProblemCache::find(QByteArray const& key, double* values, size_t count) {
+    _mutex.lock();
+
+    QVector<double> *entry = _entries.object(key);
+    bool found = entry && size_t(entry->size()) == count;
+
+    if (found) {
+        for (size_t i = 0; i < count; i++)
+            values[i] = (*entry)[i];
+        _hits++;
+    } else {
+        _misses++;
+    }
+
+    _mutex.unlock();
+
+    return found;
+}
+
+/*cost of entry is bytes of its key and values, entry larger than capacity isn't cached*/
+void ProblemCache::insert(QByteArray const& key, double const* values, size_t count) {
+    size_t cost = key.size() + count * sizeof(double);
+
+    if (cost > size_t(_entries.maxCost()))
+        return;
+
+    QVector<double> *entry = new (std::nothrow) QVector<double>(int(count));
+
+    if (!entry)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+        (*entry)[i] = values[i];
+
+    _mutex.lock();
+    _entries.insert(key, entry, int(cost));
+    _mutex.unlock();
+}
+
+void ProblemCache::acquire() {
+    _mutex.lock();
+    _refs++;
+    _mutex.unlock();
+}
+
+void ProblemCache::release() {
+    _mutex.lock();
+    bool last = --_refs == 0;
+    _mutex.unlock();
+
+    if (last)
+        delete this;
+}
+
+ProblemCache::ProblemCache(unsigned int capacity):
+    _entries(int(capacity)), _hits(0), _misses(0), _refs(1)
+{}
+
+ProblemCache::~ProblemCache() {
+}
+
+int CachingProblem::getId() const {
+    return IProblem::INTERFACE_1;
+}
+
+int CachingProblem::getArgsDim(size_t& dim) const {
+    return _problem->getArgsDim(dim);
+}
+
+int CachingProblem::getParamsDim(size_t& dim) const {
+    return _problem->getParamsDim(dim);
+}
+
+/*nullptr 'args' or 'params' stands for the fixed one*/
+int CachingProblem::getKey(Kind kind, size_t order, size_t idx, DerivedType dr,
+                           IVector const* args, IVector const* params, QByteArray& key) const {
+    unsigned int argsDim = _args.size(), paramsDim = _params.size();
+    double const *a = _args.constData(), *p = _params.constData();
+    int ec;
+
+    if (args && (ec = args->getCoordsPtr(argsDim, a)) != ERR_OK)
+        return ec;
+
+    if (params && (ec = params->getCoordsPtr(paramsDim, p)) != ERR_OK)
+        return ec;
+
+    key = makeKey(kind, order, idx, dr, a, argsDim, p, paramsDim);
+
+    return ERR_OK;
+}
+
+int CachingProblem::value(IVector const* args, IVector const* params, double& res) const {
+    QByteArray key;
+    int ec;
+
+    if ((ec = getKey(VALUE, 0, 0, BY_ARGS, args, params, key)) != ERR_OK)
+        return ec;
+
+    if (_cache->find(key, &res, 1))
+        return ERR_OK;
+
+    ec = !params ? _problem->goalFunctionByArgs(args, res)
+                 : !args ? _problem->goalFunctionByParams(params, res)
+                         : _problem->goalFunction(args, params, res);
+
+    if (ec == ERR_OK)
+        _cache->insert(key, &res, 1);
+
+    return ec;
+}
+
+int CachingProblem::goalFunction(IVector const* args, IVector const* params, double& res) const {
+    if (!args || !params) {
+        ILog::report("IProblem.goalFunction: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return value(args, params, res);
+}
+
+int CachingProblem::goalFunctionByArgs(IVector const*  args, double& res) const {
+    if (!args) {
+        ILog::report("IProblem.goalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return value(args, NULL, res);
+}
+
+int CachingProblem::goalFunctionByParams(IVector const*  params, double& res) const {
+    if (!params) {
+        ILog::report("IProblem.goalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return value(NULL, params, res);
+}
+
+/*points missed by cache are evaluated by one batch of wrapped problem*/
+int CachingProblem::evaluate(DerivedType dr, size_t count, double const* points, double* res) const {
+    size_t dim;
+    int errCode = dr == BY_ARGS ? _problem->getArgsDim(dim) : _problem->getParamsDim(dim);
+
+    if (errCode != ERR_OK || count == 0)
+        return errCode;
+
+    if (!points || !res) {
+        ILog::report("IProblem.goalFunctionBatch: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    QVector<QByteArray> keys;
+    QVector<size_t> missed;
+    QVector<double> missedPoints, missedValues;
+
+    for (size_t i = 0; i < count; i++) {
+        double const* point = points + i * dim;
+        QByteArray key = dr == BY_ARGS ? makeKey(VALUE, 0, 0, BY_ARGS, point, dim, _params.constData(), _params.size())
+                                       : makeKey(VALUE, 0, 0, BY_ARGS, _args.constData(), _args.size(), point, dim);
+
+        if (_cache->find(key, res + i, 1))
+            continue;
+
+        keys.append(key);
+        missed.append(i);
+        for (size_t j = 0; j < dim; j++)
+            missedPoints.append(point[j]);
+    }
+
+    if (missed.isEmpty())
+        return ERR_OK;
+
+    missedValues.resize(missed.size());
+    errCode = dr == BY_ARGS ? _problem->goalFunctionByArgsBatch(missed.size(), missedPoints.constData(), missedValues.data())
+                            : _problem->goalFunctionByParamsBatch(missed.size(), missedPoints.constData(), missedValues.data());
+
+    if (errCode != ERR_OK)
+        return errCode;
+
+    for (int i = 0; i < missed.size(); i++) {
+        res[missed[i]] = missedValues[i];
+        _cache->insert(keys[i], &missedValues[i], 1);
+    }
+
+    return ERR_OK;
+}
+
+int CachingProblem::goalFunctionByArgsBatch(size_t count, double const* args, double* res) const {
+    return evaluate(BY_ARGS, count, args, res);
+}
+
+int CachingProblem::goalFunctionByParamsBatch(size_t count, double const* params, double* res) const {
+    return evaluate(BY_PARAMS, count, params, res);
+}
+
+/*value and gradient are cached separately, so fused call reuses results of plain ones*/
+int CachingProblem::gradient(DerivedType dr, IVector const* point, bool withValue, double& value, IVector* grad) const {
+    if (!point || !grad) {
+        ILog::report("IProblem.gradient: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    IVector const* args = dr == BY_ARGS ? point : NULL;
+    IVector const* params = dr == BY_ARGS ? NULL : point;
+    size_t dim = grad->getDim();
+    QVector<double> coords(dim);
+    QByteArray valueKey, gradKey;
+    int ec;
+
+    if (withValue && (ec = getKey(VALUE, 0, 0, BY_ARGS, args, params, valueKey)) != ERR_OK)
+        return ec;
+
+    if ((ec = getKey(GRADIENT, 1, 0, dr, args, params, gradKey)) != ERR_OK)
+        return ec;
+
+    bool valueFound = withValue && _cache->find(valueKey, &value, 1);
+
+    if ((valueFound || !withValue) && _cache->find(gradKey, coords.data(), dim))
+        return grad->setAllCoords(dim, coords.data());
+
+    /*cached value isn't evaluated again*/
+    withValue = withValue && !valueFound;
+
+    if (withValue)
+        ec = dr == BY_ARGS ? _problem->valueAndGradientByArgs(point, value, grad) : _problem->valueAndGradientByParams(point, value, grad);
+    else
+        ec = dr == BY_ARGS ? _problem->gradientByArgs(point, grad) : _problem->gradientByParams(point, grad);
+
+    if (ec != ERR_OK)
+        return ec;
+
+    unsigned int gradDim;
+    double const* g;
+
+    if ((ec = grad->getCoordsPtr(gradDim, g)) != ERR_OK)
+        return ec;
+
+    _cache->insert(gradKey, g, gradDim);
+
+    if (withValue)
+        _cache->insert(valueKey, &value, 1);
+
+    return ERR_OK;
+}
+
+int CachingProblem::gradientByArgs(IVector const* args, IVector* grad) const {
+    double value;
+    return gradient(BY_ARGS, args, false, value, grad);
+}
+
+int CachingProblem::gradientByParams(IVector const* params, IVector* grad) const {
+    double value;
+    return gradient(BY_PARAMS, params, false, value, grad);
+}
+
+int CachingProblem::valueAndGradientByArgs(IVector const* args, double& value, IVector* grad) const {
+    return gradient(BY_ARGS, args, true, value, grad);
+}
+
+int CachingProblem::valueAndGradientByParams(IVector const* params, double& value, IVector* grad) const {
+    return gradient(BY_PARAMS, params, true, value, grad);
+}
+
+int CachingProblem::hessian(DerivedType dr, IVector const* point, double* hessian) const {
+    if (!point || !hessian) {
+        ILog::report("IProblem.hessian: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    size_t dim = point->getDim();
+    QByteArray key;
+    int ec;
+
+    if ((ec = getKey(HESSIAN, 2, 0, dr, dr == BY_ARGS ? point : NULL, dr == BY_ARGS ? NULL : point, key)) != ERR_OK)
+        return ec;
+
+    if (_cache->find(key, hessian, dim * dim))
+        return ERR_OK;
+
+    ec = dr == BY_ARGS ? _problem->hessianByArgs(point, hessian) : _problem->hessianByParams(point, hessian);
+
+    if (ec == ERR_OK)
+        _cache->insert(key, hessian, dim * dim);
+
+    return ec;
+}
+
+int CachingProblem::hessianByArgs(IVector const* args, double* hessian) const {
+    return this->hessian(BY_ARGS, args, hessian);
+}
+
+int CachingProblem::hessianByParams(IVector const* params, double* hessian) const {
+    return this->hessian(BY_PARAMS, params, hessian);
+}
+
+/*products depend on arbitrary vector, so they aren't cached*/
+int CachingProblem::hessianVectorProductByArgs(IVector const* args, IVector const* vec, IVector* res) const {
+    return _problem->hessianVectorProductByArgs(args, vec, res);
+}
+
+int CachingProblem::hessianVectorProductByParams(IVector const* params, IVector const* vec, IVector* res) const {
+    return _problem->hessianVectorProductByParams(params, vec, res);
+}
+
+int CachingProblem::getHessianSparsity(DerivedType dr, size_t& count, size_t*& rows, size_t*& cols) const {
+    return _problem->getHessianSparsity(dr, count, rows, cols);
+}
+
+/*derivative of zero order is the value and shares its entry*/
+int CachingProblem::derivative(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const {
+    if (order == 0)
+        return this->value(args, params, value);
+
+    QByteArray key;
+    int ec;
+
+    if ((ec = getKey(DERIVATIVE, order, idx, dr, args, params, key)) != ERR_OK)
+        return ec;
+
+    if (_cache->find(key, &value, 1))
+        return ERR_OK;
+
+    ec = !params ? _problem->derivativeGoalFunctionByArgs(order, idx, dr, value, args)
+                 : !args ? _problem->derivativeGoalFunctionByParams(order, idx, dr, value, params)
+                         : _problem->derivativeGoalFunction(order, idx, dr, value, args, params);
+
+    if (ec == ERR_OK)
+        _cache->insert(key, &value, 1);
+
+    return ec;
+}
+
+int CachingProblem::derivativeGoalFunction(size_t order,
+                                           size_t idx,
+                                           DerivedType dr,
+                                           double& value,
+                                           IVector const* args,
+                                           IVector const* params) const {
+    if (!args || !params) {
+        ILog::report("IProblem.derivativeGoalFunction: Input argument is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return derivative(order, idx, dr, value, args, params);
+}
+
+int CachingProblem::derivativeGoalFunctionByArgs(size_t order,
+                                                 size_t idx,
+                                                 DerivedType dr,
+                                                 double& value,
+                                                 IVector const* args) const {
+    if (!args) {
+        ILog::report("IProblem.derivativeGoalFunctionByArgs: Input argument args is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return derivative(order, idx, dr, value, args, NULL);
+}
+
+int CachingProblem::derivativeGoalFunctionByParams(size_t order,
+                                                   size_t idx,
+                                                   DerivedType dr,
+                                                   double& value,
+                                                   IVector const* params) const {
+    if (!params) {
+        ILog::report("IProblem.derivativeGoalFunctionByParams: Input argument params is nullptr\n");
+        return ERR_WRONG_ARG;
+    }
+
+    return derivative(order, idx, dr, value, NULL, params);
+}
+
+int CachingProblem::copyCoords(IVector const* vec, QVector<double>& coords) {
+    unsigned int dim;
+    double const* c;
+    int ec;
+
+    if ((ec = vec->getCoordsPtr(dim, c)) != ERR_OK)
+        return ec;
+
+    coords.resize(dim);
+    for (unsigned int i = 0; i < dim; i++)
+        coords[i] = c[i];
+
+    return ERR_OK;
+}
+
+/*fixed vectors are remembered only after wrapped problem accepts them*/
+int CachingProblem::setParams(IVector const* params) {
+    int ec = _problem->setParams(params);
+
+    if (ec != ERR_OK)
+        return ec;
+
+    _boundParams = NULL;
+
+    return copyCoords(params, _params);
+}
+
+int CachingProblem::setArgs(IVector const* args) {
+    int ec = _problem->setArgs(args);
+
+    if (ec != ERR_OK)
+        return ec;
+
+    _boundArgs = NULL;
+
+    return copyCoords(args, _args);
+}
+
+int CachingProblem::bindParams(double const* params, size_t dim) {
+    int ec = _problem->bindParams(params, dim);
+
+    if (ec != ERR_OK)
+        return ec;
+
+    _boundParams = params;
+    _params.resize(params ? dim : 0);
+
+    return paramsChanged();
+}
+
+int CachingProblem::bindArgs(double const* args, size_t dim) {
+    int ec = _problem->bindArgs(args, dim);
+
+    if (ec != ERR_OK)
+        return ec;
+
+    _boundArgs = args;
+    _args.resize(args ? dim : 0);
+
+    return argsChanged();
+}
+
+int CachingProblem::paramsChanged() {
+    for (int i = 0; _boundParams && i < _params.size(); i++)
+        _params[i] = _boundParams[i];
+
+    return _problem->paramsChanged();
+}
+
+int CachingProblem::argsChanged() {
+    for (int i = 0; _boundArgs && i < _args.size(); i++)
+        _args[i] = _boundArgs[i];
+
+    return _problem->argsChanged();
+}
+
+/*cache is locked by itself, so decorator is reentrant when wrapped problem is*/
+bool CachingProblem::isReentrant() const {
+    return _problem->isReentrant();
+}
+
+/*worker shares cache, keys include fixed vectors, so their entries don't mix*/
+IProblem* CachingProblem::createWorkerInstance() const {
+    IProblem *problem = _problem->createWorkerInstance();
+
+    if (!problem)
+        return NULL;
+
+    CachingProblem *worker = new (std::nothrow) CachingProblem(problem, _cache, true);
+
+    if (!worker) {
+        ILog::report("IProblem.createWorkerInstance: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    _cache->acquire();
+    worker->_args = _args;
+    worker->_params = _params;
+    worker->_boundArgs = _boundArgs;
+    worker->_boundParams = _boundParams;
+    worker->_isWorker = true;
+
+    return worker;
+}
+
+/*decorator of brocker is released by the brocker*/
+int CachingProblem::releaseWorkerInstance() {
+    if (!_isWorker) {
+        ILog::report("IProblem.releaseWorkerInstance: Problem isn't a worker instance\n");
+        return ERR_WRONG_ARG;
+    }
+
+    delete this;
+
+    return ERR_OK;
+}
+
+ProblemCache* CachingProblem::getCache() const {
+    return _cache;
+}
+
+CachingProblem::CachingProblem(IProblem *problem, ProblemCache *cache, bool ownsProblem):
+    _problem(problem), _cache(cache), _ownsProblem(ownsProblem), _isWorker(false), _boundArgs(NULL), _boundParams(NULL)
+{}
+
+CachingProblem::~CachingProblem() {
+    _cache->release();
+
+    if (_ownsProblem)
+        _problem->releaseWorkerInstance();
+}
+
+int CacheBrocker::getId() const {
+    return IBrocker::INTERFACE_1;
+}
+
+bool CacheBrocker::canCastTo(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+    case IBrocker::PROBLEM_CACHE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void* CacheBrocker::getInterfaceImpl(Type type) const {
+    switch (type) {
+    case IBrocker::PROBLEM:
+        return static_cast<IProblem*>(_problem);
+    case IBrocker::PROBLEM_CACHE:
+        return static_cast<IProblemCache*>(_problem->getCache());
+    default:
+        return NULL;
+    }
+}
+
+int CacheBrocker::release() {
+    delete this;
+
+    return ERR_OK;
+}
+
+IBrocker* CacheBrocker::createWorkerBrocker() const {
+    CachingProblem *problem = static_cast<CachingProblem*>(_problem->createWorkerInstance());
+
+    if (!problem)
+        return NULL;
+
+    CacheBrocker *brocker = new (std::nothrow) CacheBrocker(problem);
+
+    if (!brocker) {
+        ILog::report("IBrocker.createWorkerBrocker: not enough memory\n");
+        problem->releaseWorkerInstance();
+        return NULL;
+    }
+
+    return brocker;
+}
+
+CacheBrocker::CacheBrocker(CachingProblem *problem):
+    _problem(problem)
+{}
+
+/*wrapped problem belongs to its own brocker*/
+CacheBrocker::~CacheBrocker() {
+    delete _problem;
+}
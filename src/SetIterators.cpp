@@ -0,0 +1,126 @@
+#include <new>
+#include "SetIterators.h"
+#include "error.h"
+#include "ILog.h"
+
+int IndexIterator::next() {
+    if (_pos + 1 >= _set->getSize()) {
+        ILog::report("ISet.next: Iterator already at the end of the set\n");
+        return ERR_OUT_OF_RANGE;
+    }
+    _pos++;
+    return ERR_OK;
+}
+
+int IndexIterator::prev() {
+    if (_pos == 0) {
+        ILog::report("ISet.prev: Iterator already at the begin of the set\n");
+        return ERR_OUT_OF_RANGE;
+    }
+    _pos--;
+    return ERR_OK;
+}
+
+bool IndexIterator::isEnd() const {
+    return _pos == _set->getSize() - 1;
+}
+
+bool IndexIterator::isBegin() const {
+    return _pos == 0;
+}
+
+IndexIterator::IndexIterator(ISet const* const set, int pos): ISet::IIterator(set, pos), _set(set), _pos(pos) {}
+
+IndexIterators::~IndexIterators() {
+    clear();
+}
+
+ISet::IIterator* IndexIterators::create(ISet const* set, bool atEnd) {
+    if (set->getSize() == 0) {
+        ILog::report(atEnd ? "ISet.end: Can not create iterator of empty set\n"
+                           : "ISet.begin: Can not create iterator of empty set\n");
+        return NULL;
+    }
+    IndexIterator* iterator = new(std::nothrow) IndexIterator(set, atEnd ? set->getSize() - 1 : 0);
+    if (!iterator) {
+        ILog::report(atEnd ? "ISet.end: Not enough memory\n" : "ISet.begin: Not enough memory\n");
+        return NULL;
+    }
+    _iterators.append(iterator);
+    return iterator;
+}
+
+IndexIterator* IndexIterators::find(ISet::IIterator const* pIter, char const* nullMessage, char const* foreignMessage) const {
+    if (!pIter) {
+        ILog::report(nullMessage);
+        return NULL;
+    }
+    for (int i = 0; i < _iterators.size(); i++) {
+        if (_iterators[i] == pIter)
+            return _iterators[i];
+    }
+    ILog::report(foreignMessage);
+    return NULL;
+}
+
+int IndexIterators::remove(ISet::IIterator* pIter) {
+    IndexIterator* iterator = find(pIter, "ISet.deleteIterator: Input argument is nullptr\n",
+                                   "ISet.deleteIterator: Set does not contain input iterator\n");
+    if (!iterator)
+        return ERR_WRONG_ARG;
+    _iterators.remove(_iterators.indexOf(iterator));
+    delete iterator;
+    return ERR_OK;
+}
+
+int IndexIterators::getByIterator(ISet const* set, ISet::IIterator const* pIter, IVector*& pItem) const {
+    IndexIterator* iterator = find(pIter, "ISet.getByIterator: Input argument is nullptr\n",
+                                   "ISet.getByIterator: Set does not contain input iterator\n");
+    if (!iterator)
+        return ERR_WRONG_ARG;
+    return set->get(iterator->_pos, pItem);
+}
+
+int IndexIterators::getCoordsPtrByIterator(ISet const* set, ISet::IIterator const* pIter, unsigned int& dim, double const*& coords) const {
+    IndexIterator* iterator = find(pIter, "ISet.getCoordsPtrByIterator: Input argument is nullptr\n",
+                                   "ISet.getCoordsPtrByIterator: Set does not contain input iterator\n");
+    if (!iterator)
+        return ERR_WRONG_ARG;
+    return set->getCoordsPtr(iterator->_pos, dim, coords);
+}
+
+void IndexIterators::erase(unsigned int index, unsigned int last) {
+    int kept = 0;
+    for (int i = 0; i < _iterators.size(); i++) {
+        IndexIterator* iterator = _iterators[i];
+        if (iterator->_pos == index) {
+            delete iterator;
+            continue;
+        }
+        if (iterator->_pos == last)
+            iterator->_pos = index;
+        _iterators[kept++] = iterator;
+    }
+    _iterators.resize(kept);
+}
+
+void IndexIterators::erase(QVector<bool> const& marked, QVector<unsigned int> const& newIndex) {
+    int kept = 0;
+    for (int i = 0; i < _iterators.size(); i++) {
+        IndexIterator* iterator = _iterators[i];
+        if (marked[iterator->_pos]) {
+            delete iterator;
+            continue;
+        }
+        iterator->_pos = newIndex[iterator->_pos];
+        _iterators[kept++] = iterator;
+    }
+    _iterators.resize(kept);
+}
+
+void IndexIterators::clear() {
+    for (int i = 0; i < _iterators.size(); i++) {
+        delete _iterators[i];
+    }
+    _iterators.clear();
+}
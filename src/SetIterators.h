@@ -0,0 +1,45 @@
+#ifndef SETITERATORS_H
+#define SETITERATORS_H
+
+#include <QVector>
+#include "ISet.h"
+
+/*iterator over positions of points in set, set moves it when points move*/
+class IndexIterator : public ISet::IIterator
+{
+public:
+    int next();
+    int prev();
+    bool isEnd() const;
+    bool isBegin() const;
+
+    ISet const* const _set;
+    unsigned int _pos;
+
+    IndexIterator(ISet const* const set, int pos);
+};
+
+/*iterators created by set, they are deleted with their points or with set*/
+class IndexIterators
+{
+public:
+    ~IndexIterators();
+
+    ISet::IIterator* create(ISet const* set, bool atEnd);
+    int remove(ISet::IIterator* pIter);
+    int getByIterator(ISet const* set, ISet::IIterator const* pIter, IVector*& pItem) const;
+    int getCoordsPtrByIterator(ISet const* set, ISet::IIterator const* pIter, unsigned int& dim, double const*& coords) const;
+
+    /*iterators of point 'index' are deleted, the ones of point 'last' move to its place*/
+    void erase(unsigned int index, unsigned int last);
+    /*iterators of marked points are deleted, the others move to 'newIndex' of their points*/
+    void erase(QVector<bool> const& marked, QVector<unsigned int> const& newIndex);
+    void clear();
+
+private:
+    IndexIterator* find(ISet::IIterator const* pIter, char const* nullMessage, char const* foreignMessage) const;
+
+    QVector<IndexIterator*> _iterators;
+};
+
+#endif // SETITERATORS_H
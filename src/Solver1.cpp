@@ -12,6 +12,7 @@
 #include "ISolver.h"
 #include "IProblem.h"
 #include "ICompact.h"
+#include "ILatticeCache.h"
 
 namespace {
 
@@ -36,8 +37,17 @@ public:
 
 private:
 
+   int project(IVector const* vec, IVector* &res);
+   int goalFunction(IVector const* vec, double& res);
+   int valueAndGradient(IVector const* vec, double& res, IVector* grad);
+
+   static const unsigned int CACHE_CAPACITY = 1 << 16;
+
    IVector * _args, * _params;
    ICompact * _compact;
+   ICompact::ProjectionType _projection;
+   bool _projectionFallback;
+   ILatticeCache * _cache;
    bool solveByArgs;
    double eps;
    IVector * _prev, * _curr;
@@ -100,6 +110,12 @@ int Solver1::solve() {
         return ERR_WRONG_ARG;
     }
 
+    _projectionFallback = false;
+
+    /*values at lattice points are cached only while problem is fixed, i.e. within one solve*/
+    if (_cache)
+        _cache->clear();
+
     if (solveByArgs) {
         if(_problem->setParams(_params) != ERR_OK) {
             ILog::report("ISolver.solve: error with setting params to problem\n");
@@ -107,262 +123,166 @@ int Solver1::solve() {
         }
 
         _curr = _args->clone();
-
-        if (!_curr) {
-            ILog::report("ISolver.solve: not enough memory\n");
-            return ERR_MEMORY_ALLOCATION;
+    }
+    else {
+        if(_problem->setArgs(_args) != ERR_OK) {
+            ILog::report("ISolver.solve: error with setting args to problem\n");
+            return ERR_ANY_OTHER;
         }
 
-        while (true) {
-            size_t argsDim;
-
-            if (_problem->getArgsDim(argsDim) != ERR_OK) {
-                ILog::report("ISolver.solve: error with getArgsDim\n");
-                return ERR_ANY_OTHER;
-            }
-
-            double *gradD = new (std::nothrow) double[argsDim];
-
-            if (!gradD) {
-                ILog::report("ISolver.solve: not enough memory\n");
-                return ERR_MEMORY_ALLOCATION;
-            }
+        _curr = _params->clone();
+    }
 
-            for (size_t i = 0; i < argsDim; i++) {
-                if (_problem->derivativeGoalFunctionByArgs(1,
-                                                           i,
-                                                           IProblem::BY_ARGS,
-                                                           gradD[i],
-                                                           _curr) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with derivativeGoalFunctionByArgs\n");
-                    delete[] gradD;
-                    return ERR_ANY_OTHER;
-                }
-            }
+    if (!_curr) {
+        ILog::report("ISolver.solve: not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
 
-            IVector *gradV = IVector::createVector(argsDim, gradD);
+    /*gradient is written into the same vector on every iteration*/
+    IVector *gradV = _curr->clone();
 
-            if (!gradV) {
-                ILog::report("ISolver.solve: not enough memory\n");
-                delete[] gradD;
-                return ERR_MEMORY_ALLOCATION;
-            }
+    if (!gradV) {
+        ILog::report("ISolver.solve: not enough memory\n");
+        return ERR_MEMORY_ALLOCATION;
+    }
 
-            delete[] gradD;
-
-            double alpha = 1, lambda = 0.8;
-
-            while (true) {
-                IVector *tmpMS = IVector::multiplyByScalar(gradV, alpha);
-
-                if (!tmpMS) {
-                    ILog::report("ISolver.solve: error with multiplyByScalar\n");
-                    delete gradV;
-                    return ERR_ANY_OTHER;
-                }
-
-                IVector *tmpS = IVector::subtract(_curr, tmpMS);
-
-                if (!tmpS) {
-                    ILog::report("ISolver.solve: error with subtract\n");
-                    delete gradV;
-                    delete tmpMS;
-                    return ERR_ANY_OTHER;
-                }
-
-                IVector *prS;
-
-                if (_compact->getNearestNeighbor(tmpS, prS) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with getNearestNeighbor\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    return ERR_ANY_OTHER;
-                }
-
-                double resS, resC;
-
-                if (_problem->goalFunctionByArgs(prS, resS) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with goalFunctionByArgs\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    delete prS;
-                    return ERR_ANY_OTHER;
-                }
-
-                if (_problem->goalFunctionByArgs(_curr, resC) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with goalFunctionByArgs\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    delete prS;
-                    return ERR_ANY_OTHER;
-                }
-
-                if (resS <= resC) {
-                    delete _prev;
-                    _prev = _curr;
-                    _curr = prS;
-                    break;
-                } else {
-                    alpha *= lambda;
-                }
-
-                delete tmpMS;
-                delete tmpS;
-            }
+    while (true) {
+        double resC;
 
+        if (valueAndGradient(_curr, resC, gradV) != ERR_OK) {
+            ILog::report("ISolver.solve: error with valueAndGradient\n");
             delete gradV;
-
-            bool res = false;
-
-            if (_curr->eq(_prev, IVector::NORM_INF, res, eps) != ERR_OK) {
-                ILog::report("ISolver.solve: cannot compare two vectors\n");
-                return ERR_ANY_OTHER;
-            }
-            if (res)
-                break;
-        }
-    }
-    else {
-        if(_problem->setArgs(_args) != ERR_OK) {
-            ILog::report("ISolver.solve: error with setting args to problem\n");
             return ERR_ANY_OTHER;
         }
 
-        _curr = _params->clone();
-
-        if (!_curr) {
-            ILog::report("ISolver.solve: not enough memory\n");
-            return ERR_MEMORY_ALLOCATION;
-        }
+        double alpha = 1, lambda = 0.8;
 
         while (true) {
-            size_t paramsDim;
+            IVector *tmpMS = IVector::multiplyByScalar(gradV, alpha);
 
-            if (_problem->getParamsDim(paramsDim) != ERR_OK) {
-                ILog::report("ISolver.solve: error with getParamsDim\n");
+            if (!tmpMS) {
+                ILog::report("ISolver.solve: error with multiplyByScalar\n");
+                delete gradV;
                 return ERR_ANY_OTHER;
             }
 
-            double *gradD = new (std::nothrow) double[paramsDim];
+            IVector *tmpS = IVector::subtract(_curr, tmpMS);
 
-            if (!gradD) {
-                ILog::report("ISolver.solve: not enough memory\n");
-                return ERR_MEMORY_ALLOCATION;
-            }
+            delete tmpMS;
 
-            for (size_t i = 0; i < paramsDim; i++) {
-                if (_problem->derivativeGoalFunctionByParams(1,
-                                                           i,
-                                                           IProblem::BY_PARAMS,
-                                                           gradD[i],
-                                                           _curr) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with derivativeGoalFunctionByParams\n");
-                    delete[] gradD;
-                    return ERR_ANY_OTHER;
-                }
+            if (!tmpS) {
+                ILog::report("ISolver.solve: error with subtract\n");
+                delete gradV;
+                return ERR_ANY_OTHER;
             }
 
-            IVector *gradV = IVector::createVector(paramsDim, gradD);
+            IVector *prS;
 
-            if (!gradV) {
-                delete[] gradD;
-                ILog::report("ISolver.solve: not enough memory\n");
-                return ERR_MEMORY_ALLOCATION;
-            }
-
-            delete[] gradD;
-
-            double alpha = 1, lambda = 0.8;
-
-            while (true) {
-                IVector *tmpMS = IVector::multiplyByScalar(gradV, alpha);
-
-                if (!tmpMS) {
-                    ILog::report("ISolver.solve: error with multiplyByScalar\n");
-                    delete gradV;
-                    return ERR_ANY_OTHER;
-                }
-
-                IVector *tmpS = IVector::subtract(_curr, tmpMS);
-
-                if (!tmpS) {
-                    ILog::report("ISolver.solve: error with subtract\n");
-                    delete gradV;
-                    delete tmpMS;
-                    return ERR_ANY_OTHER;
-                }
-
-                IVector *prS;
-
-                if (_compact->getNearestNeighbor(tmpS, prS) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with getNearestNeighbor\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    return ERR_ANY_OTHER;
-                }
-
-                double resS, resC;
-
-                if (_problem->goalFunctionByParams(prS, resS) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with goalFunctionByArgs\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    delete prS;
-                    return ERR_ANY_OTHER;
-                }
-
-                if (_problem->goalFunctionByParams(_curr, resC) != ERR_OK) {
-                    ILog::report("ISolver.solve: error with goalFunctionByArgs\n");
-                    delete gradV;
-                    delete tmpMS;
-                    delete tmpS;
-                    delete prS;
-                    return ERR_ANY_OTHER;
-                }
-
-                if (resS <= resC) {
-                    delete _prev;
-                    _prev = _curr;
-                    _curr = prS;
-                    break;
-                } else {
-                    alpha *= lambda;
-                }
-
-                delete tmpMS;
+            if (project(tmpS, prS) != ERR_OK) {
+                ILog::report("ISolver.solve: error with projection onto compact\n");
+                delete gradV;
                 delete tmpS;
+                return ERR_ANY_OTHER;
             }
 
-            delete gradV;
+            delete tmpS;
 
-            bool res = false;
+            double resS;
 
-            if (_curr->eq(_prev, IVector::NORM_INF, res, eps) != ERR_OK) {
-                ILog::report("ISolver.solve: cannot compare two vectors\n");
+            if (goalFunction(prS, resS) != ERR_OK) {
+                ILog::report("ISolver.solve: error with goalFunction\n");
+                delete gradV;
+                delete prS;
                 return ERR_ANY_OTHER;
             }
-            if (res)
+
+            if (resS <= resC) {
+                delete _prev;
+                _prev = _curr;
+                _curr = prS;
                 break;
+            } else {
+                alpha *= lambda;
+            }
+
+            delete prS;
+        }
+
+        bool res = false;
+
+        if (_curr->eq(_prev, IVector::NORM_INF, res, eps) != ERR_OK) {
+            ILog::report("ISolver.solve: cannot compare two vectors\n");
+            delete gradV;
+            return ERR_ANY_OTHER;
         }
+        if (res)
+            break;
     }
+
+    delete gradV;
     return ERR_OK;
 }
 
 Solver1::Solver1():
-    _args(NULL), _params(NULL), _compact(NULL), _prev(NULL), _curr(NULL), _problem(NULL)
+    _args(NULL), _params(NULL), _compact(NULL), _projection(ICompact::PROJECTION_LATTICE), _projectionFallback(false), _cache(NULL), _prev(NULL), _curr(NULL), _problem(NULL)
  {}
 
+/*projection of every call is done in the mode set by setParams; compacts which don't support it
+  (or are of INTERFACE_0) are projected onto their lattice by getNearestNeighbor for this call only*/
+int Solver1::project(IVector const* vec, IVector* &res) {
+    int errCode = _compact->getId() >= ICompact::INTERFACE_1 ? _compact->getProjection(vec, _projection, res) : ERR_NOT_IMPLEMENTED;
+    if (errCode == ERR_NOT_IMPLEMENTED) {
+        if (!_projectionFallback) {
+            ILog::report("ISolver.solve: projection mode isn't supported by compact, nearest neighbor is used\n");
+            _projectionFallback = true;
+        }
+        errCode = _compact->getNearestNeighbor(vec, res);
+    }
+    return errCode;
+}
+
+/*projections onto lattice revisit the same points, so their values are looked up in cache,
+  which is created by the first point of lattice; points off lattice (and points of INTERFACE_0
+  compacts, which have no indices) are evaluated directly*/
+int Solver1::goalFunction(IVector const* vec, double& res) {
+    unsigned int index;
+    bool found = false;
+    int errCode;
+    if (_compact->getId() < ICompact::INTERFACE_1 || _compact->getIndexByPoint(vec, index) != ERR_OK) {
+        return solveByArgs ? _problem->goalFunctionByArgs(vec, res) : _problem->goalFunctionByParams(vec, res);
+    }
+    if (!_cache)
+        _cache = ILatticeCache::createCache(CACHE_CAPACITY);
+    if (_cache && _cache->find(index, res, found) == ERR_OK && found)
+        return ERR_OK;
+    errCode = solveByArgs ? _problem->goalFunctionByArgs(vec, res) : _problem->goalFunctionByParams(vec, res);
+    if (errCode == ERR_OK && _cache)
+        _cache->put(index, res);
+    return errCode;
+}
+
+/*problems of INTERFACE_0 have no fused method, their gradient is taken coordinate by coordinate*/
+int Solver1::valueAndGradient(IVector const* vec, double& res, IVector* grad) {
+    if (_problem->getId() >= IProblem::INTERFACE_1)
+        return solveByArgs ? _problem->valueAndGradientByArgs(vec, res, grad) : _problem->valueAndGradientByParams(vec, res, grad);
+    int errCode = goalFunction(vec, res);
+    for (unsigned int i = 0; i < grad->getDim() && errCode == ERR_OK; i++) {
+        double value;
+        errCode = solveByArgs ? _problem->derivativeGoalFunctionByArgs(1, i, IProblem::BY_ARGS, value, vec)
+                              : _problem->derivativeGoalFunctionByParams(1, i, IProblem::BY_PARAMS, value, vec);
+        if (errCode == ERR_OK)
+            errCode = grad->setCoord(i, value);
+    }
+    return errCode;
+}
+
 Solver1::~Solver1() {
     delete _args;
     delete _params;
     delete _prev;
     delete _curr;
     delete _compact;
+    delete _cache;
 }
 
 int Solver1::getId() const {
@@ -404,9 +324,10 @@ int Solver1::setParams(IVector const* params) {
         ILog::report("ISolver.setParams: Input parameter ptr is nullptr\n");
         return ERR_WRONG_ARG;
     }
-    unsigned int dim, dimArgs, dimParams, tmp;
+    unsigned int dim, dimArgs, dimParams, tmp, dimCompact;
     const double * coords;
     bool solveByArg;
+    ICompact::ProjectionType projection = ICompact::PROJECTION_LATTICE;
     double epsilon;
     IVector * args, * param, * begin, * end;
     ICompact * compact;
@@ -451,7 +372,16 @@ int Solver1::setParams(IVector const* params) {
     }
     solveByArg = static_cast<bool>(tmp);
     tmp = dimArgs + dimParams + 4;
-    if ((solveByArg && dim != tmp + 2 * dimArgs) || (!solveByArg && dim != tmp + 2 * dimParams)) {
+    dimCompact = tmp + 2 * (solveByArg ? dimArgs : dimParams);
+    /*optional last coord is projection flag: 0 - lattice (default), 1 - continuous*/
+    if (dim == dimCompact + 1) {
+        if (round(coords[dimCompact]) == 1) {
+            projection = ICompact::PROJECTION_CONTINUOUS;
+        } else if (round(coords[dimCompact]) != 0) {
+            ILog::report("ISolver.setParams: Wrong flag for projection\n");
+            return ERR_WRONG_ARG;
+        }
+    } else if (dim != dimCompact) {
         ILog::report("ISolver.setParams: Dimension of params is wrong\n");
         return ERR_WRONG_PROBLEM;
     }
@@ -499,6 +429,7 @@ int Solver1::setParams(IVector const* params) {
     _args = args;
     _params = param;
     _compact = compact;
+    _projection = projection;
     solveByArgs = solveByArg;
     eps = epsilon;
     return ERR_OK;
@@ -512,11 +443,23 @@ int Solver1::setParams(QString & str) {
     double epsilon;
     IVector * args, * param, * begin, * end;
     ICompact * compact;
+    ICompact::ProjectionType projection = ICompact::PROJECTION_LATTICE;
     QStringList preparams = str.split(" "), params, tmpList;
     if (preparams.count() < 4) {
         ILog::report("ISolver.setParams: Dimension of params less than 4\n");
         return ERR_WRONG_ARG;
     }
+    /*optional last param "projection:lattice" (default) or "projection:continuous"*/
+    tmpList = preparams.last().split(":");
+    if (tmpList.count() == 2 && QRegExp("[Pp][Rr][Oo][Jj][Ee][Cc][Tt][Ii][Oo][Nn]").exactMatch(tmpList.at(0))) {
+        if (QRegExp("[Cc][Oo][Nn][Tt][Ii][Nn][Uu][Oo][Uu][Ss]").exactMatch(tmpList.at(1))) {
+            projection = ICompact::PROJECTION_CONTINUOUS;
+        } else if (!QRegExp("[Ll][Aa][Tt][Tt][Ii][Cc][Ee]").exactMatch(tmpList.at(1))) {
+            ILog::report("ISolver.setParams: Wrong string for projection\n");
+            return ERR_WRONG_ARG;
+        }
+        preparams.removeLast();
+    }
     foreach (QString s, preparams) {
         tmpList = s.split(":");
         if (tmpList.count() != 2) {
@@ -686,6 +629,7 @@ int Solver1::setParams(QString & str) {
     _args = args;
     _params = param;
     _compact = compact;
+    _projection = projection;
     solveByArgs = solveByArg;
     eps = epsilon;
     return ERR_OK;
@@ -0,0 +1,7 @@
+TARGET = compact
+include(../library.pri)
+
+SOURCES += \
+    ../Compact.cpp \
+    ../Polytope.cpp \
+    ../LatticeCache.cpp
@@ -0,0 +1,4 @@
+TARGET = expressionproblem
+include(../library.pri)
+
+SOURCES += ../ExpressionProblem.cpp
@@ -0,0 +1,12 @@
+QT       -= gui
+
+QMAKE_CXXFLAGS += -std=gnu++0x
+
+TEMPLATE = lib
+
+DEFINES += DLL_LIBRARY
+INCLUDEPATH += $$PWD/.. $$PWD
+
+# libraries go next to prebuilt log and vector ones
+DESTDIR = $$PWD/../dll
+LIBS += $$PWD/../dll/log.dll $$PWD/../dll/vector.dll
@@ -0,0 +1,8 @@
+TARGET = problem
+include(../library.pri)
+
+QT += concurrent
+
+SOURCES += \
+    ../FiniteDifferenceProblem.cpp \
+    ../ProblemCache.cpp
@@ -0,0 +1,4 @@
+TARGET = problem1
+include(../library.pri)
+
+SOURCES += ../Problem1.cpp
@@ -0,0 +1,11 @@
+TARGET = set
+include(../library.pri)
+
+SOURCES += \
+    ../ISetImpl.cpp \
+    ../ConcurrentSet.cpp \
+    ../PrioritySet.cpp \
+    ../ParetoSet.cpp \
+    ../MappedSet.cpp \
+    ../SetIterators.cpp \
+    ../PointIndex.cpp
@@ -0,0 +1,6 @@
+TARGET = solver1
+include(../library.pri)
+
+LIBS += $$DESTDIR/compact.dll
+
+SOURCES += ../Solver1.cpp
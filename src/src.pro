@@ -0,0 +1,11 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    compact \
+    set \
+    problem \
+    problem1 \
+    expressionproblem \
+    solver1
+
+solver1.depends = compact
@@ -0,0 +1,19 @@
+QT       += core testlib concurrent
+QT       -= gui
+
+QMAKE_CXXFLAGS += -std=gnu++0x
+
+TARGET = tst_compact
+CONFIG += console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+
+DEFINES += DLL_LIBRARY
+INCLUDEPATH += ../.. ../../src
+
+SOURCES += tst_compact.cpp \
+    ../../src/Compact.cpp \
+    ../../src/Polytope.cpp \
+    ../../src/LatticeCache.cpp \
+    ../../src/Vector.cpp \
+    ../../src/Log.cpp
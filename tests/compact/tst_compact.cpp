@@ -0,0 +1,468 @@
+#include <cmath>
+#include <QtTest>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include "ICompact.h"
+#include "ILatticeCache.h"
+#include "IVector.h"
+
+class CompactTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void sobolStartsWithKnownPoints();
+    void sobolStrideSplitsSequence();
+    void haltonUsesPrimeBases();
+    void intersectionIsBox();
+    void unionContainsOperands();
+    void differenceExcludesRight();
+    void disjointIntersectionIsEmpty();
+    void polytopeProjectsOntoFacets();
+    void polytopeLatticeIsCut();
+    void polytopeProjectsFromSeveralThreads();
+    void latticeCacheCountsHitsAndMisses();
+    void latticeCacheOverwritesWhenFull();
+    void mortonOrderInterleavesAxes();
+    void mortonIndexRoundTrips();
+
+private:
+    ICompact* box(double x0, double y0, double x1, double y1) const;
+    ICompact* triangle() const;
+
+    IVector *_step;
+};
+
+namespace {
+
+IVector* point(double x, double y)
+{
+    double coords[2] = {x, y};
+    return IVector::createVector(2, coords);
+}
+
+void coords(ICompact* compact, ICompact::IIterator* it, double& x, double& y)
+{
+    IVector *item = NULL;
+    QCOMPARE(compact->getByIterator(it, item), (int)ERR_OK);
+    item->getCoord(0, x);
+    item->getCoord(1, y);
+    delete item;
+}
+
+/*continuous projection of (x, y) computed by one of threads*/
+struct Projection
+{
+    ICompact const* compact;
+    double x, y;
+    double px, py;
+    int errCode;
+};
+
+void project(Projection& projection)
+{
+    IVector *vec = point(projection.x, projection.y), *nn = NULL;
+    projection.errCode = projection.compact->getProjection(vec, ICompact::PROJECTION_CONTINUOUS, nn);
+    if (projection.errCode == ERR_OK) {
+        nn->getCoord(0, projection.px);
+        nn->getCoord(1, projection.py);
+        delete nn;
+    }
+    delete vec;
+}
+
+bool contains(ICompact const* compact, double x, double y)
+{
+    IVector *vec = point(x, y);
+    bool result = false;
+    compact->isContains(vec, result);
+    delete vec;
+    return result;
+}
+
+}
+
+/*unit square sampled by 11 points per axis*/
+ICompact* CompactTest::box(double x0, double y0, double x1, double y1) const
+{
+    IVector *begin = point(x0, y0), *end = point(x1, y1);
+    ICompact *compact = ICompact::createCompact(begin, end, _step);
+    delete begin;
+    delete end;
+    return compact;
+}
+
+/*unit square cut by x + y <= 1*/
+ICompact* CompactTest::triangle() const
+{
+    IVector *begin = point(0, 0), *end = point(1, 1), *normal = point(1, 1);
+    double one = 1;
+    IVector *offset = IVector::createVector(1, &one);
+    ICompact *compact = ICompact::createPolytope(begin, end, 1, &normal, offset, _step);
+    delete begin;
+    delete end;
+    delete normal;
+    delete offset;
+    return compact;
+}
+
+void CompactTest::init()
+{
+    _step = point(11, 11);
+}
+
+void CompactTest::cleanup()
+{
+    delete _step;
+}
+
+void CompactTest::sobolStartsWithKnownPoints()
+{
+    ICompact *compact = box(0, 0, 1, 1);
+    ICompact::IIterator *it = compact->beginSequence(ICompact::SEQUENCE_SOBOL);
+    QVERIFY(it);
+
+    double const expected[][2] = {{0, 0}, {0.5, 0.5}, {0.75, 0.25}, {0.25, 0.75}, {0.375, 0.375}};
+    for (int i = 0; i < 5; i++) {
+        double x, y;
+        coords(compact, it, x, y);
+        QCOMPARE(x, expected[i][0]);
+        QCOMPARE(y, expected[i][1]);
+        QCOMPARE(it->doStep(), (int)ERR_OK);
+    }
+    compact->deleteIterator(it);
+    delete compact;
+}
+
+void CompactTest::sobolStrideSplitsSequence()
+{
+    ICompact *compact = box(0, 0, 1, 1);
+    ICompact::IIterator *whole = compact->beginSequence(ICompact::SEQUENCE_SOBOL);
+    ICompact::IIterator *odd = compact->beginSequence(ICompact::SEQUENCE_SOBOL, 1, 2);
+
+    whole->doStep();
+    for (int i = 0; i < 4; i++) {
+        double x, y, ox, oy;
+        coords(compact, whole, x, y);
+        coords(compact, odd, ox, oy);
+        QCOMPARE(ox, x);
+        QCOMPARE(oy, y);
+        whole->doStep();
+        whole->doStep();
+        odd->doStep();
+    }
+    compact->deleteIterator(whole);
+    compact->deleteIterator(odd);
+    delete compact;
+}
+
+void CompactTest::haltonUsesPrimeBases()
+{
+    ICompact *compact = box(0, 0, 1, 1);
+    ICompact::IIterator *it = compact->beginSequence(ICompact::SEQUENCE_HALTON, 1);
+
+    double x, y;
+    coords(compact, it, x, y);
+    QCOMPARE(x, 0.5);
+    QCOMPARE(y, 1.0 / 3);
+    it->doStep();
+    coords(compact, it, x, y);
+    QCOMPARE(x, 0.25);
+    QCOMPARE(y, 2.0 / 3);
+    compact->deleteIterator(it);
+    delete compact;
+}
+
+void CompactTest::intersectionIsBox()
+{
+    ICompact *left = box(0, 0, 1, 1), *right = box(0.5, 0.5, 2, 2);
+    ICompact *result = ICompact::Intersection(left, right);
+    QVERIFY(result);
+
+    IVector *begin, *end;
+    QCOMPARE(result->getBoundingBox(begin, end), (int)ERR_OK);
+    double x0, y0, x1, y1;
+    begin->getCoord(0, x0);
+    begin->getCoord(1, y0);
+    end->getCoord(0, x1);
+    end->getCoord(1, y1);
+    QCOMPARE(x0, 0.5);
+    QCOMPARE(y0, 0.5);
+    QCOMPARE(x1, 1.0);
+    QCOMPARE(y1, 1.0);
+
+    bool subset;
+    result->isSubSet(left, subset);
+    QVERIFY(subset);
+    result->isSubSet(right, subset);
+    QVERIFY(subset);
+    delete begin;
+    delete end;
+    delete result;
+    delete left;
+    delete right;
+}
+
+void CompactTest::unionContainsOperands()
+{
+    ICompact *left = box(0, 0, 1, 1), *right = box(0.5, 0.5, 2, 2);
+    ICompact *result = ICompact::Union(left, right);
+    QVERIFY(result);
+
+    bool subset;
+    left->isSubSet(result, subset);
+    QVERIFY(subset);
+    right->isSubSet(result, subset);
+    QVERIFY(subset);
+    result->isSubSet(left, subset);
+    QVERIFY(!subset);
+    QVERIFY(!contains(result, 1.5, 0.2));
+    delete result;
+    delete left;
+    delete right;
+}
+
+void CompactTest::differenceExcludesRight()
+{
+    ICompact *left = box(0, 0, 1, 1), *right = box(0.5, 0.5, 2, 2);
+    ICompact *result = ICompact::Difference(left, right);
+    QVERIFY(result);
+
+    QVERIFY(contains(result, 0.2, 0.9));
+    QVERIFY(contains(result, 0.9, 0.2));
+    QVERIFY(!contains(result, 0.9, 0.9));
+
+    bool subset;
+    result->isSubSet(left, subset);
+    QVERIFY(subset);
+    delete result;
+    delete left;
+    delete right;
+}
+
+void CompactTest::disjointIntersectionIsEmpty()
+{
+    ICompact *left = box(0, 0, 1, 1), *right = box(2, 2, 3, 3);
+    ICompact *result = ICompact::Intersection(left, right);
+    QVERIFY(result);
+
+    IVector *begin = NULL, *end = NULL;
+    QCOMPARE(result->getBoundingBox(begin, end), (int)ERR_OUT_OF_RANGE);
+    QVERIFY(!result->begin());
+    delete result;
+    delete left;
+    delete right;
+}
+
+void CompactTest::polytopeProjectsOntoFacets()
+{
+    ICompact *compact = triangle();
+    QVERIFY(compact);
+
+    double const points[][4] = {{1, 1, 0.5, 0.5}, {2, -1, 1, 0}, {0.2, 0.3, 0.2, 0.3}, {-1, -1, 0, 0}, {0.9, 0.8, 0.55, 0.45}};
+    for (int i = 0; i < 5; i++) {
+        Projection projection = {compact, points[i][0], points[i][1], 0, 0, ERR_ANY_OTHER};
+        project(projection);
+        QCOMPARE(projection.errCode, (int)ERR_OK);
+        QVERIFY(std::fabs(projection.px - points[i][2]) < 1e-9);
+        QVERIFY(std::fabs(projection.py - points[i][3]) < 1e-9);
+    }
+
+    IVector *vec = point(0.9, 0.8), *nn = NULL;
+    QCOMPARE(compact->getNearestNeighbor(vec, nn), (int)ERR_OK);
+    double x, y;
+    nn->getCoord(0, x);
+    nn->getCoord(1, y);
+    QVERIFY(x + y <= 1 + 1e-9);
+    QVERIFY(contains(compact, x, y));
+    delete nn;
+    delete vec;
+    delete compact;
+}
+
+void CompactTest::polytopeLatticeIsCut()
+{
+    ICompact *compact = triangle();
+    ICompact::IIterator *it = compact->begin();
+    QVERIFY(it);
+
+    int count = 1;
+    while (it->doStep() == ERR_OK)
+        count++;
+    QCOMPARE(count, 66);
+    compact->deleteIterator(it);
+
+    QVERIFY(contains(compact, 0.5, 0.5));
+    QVERIFY(!contains(compact, 0.6, 0.5));
+
+    IVector *begin, *end;
+    QCOMPARE(compact->getBoundingBox(begin, end), (int)ERR_OK);
+    double x1, y1;
+    end->getCoord(0, x1);
+    end->getCoord(1, y1);
+    QCOMPARE(x1, 1.0);
+    QCOMPARE(y1, 1.0);
+    delete begin;
+    delete end;
+    delete compact;
+}
+
+void CompactTest::polytopeProjectsFromSeveralThreads()
+{
+    ICompact *compact = triangle();
+    QVector<Projection> serial, parallel;
+    for (int i = 0; i < 32; i++) {
+        Projection projection = {compact, 2 * std::cos(0.4 * i), 2 * std::sin(0.7 * i), 0, 0, ERR_ANY_OTHER};
+        serial.append(projection);
+    }
+    parallel = serial;
+    for (int i = 0; i < serial.size(); i++)
+        project(serial[i]);
+
+    /*warm start of one projection must not leak into results of others*/
+    QtConcurrent::blockingMap(parallel, project);
+    for (int i = 0; i < serial.size(); i++) {
+        QCOMPARE(parallel[i].errCode, (int)ERR_OK);
+        QVERIFY(std::fabs(parallel[i].px - serial[i].px) < 1e-9);
+        QVERIFY(std::fabs(parallel[i].py - serial[i].py) < 1e-9);
+    }
+    delete compact;
+}
+
+void CompactTest::latticeCacheCountsHitsAndMisses()
+{
+    ILatticeCache *cache = ILatticeCache::createCache(128);
+    QVERIFY(cache);
+
+    for (unsigned int i = 0; i < 50; i++)
+        QCOMPARE(cache->put(7 * i, i), (int)ERR_OK);
+    QCOMPARE(cache->put(0, -1.0), (int)ERR_OK);
+
+    double value;
+    bool found;
+    for (unsigned int i = 0; i < 50; i++) {
+        QCOMPARE(cache->find(7 * i, value, found), (int)ERR_OK);
+        QVERIFY(found);
+        QCOMPARE(value, i == 0 ? -1.0 : i);
+    }
+    QCOMPARE(cache->find(8, value, found), (int)ERR_OK);
+    QVERIFY(!found);
+    QCOMPARE(cache->getHits(), 50u);
+    QCOMPARE(cache->getMisses(), 1u);
+
+    QCOMPARE(cache->find(0xFFFFFFFFu, value, found), (int)ERR_OUT_OF_RANGE);
+    QCOMPARE(cache->clear(), (int)ERR_OK);
+    QCOMPARE(cache->find(7, value, found), (int)ERR_OK);
+    QVERIFY(!found);
+    QCOMPARE(cache->getHits(), 0u);
+    QCOMPARE(cache->getMisses(), 1u);
+    delete cache;
+}
+
+void CompactTest::latticeCacheOverwritesWhenFull()
+{
+    ILatticeCache *cache = ILatticeCache::createCache(20);
+    for (unsigned int i = 0; i < 1000; i++)
+        QCOMPARE(cache->put(i, 2.0 * i), (int)ERR_OK);
+
+    /*table is bounded by capacity rounded up to power of two, overwritten slots get values of their new keys*/
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < 1000; i++) {
+        double value;
+        bool found;
+        cache->find(i, value, found);
+        if (found) {
+            QCOMPARE(value, 2.0 * i);
+            kept++;
+        }
+    }
+    QVERIFY(kept > 0 && kept <= 32);
+    QCOMPARE(cache->getHits(), kept);
+    delete cache;
+}
+
+void CompactTest::mortonOrderInterleavesAxes()
+{
+    IVector *step = point(3, 5);
+    IVector *begin = point(0, 0), *end = point(2, 4);
+    ICompact *compact = ICompact::createCompact(begin, end, step);
+    QCOMPARE(compact->setIndexOrder(ICompact::ORDER_MORTON), (int)ERR_OK);
+
+    /*bits of axes alternate starting from the first one, indices out of lattice are skipped*/
+    double const expected[][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}, {2, 0}, {2, 1}, {0, 2}, {1, 2},
+                                  {0, 3}, {1, 3}, {2, 2}, {2, 3}, {0, 4}, {1, 4}, {2, 4}};
+    ICompact::IIterator *it = compact->begin();
+    for (int i = 0; i < 15; i++) {
+        double x, y;
+        coords(compact, it, x, y);
+        QCOMPARE(x, expected[i][0]);
+        QCOMPARE(y, expected[i][1]);
+        QCOMPARE(it->doStep(), i < 14 ? (int)ERR_OK : (int)ERR_OUT_OF_RANGE);
+    }
+    compact->deleteIterator(it);
+
+    it = compact->end();
+    double x, y;
+    coords(compact, it, x, y);
+    QCOMPARE(x, 2.0);
+    QCOMPARE(y, 4.0);
+    compact->deleteIterator(it);
+    delete compact;
+    delete begin;
+    delete end;
+    delete step;
+}
+
+void CompactTest::mortonIndexRoundTrips()
+{
+    IVector *step = point(3, 5);
+    IVector *begin = point(0, 0), *end = point(2, 4);
+    ICompact *compact = ICompact::createCompact(begin, end, step);
+    QCOMPARE(compact->setIndexOrder(ICompact::ORDER_MORTON), (int)ERR_OK);
+
+    unsigned int index;
+    IVector *vec = point(2, 4);
+    QCOMPARE(compact->getIndexByPoint(vec, index), (int)ERR_OK);
+    QCOMPARE(index, 20u);
+    delete vec;
+
+    ICompact::IIterator *it = compact->begin();
+    do {
+        IVector *item = NULL;
+        QCOMPARE(compact->getByIterator(it, item), (int)ERR_OK);
+        QCOMPARE(compact->getIndexByPoint(item, index), (int)ERR_OK);
+        IVector *back = compact->getPointByIndex(index);
+        QVERIFY(back);
+        for (unsigned int i = 0; i < 2; i++) {
+            double a, b;
+            item->getCoord(i, a);
+            back->getCoord(i, b);
+            QCOMPARE(a, b);
+        }
+        delete back;
+        delete item;
+    } while (it->doStep() == ERR_OK);
+    compact->deleteIterator(it);
+
+    /*gap of Morton index isn't a point of lattice*/
+    QVERIFY(!compact->getPointByIndex(5));
+
+    ICompact *copy = compact->clone();
+    vec = point(0, 3);
+    QCOMPARE(copy->getIndexByPoint(vec, index), (int)ERR_OK);
+    QCOMPARE(index, 10u);
+    delete vec;
+    delete copy;
+    delete compact;
+    delete begin;
+    delete end;
+    delete step;
+}
+
+QTEST_APPLESS_MAIN(CompactTest)
+
+#include "tst_compact.moc"
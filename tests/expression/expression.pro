@@ -0,0 +1,17 @@
+QT       += core testlib
+QT       -= gui
+
+QMAKE_CXXFLAGS += -std=gnu++0x
+
+TARGET = tst_expression
+CONFIG += console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+
+DEFINES += DLL_LIBRARY
+INCLUDEPATH += ../.. ../../src
+
+SOURCES += tst_expression.cpp \
+    ../../src/ExpressionProblem.cpp \
+    ../../src/Vector.cpp \
+    ../../src/Log.cpp
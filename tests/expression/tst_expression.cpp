@@ -0,0 +1,321 @@
+#include <cmath>
+#include <clocale>
+#include <QtTest>
+#include <QByteArray>
+#include <QVector>
+
+#include "IBrocker.h"
+#include "IProblem.h"
+#include "IVector.h"
+
+extern "C" void* getExpressionBrocker(char const* formula);
+extern "C" void* getNativeExpressionBrocker(char const* formula);
+
+/*problem of formula with args and params fixed, released with the test case;
+  native problem falls back to bytecode if there is no compiler*/
+class Formula {
+
+public:
+
+    Formula(char const* formula, double const* params = NULL, size_t paramsDim = 0, bool native = false):
+        _brocker(static_cast<IBrocker*>(native ? getNativeExpressionBrocker(formula) : getExpressionBrocker(formula))),
+        _problem(NULL)
+    {
+        if (!_brocker)
+            return;
+        _problem = static_cast<IProblem*>(_brocker->getInterfaceImpl(IBrocker::PROBLEM));
+        _problem->bindParams(params, paramsDim);
+    }
+
+    ~Formula()
+    {
+        if (_brocker)
+            _brocker->release();
+    }
+
+    IProblem* operator->() const { return _problem; }
+    bool isValid() const { return _problem != NULL; }
+
+    double value(double const* args) const
+    {
+        double res = NAN;
+        _problem->goalFunctionByArgsBatch(1, args, &res);
+        return res;
+    }
+
+private:
+
+    IBrocker *_brocker;
+    IProblem *_problem;
+
+};
+
+/*LC_NUMERIC with decimal comma while alive, if the system has such locale*/
+class CommaLocale {
+
+public:
+
+    CommaLocale():
+        _saved(setlocale(LC_NUMERIC, NULL)), _active(false)
+    {
+        char const* names[] = {"de_DE.UTF-8", "de_DE.utf8", "ru_RU.UTF-8", "ru_RU.utf8", "fr_FR.UTF-8", "fr_FR.utf8"};
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]) && !_active; i++)
+            _active = setlocale(LC_NUMERIC, names[i]) && *localeconv()->decimal_point == ',';
+    }
+
+    ~CommaLocale()
+    {
+        setlocale(LC_NUMERIC, _saved.constData());
+    }
+
+    bool isActive() const { return _active; }
+
+private:
+
+    QByteArray _saved;
+    bool _active;
+
+};
+
+class ExpressionProblemTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unaryMinusIsAppliedAfterPower();
+    void powerIsRightAssociative();
+    void constantsAreFolded();
+    void equalSubexpressionsCancel();
+    void gradientAndHessianAreSymbolic();
+    void higherDerivativesAreBuiltOnDemand();
+    void sparsityHasStructuralZeros();
+    void batchesLongerThanBlockMatchSinglePoints();
+    void registersAreReusedByProblemsOfOtherSize();
+    void wrongFormulaIsRejected();
+    void numbersAreParsedUnderCommaLocale();
+    void nativeCodeIsBuiltUnderCommaLocale();
+    void nativeCodeMatchesBytecode();
+};
+
+void ExpressionProblemTest::unaryMinusIsAppliedAfterPower()
+{
+    Formula f("-x0^2");
+    QVERIFY(f.isValid());
+
+    double x = 3;
+    QCOMPARE(f.value(&x), -9.0);
+}
+
+void ExpressionProblemTest::powerIsRightAssociative()
+{
+    Formula f("2^3^2 + 0 * x0");
+    QVERIFY(f.isValid());
+
+    double x = 1;
+    QCOMPARE(f.value(&x), 512.0);
+}
+
+void ExpressionProblemTest::constantsAreFolded()
+{
+    Formula f("(1 + 2) * 4 + x0 * (6 / 3 - 1)");
+    QVERIFY(f.isValid());
+
+    size_t count, *rows, *cols;
+    QCOMPARE(f->getHessianSparsity(IProblem::BY_ARGS, count, rows, cols), (int)ERR_OK);
+    QCOMPARE(count, (size_t)0);
+    delete[] rows;
+    delete[] cols;
+
+    double x = 5;
+    QCOMPARE(f.value(&x), 17.0);
+}
+
+void ExpressionProblemTest::equalSubexpressionsCancel()
+{
+    Formula f("(2 + 3) * x0 - x0 * 5");
+    QVERIFY(f.isValid());
+
+    double x = 7, grad = 1;
+    IVector *args = IVector::createVector(1, &x), *g = IVector::createVector(1, &grad);
+    QCOMPARE(f->gradientByArgs(args, g), (int)ERR_OK);
+    QCOMPARE(g->getCoord(0, grad), (int)ERR_OK);
+    QCOMPARE(grad, 0.0);
+    QCOMPARE(f.value(&x), 0.0);
+    delete args;
+    delete g;
+}
+
+void ExpressionProblemTest::gradientAndHessianAreSymbolic()
+{
+    double p[2] = {1, 100}, a[2] = {-1.2, 1};
+    Formula f("(p0 - x0)^2 + p1 * (x1 - x0^2)^2", p, 2);
+    QVERIFY(f.isValid());
+
+    double x = a[0], y = a[1], value, grad[2], hessian[4];
+    IVector *args = IVector::createVector(2, a), *g = IVector::createVector(2, a);
+    QCOMPARE(f->valueAndGradientByArgs(args, value, g), (int)ERR_OK);
+    g->getCoord(0, grad[0]);
+    g->getCoord(1, grad[1]);
+    QCOMPARE(value, (1 - x) * (1 - x) + 100 * (y - x * x) * (y - x * x));
+    QCOMPARE(grad[0], -2 * (1 - x) - 400 * x * (y - x * x));
+    QCOMPARE(grad[1], 200 * (y - x * x));
+
+    QCOMPARE(f->hessianByArgs(args, hessian), (int)ERR_OK);
+    QCOMPARE(hessian[0], 2 - 400 * (y - 3 * x * x));
+    QCOMPARE(hessian[1], -400 * x);
+    QCOMPARE(hessian[2], -400 * x);
+    QCOMPARE(hessian[3], 200.0);
+
+    double d2;
+    QCOMPARE(f->derivativeGoalFunctionByArgs(2, 1, IProblem::BY_ARGS, d2, args), (int)ERR_OK);
+    QCOMPARE(d2, 200.0);
+    delete args;
+    delete g;
+}
+
+void ExpressionProblemTest::higherDerivativesAreBuiltOnDemand()
+{
+    double p = 0, a = 0.5, d3, d4;
+    Formula f("sin(x0) * exp(p0)", &p, 1);
+    QVERIFY(f.isValid());
+
+    IVector *args = IVector::createVector(1, &a);
+    QCOMPARE(f->derivativeGoalFunctionByArgs(3, 0, IProblem::BY_ARGS, d3, args), (int)ERR_OK);
+    QCOMPARE(f->derivativeGoalFunctionByArgs(4, 0, IProblem::BY_ARGS, d4, args), (int)ERR_OK);
+    QCOMPARE(d3, -std::cos(a));
+    QCOMPARE(d4, std::sin(a));
+    delete args;
+}
+
+void ExpressionProblemTest::sparsityHasStructuralZeros()
+{
+    Formula f("x0 * x1 + x2^3");
+    QVERIFY(f.isValid());
+
+    size_t count, *rows, *cols;
+    QCOMPARE(f->getHessianSparsity(IProblem::BY_ARGS, count, rows, cols), (int)ERR_OK);
+    QCOMPARE(count, (size_t)2);
+    QCOMPARE(rows[0], (size_t)0);
+    QCOMPARE(cols[0], (size_t)1);
+    QCOMPARE(rows[1], (size_t)2);
+    QCOMPARE(cols[1], (size_t)2);
+    delete[] rows;
+    delete[] cols;
+}
+
+void ExpressionProblemTest::batchesLongerThanBlockMatchSinglePoints()
+{
+    double p = 2;
+    Formula f("atan(x0 * p0) + sqrt(x1^2 + 1) / (1 + abs(x0))", &p, 1);
+    QVERIFY(f.isValid());
+
+    int const count = 201;
+    QVector<double> points(2 * count), values(count);
+    for (int i = 0; i < count; i++) {
+        points[2 * i] = 0.1 * i - 10;
+        points[2 * i + 1] = 0.05 * i;
+    }
+
+    QCOMPARE(f->goalFunctionByArgsBatch(count, points.constData(), values.data()), (int)ERR_OK);
+    for (int i = 0; i < count; i++)
+        QCOMPARE(values[i], f.value(points.constData() + 2 * i));
+}
+
+void ExpressionProblemTest::registersAreReusedByProblemsOfOtherSize()
+{
+    Formula small("x0 + 1"), large("exp(x0) * sin(x0) + cos(x0) * log(x0 + 2) + x0^5 - atan(x0 * x0)");
+    QVERIFY(small.isValid() && large.isValid());
+
+    double x = 0.75, expected = std::exp(x) * std::sin(x) + std::cos(x) * std::log(x + 2) + std::pow(x, 5) - std::atan(x * x);
+    for (int i = 0; i < 3; i++) {
+        QCOMPARE(large.value(&x), expected);
+        QCOMPARE(small.value(&x), x + 1);
+    }
+}
+
+void ExpressionProblemTest::wrongFormulaIsRejected()
+{
+    QVERIFY(!getExpressionBrocker("x0 +"));
+    QVERIFY(!getExpressionBrocker("foo(x0)"));
+    QVERIFY(!getExpressionBrocker("(x0"));
+}
+
+void ExpressionProblemTest::numbersAreParsedUnderCommaLocale()
+{
+    CommaLocale locale;
+    if (!locale.isActive())
+        QSKIP("There is no locale with decimal comma");
+
+    Formula f("0.5 * x0 + 1.5e1 - .25");
+    QVERIFY(f.isValid());
+
+    double x = 3;
+    QCOMPARE(f.value(&x), 16.25);
+}
+
+void ExpressionProblemTest::nativeCodeIsBuiltUnderCommaLocale()
+{
+    CommaLocale locale;
+    if (!locale.isActive())
+        QSKIP("There is no locale with decimal comma");
+
+    /*constants of emitted source are in C locale, "0,5" would compile as comma operator*/
+    Formula f("0.5 * x0 + 0.25 * x0^2", NULL, 0, true);
+    QVERIFY(f.isValid());
+
+    double x = 3;
+    QCOMPARE(f.value(&x), 3.75);
+
+    double value, grad;
+    IVector *args = IVector::createVector(1, &x), *g = IVector::createVector(1, &x);
+    QCOMPARE(f->valueAndGradientByArgs(args, value, g), (int)ERR_OK);
+    g->getCoord(0, grad);
+    QCOMPARE(value, 3.75);
+    QCOMPARE(grad, 2.0);
+    delete args;
+    delete g;
+}
+
+void ExpressionProblemTest::nativeCodeMatchesBytecode()
+{
+    double p[2] = {1, 100};
+    char const* formula = "(p0 - x0)^2 + p1 * (x1 - x0^2)^2 + exp(-x0 * x1) / (1 + x1^2)";
+    Formula bytecode(formula, p, 2), native(formula, p, 2, true);
+    QVERIFY(bytecode.isValid() && native.isValid());
+
+    int const count = 67;
+    QVector<double> points(2 * count), values(count), expected(count);
+    for (int i = 0; i < count; i++) {
+        points[2 * i] = 0.03 * i - 1;
+        points[2 * i + 1] = 1.5 - 0.02 * i;
+    }
+    QCOMPARE(native->goalFunctionByArgsBatch(count, points.constData(), values.data()), (int)ERR_OK);
+    QCOMPARE(bytecode->goalFunctionByArgsBatch(count, points.constData(), expected.data()), (int)ERR_OK);
+    QCOMPARE(values, expected);
+
+    double nativeHessian[4], bytecodeHessian[4];
+    IVector *args = IVector::createVector(2, points.data()), *g = IVector::createVector(2, p), *h = IVector::createVector(2, p);
+    for (int i = 0; i < count; i += 11) {
+        double a[2], b[2], value, expectedValue;
+        QCOMPARE(args->setAllCoords(2, points.data() + 2 * i), (int)ERR_OK);
+        QCOMPARE(native->valueAndGradientByArgs(args, value, g), (int)ERR_OK);
+        QCOMPARE(bytecode->valueAndGradientByArgs(args, expectedValue, h), (int)ERR_OK);
+        QCOMPARE(value, expectedValue);
+        for (unsigned int j = 0; j < 2; j++) {
+            g->getCoord(j, a[j]);
+            h->getCoord(j, b[j]);
+            QCOMPARE(a[j], b[j]);
+        }
+        QCOMPARE(native->hessianByArgs(args, nativeHessian), (int)ERR_OK);
+        QCOMPARE(bytecode->hessianByArgs(args, bytecodeHessian), (int)ERR_OK);
+        for (int j = 0; j < 4; j++)
+            QCOMPARE(nativeHessian[j], bytecodeHessian[j]);
+    }
+    delete args;
+    delete g;
+    delete h;
+}
+
+QTEST_APPLESS_MAIN(ExpressionProblemTest)
+
+#include "tst_expression.moc"
@@ -0,0 +1,19 @@
+QT       += core testlib concurrent
+QT       -= gui
+
+QMAKE_CXXFLAGS += -std=gnu++0x
+
+TARGET = tst_problem
+CONFIG += console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+
+DEFINES += DLL_LIBRARY
+INCLUDEPATH += ../.. ../../src
+
+SOURCES += tst_problem.cpp \
+    ../../src/Problem1.cpp \
+    ../../src/FiniteDifferenceProblem.cpp \
+    ../../src/ProblemCache.cpp \
+    ../../src/Vector.cpp \
+    ../../src/Log.cpp
@@ -0,0 +1,675 @@
+#include <cmath>
+#include <QtTest>
+
+#include "Dual.h"
+#include "IBrocker.h"
+#include "IProblem.h"
+#include "IProblemCache.h"
+#include "IVector.h"
+
+extern "C" void* getBrocker();
+
+class ProblemTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dualGradientIsExact();
+    void dualGradientTakesSeveralPasses();
+    void dualPowerOfNonPositiveBase();
+    void dualPowerByExponent();
+    void defaultBatchEvaluatesPointByPoint();
+    void problemBatchMatchesSinglePoints();
+    void defaultGradientTakesDerivativesByCoordinates();
+    void problemGradientIsFused();
+    void defaultHessianIsNotImplemented();
+    void defaultProductUsesWholeHessian();
+    void problemHessianIsDiagonal();
+    void finiteDifferencesApproximateDerivatives();
+    void finiteDifferencesRunOnSeveralThreads();
+    void finiteDifferencesWrapLegacyProblem();
+    void boundParamsAreReadWithoutCopy();
+    void workersEvaluateIndependently();
+    void cacheAnswersRepeatedPoints();
+    void cacheDropsLeastRecentlyUsed();
+};
+
+namespace {
+
+/*(x - p)^2 summed over 3 coordinates, only methods of INTERFACE_0 are implemented,
+  so the rest are default adapters of IProblem; calls of goal function and derivatives are counted*/
+class Paraboloid : public IProblem
+{
+public:
+    static const size_t DIM = 3;
+
+    Paraboloid(): goalCalls(0), derivativeCalls(0)
+    {
+        for (size_t i = 0; i < DIM; i++) {
+            _args[i] = 0;
+            _params[i] = i + 1.0;
+        }
+    }
+
+    int getId() const { return IProblem::INTERFACE_1; }
+
+    int goalFunction(IVector const* args, IVector const* params, double& res) const
+    {
+        double const *x, *p;
+        int errCode = getCoords(args, x);
+        if (errCode == ERR_OK)
+            errCode = getCoords(params, p);
+        if (errCode == ERR_OK) {
+            goalCalls++;
+            res = 0;
+            for (size_t i = 0; i < DIM; i++)
+                res += (x[i] - p[i]) * (x[i] - p[i]);
+        }
+        return errCode;
+    }
+    int goalFunctionByArgs(IVector const* args, double& res) const
+    {
+        IVector *params = IVector::createVector(DIM, const_cast<double*>(_params));
+        int errCode = goalFunction(args, params, res);
+        delete params;
+        return errCode;
+    }
+    int goalFunctionByParams(IVector const* params, double& res) const
+    {
+        IVector *args = IVector::createVector(DIM, const_cast<double*>(_args));
+        int errCode = goalFunction(args, params, res);
+        delete args;
+        return errCode;
+    }
+    int getArgsDim(size_t& dim) const
+    {
+        dim = DIM;
+        return ERR_OK;
+    }
+    int getParamsDim(size_t& dim) const
+    {
+        dim = DIM;
+        return ERR_OK;
+    }
+
+    int setParams(IVector const* params)
+    {
+        return copyCoords(params, _params);
+    }
+    int setArgs(IVector const* args)
+    {
+        return copyCoords(args, _args);
+    }
+
+    int derivativeGoalFunction(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args, IVector const* params) const
+    {
+        double const *x, *p;
+        int errCode = getCoords(args, x);
+        if (errCode == ERR_OK)
+            errCode = getCoords(params, p);
+        if (errCode != ERR_OK)
+            return errCode;
+        if (idx >= DIM || order == 0 || order > 2)
+            return ERR_WRONG_ARG;
+        derivativeCalls++;
+        value = order == 2 ? 2 : (dr == BY_ARGS ? 2 : -2) * (x[idx] - p[idx]);
+        return ERR_OK;
+    }
+    int derivativeGoalFunctionByArgs(size_t order, size_t idx, DerivedType dr, double& value, IVector const* args) const
+    {
+        IVector *params = IVector::createVector(DIM, const_cast<double*>(_params));
+        int errCode = derivativeGoalFunction(order, idx, dr, value, args, params);
+        delete params;
+        return errCode;
+    }
+    int derivativeGoalFunctionByParams(size_t order, size_t idx, DerivedType dr, double& value, IVector const* params) const
+    {
+        IVector *args = IVector::createVector(DIM, const_cast<double*>(_args));
+        int errCode = derivativeGoalFunction(order, idx, dr, value, args, params);
+        delete args;
+        return errCode;
+    }
+
+    mutable int goalCalls;
+    mutable int derivativeCalls;
+
+private:
+    static int getCoords(IVector const* vec, double const*& coords)
+    {
+        unsigned int dim;
+        if (!vec)
+            return ERR_WRONG_ARG;
+        if (vec->getDim() != DIM)
+            return ERR_DIMENSIONS_MISMATCH;
+        return vec->getCoordsPtr(dim, coords);
+    }
+    static int copyCoords(IVector const* vec, double* coords)
+    {
+        double const* source;
+        int errCode = getCoords(vec, source);
+        for (size_t i = 0; i < DIM && errCode == ERR_OK; i++)
+            coords[i] = source[i];
+        return errCode;
+    }
+
+    double _args[DIM];
+    double _params[DIM];
+};
+
+/*the same problem with Hessian of (x - p)^2 + (x0 - p0) * (x1 - p1), the rest of derivatives aren't changed*/
+class CoupledParaboloid : public Paraboloid
+{
+public:
+    int hessianByArgs(IVector const* /*args*/, double* hessian) const
+    {
+        double const coupled[DIM * DIM] = {2, 1, 0,  1, 2, 0,  0, 0, 2};
+        for (size_t i = 0; i < DIM * DIM; i++)
+            hessian[i] = coupled[i];
+        return ERR_OK;
+    }
+};
+
+/*the same problem built before INTERFACE_1, so only methods of INTERFACE_0 may be called*/
+class LegacyParaboloid : public Paraboloid
+{
+public:
+    int getId() const { return IProblem::INTERFACE_0; }
+};
+
+/*problem of finite difference adapter, released with the test case*/
+class Adapter
+{
+public:
+    Adapter(IProblem* problem, IProblem::DifferenceScheme scheme, unsigned int threads = 1):
+        _brocker(IProblem::createFiniteDifferenceAdapter(problem, scheme, 0, threads)), _problem(NULL)
+    {
+        if (_brocker)
+            _problem = static_cast<IProblem*>(_brocker->getInterfaceImpl(IBrocker::PROBLEM));
+    }
+    ~Adapter()
+    {
+        if (_brocker)
+            _brocker->release();
+    }
+
+    IProblem* operator->() const { return _problem; }
+    bool isValid() const { return _problem != NULL; }
+
+private:
+    IBrocker *_brocker;
+    IProblem *_problem;
+};
+
+/*decorator caching 'problem' and statistics of its cache, released with the test case*/
+class Cached
+{
+public:
+    Cached(IProblem* problem, unsigned int capacity):
+        _brocker(IProblemCache::createCache(problem, capacity))
+    {
+        _problem = static_cast<IProblem*>(_brocker->getInterfaceImpl(IBrocker::PROBLEM));
+        _cache = static_cast<IProblemCache*>(_brocker->getInterfaceImpl(IBrocker::PROBLEM_CACHE));
+    }
+    ~Cached()
+    {
+        _brocker->release();
+    }
+
+    IProblem* operator->() const { return _problem; }
+    IProblemCache* cache() const { return _cache; }
+
+private:
+    IBrocker *_brocker;
+    IProblem *_problem;
+    IProblemCache *_cache;
+};
+
+/*problem of plugin built into test, f = x0^2 + x1^2 + p0^2 - 4 * p0 + p1^2 - 2 * p1*/
+class Plugin
+{
+public:
+    Plugin(): _brocker(static_cast<IBrocker*>(getBrocker()))
+    {
+        _problem = static_cast<IProblem*>(_brocker->getInterfaceImpl(IBrocker::PROBLEM));
+    }
+    ~Plugin()
+    {
+        _brocker->release();
+    }
+
+    IProblem* operator->() const { return _problem; }
+    IProblem* problem() const { return _problem; }
+    IBrocker* brocker() const { return _brocker; }
+
+private:
+    IBrocker *_brocker;
+    IProblem *_problem;
+};
+
+double pluginValue(double const* x, double const* p)
+{
+    return x[0] * x[0] + x[1] * x[1] + p[0] * p[0] - 4 * p[0] + p[1] * p[1] - 2 * p[1];
+}
+
+/*x0 * x1 + sin(x0) / x1 + x1^x0*/
+struct Mixed
+{
+    template<unsigned int N>
+    int operator()(Dual<N> const* x, Dual<N>& res) const
+    {
+        res = x[0] * x[1] + sin(x[0]) / x[1] + pow(x[1], x[0]);
+        return ERR_OK;
+    }
+};
+
+/*sum of (i + 1) * xi^2 over 'dim' coordinates*/
+struct Weighted
+{
+    size_t dim;
+
+    template<unsigned int N>
+    int operator()(Dual<N> const* x, Dual<N>& res) const
+    {
+        res = Dual<N>(0);
+        for (size_t i = 0; i < dim; i++)
+            res += (i + 1.0) * x[i] * x[i];
+        return ERR_OK;
+    }
+};
+
+}
+
+void ProblemTest::dualGradientIsExact()
+{
+    double x[2] = {0.7, 1.9}, value, grad[2];
+    QCOMPARE(dualGradient<2>(Mixed(), x, 2, value, grad), (int)ERR_OK);
+    QCOMPARE(value, x[0] * x[1] + std::sin(x[0]) / x[1] + std::pow(x[1], x[0]));
+    QCOMPARE(grad[0], x[1] + std::cos(x[0]) / x[1] + std::pow(x[1], x[0]) * std::log(x[1]));
+    QCOMPARE(grad[1], x[0] - std::sin(x[0]) / (x[1] * x[1]) + x[0] * std::pow(x[1], x[0] - 1));
+}
+
+void ProblemTest::dualGradientTakesSeveralPasses()
+{
+    Weighted f = {5};
+    double x[5] = {1, -2, 3, -4, 5}, value, grad[5];
+    QCOMPARE(dualGradient<2>(f, x, 5, value, grad), (int)ERR_OK);
+    QCOMPARE(value, 1 + 2 * 4 + 3 * 9 + 4 * 16 + 5 * 25.0);
+    for (int i = 0; i < 5; i++)
+        QCOMPARE(grad[i], 2 * (i + 1) * x[i]);
+}
+
+void ProblemTest::dualPowerOfNonPositiveBase()
+{
+    /*exponent which doesn't depend on variables takes real power, not exp(p * log(x))*/
+    Dual<1> x = Dual<1>::variable(-3, 0), res = pow(x, Dual<1>(2));
+    QCOMPARE(res.val, 9.0);
+    QCOMPARE(res.d[0], -6.0);
+
+    res = pow(x, Dual<1>(3));
+    QCOMPARE(res.val, -27.0);
+    QCOMPARE(res.d[0], 27.0);
+
+    res = pow(Dual<1>::variable(0, 0), Dual<1>(2));
+    QCOMPARE(res.val, 0.0);
+    QCOMPARE(res.d[0], 0.0);
+}
+
+void ProblemTest::dualPowerByExponent()
+{
+    Dual<2> x = Dual<2>::variable(2, 0), p = Dual<2>::variable(3, 1), res = pow(x, p);
+    QCOMPARE(res.val, 8.0);
+    QCOMPARE(res.d[0], 12.0);
+    QCOMPARE(res.d[1], 8 * std::log(2.0));
+
+    /*x^p * log(x) tends to 0 at zero base for positive exponent*/
+    res = pow(Dual<2>::variable(0, 0), p);
+    QCOMPARE(res.val, 0.0);
+    QCOMPARE(res.d[0], 0.0);
+    QCOMPARE(res.d[1], 0.0);
+}
+
+void ProblemTest::defaultBatchEvaluatesPointByPoint()
+{
+    Paraboloid problem;
+    double const points[] = {1, 2, 3,  0, 0, 0,  2, 2, 2,  1, 1, 1};
+    double values[4];
+    QCOMPARE(problem.goalFunctionByArgsBatch(4, points, values), (int)ERR_OK);
+    QCOMPARE(problem.goalCalls, 4);
+    QCOMPARE(values[0], 0.0);
+    QCOMPARE(values[1], 14.0);
+    QCOMPARE(values[2], 2.0);
+    QCOMPARE(values[3], 5.0);
+
+    QCOMPARE(problem.goalFunctionByParamsBatch(2, points, values), (int)ERR_OK);
+    QCOMPARE(values[0], 14.0);
+    QCOMPARE(values[1], 0.0);
+
+    QCOMPARE(problem.goalFunctionByArgsBatch(0, NULL, NULL), (int)ERR_OK);
+    QCOMPARE(problem.goalFunctionByArgsBatch(1, NULL, values), (int)ERR_WRONG_ARG);
+}
+
+void ProblemTest::problemBatchMatchesSinglePoints()
+{
+    Plugin plugin;
+    double p[2] = {1, -1}, points[] = {0, 0,  1, 2,  -3, 0.5};
+    IVector *params = IVector::createVector(2, p);
+    QCOMPARE(plugin->setParams(params), (int)ERR_OK);
+
+    double values[3];
+    QCOMPARE(plugin->goalFunctionByArgsBatch(3, points, values), (int)ERR_OK);
+    for (int i = 0; i < 3; i++)
+        QCOMPARE(values[i], pluginValue(points + 2 * i, p));
+    QCOMPARE(plugin->goalFunctionByArgsBatch(1, NULL, values), (int)ERR_WRONG_ARG);
+    delete params;
+}
+
+void ProblemTest::defaultGradientTakesDerivativesByCoordinates()
+{
+    Paraboloid problem;
+    double x[3] = {2, 0, 5}, value, g;
+    IVector *args = IVector::createVector(3, x), *grad = IVector::createVector(3, x);
+    QCOMPARE(problem.gradientByArgs(args, grad), (int)ERR_OK);
+    QCOMPARE(problem.derivativeCalls, 3);
+    for (unsigned int i = 0; i < 3; i++) {
+        grad->getCoord(i, g);
+        QCOMPARE(g, 2 * (x[i] - (i + 1)));
+    }
+
+    QCOMPARE(problem.valueAndGradientByArgs(args, value, grad), (int)ERR_OK);
+    QCOMPARE(value, 1 + 4 + 4.0);
+    QCOMPARE(problem.gradientByParams(args, grad), (int)ERR_OK);
+    grad->getCoord(0, g);
+    QCOMPARE(g, 4.0);
+
+    IVector *small = IVector::createVector(2, x);
+    QCOMPARE(problem.gradientByArgs(args, small), (int)ERR_DIMENSIONS_MISMATCH);
+    QCOMPARE(problem.gradientByArgs(args, NULL), (int)ERR_WRONG_ARG);
+    delete small;
+    delete args;
+    delete grad;
+}
+
+void ProblemTest::problemGradientIsFused()
+{
+    Plugin plugin;
+    double p[2] = {1, -1}, x[2] = {3, -2}, value, g;
+    IVector *params = IVector::createVector(2, p), *args = IVector::createVector(2, x), *grad = IVector::createVector(2, x);
+    QCOMPARE(plugin->setParams(params), (int)ERR_OK);
+
+    QCOMPARE(plugin->valueAndGradientByArgs(args, value, grad), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+    grad->getCoord(0, g);
+    QCOMPARE(g, 6.0);
+    grad->getCoord(1, g);
+    QCOMPARE(g, -4.0);
+
+    QCOMPARE(plugin->setArgs(args), (int)ERR_OK);
+    QCOMPARE(plugin->gradientByParams(params, grad), (int)ERR_OK);
+    grad->getCoord(0, g);
+    QCOMPARE(g, 2 * p[0] - 4);
+    grad->getCoord(1, g);
+    QCOMPARE(g, 2 * p[1] - 2);
+    delete params;
+    delete args;
+    delete grad;
+}
+
+void ProblemTest::defaultHessianIsNotImplemented()
+{
+    Paraboloid problem;
+    double x[3] = {0, 0, 0}, hessian[9];
+    IVector *args = IVector::createVector(3, x), *res = IVector::createVector(3, x);
+    QCOMPARE(problem.hessianByArgs(args, hessian), (int)ERR_NOT_IMPLEMENTED);
+    QCOMPARE(problem.hessianVectorProductByArgs(args, args, res), (int)ERR_NOT_IMPLEMENTED);
+
+    size_t count = 1, *rows = &count, *cols = &count;
+    QCOMPARE(problem.getHessianSparsity(IProblem::BY_ARGS, count, rows, cols), (int)ERR_NOT_IMPLEMENTED);
+    QCOMPARE(count, (size_t)0);
+    QVERIFY(!rows && !cols);
+    delete args;
+    delete res;
+}
+
+void ProblemTest::defaultProductUsesWholeHessian()
+{
+    CoupledParaboloid problem;
+    double x[3] = {0, 0, 0}, v[3] = {1, 2, 3}, r;
+    IVector *args = IVector::createVector(3, x), *vec = IVector::createVector(3, v), *res = IVector::createVector(3, x);
+    QCOMPARE(problem.hessianVectorProductByArgs(args, vec, res), (int)ERR_OK);
+    for (unsigned int i = 0; i < 3; i++) {
+        res->getCoord(i, r);
+        QCOMPARE(r, i + 4.0);
+    }
+
+    IVector *small = IVector::createVector(2, v);
+    QCOMPARE(problem.hessianVectorProductByArgs(args, small, res), (int)ERR_DIMENSIONS_MISMATCH);
+    delete small;
+    delete args;
+    delete vec;
+    delete res;
+}
+
+void ProblemTest::problemHessianIsDiagonal()
+{
+    Plugin plugin;
+    double x[2] = {3, -2}, v[2] = {1, 5}, hessian[4], r;
+    IVector *args = IVector::createVector(2, x), *vec = IVector::createVector(2, v), *res = IVector::createVector(2, x);
+    QCOMPARE(plugin->hessianByArgs(args, hessian), (int)ERR_OK);
+    QCOMPARE(hessian[0], 2.0);
+    QCOMPARE(hessian[1], 0.0);
+    QCOMPARE(hessian[2], 0.0);
+    QCOMPARE(hessian[3], 2.0);
+
+    QCOMPARE(plugin->hessianVectorProductByArgs(args, vec, res), (int)ERR_OK);
+    res->getCoord(1, r);
+    QCOMPARE(r, 10.0);
+
+    size_t count, *rows, *cols;
+    QCOMPARE(plugin->getHessianSparsity(IProblem::BY_PARAMS, count, rows, cols), (int)ERR_OK);
+    QCOMPARE(count, (size_t)2);
+    for (size_t i = 0; i < count; i++) {
+        QCOMPARE(rows[i], i);
+        QCOMPARE(cols[i], i);
+    }
+    delete[] rows;
+    delete[] cols;
+    delete args;
+    delete vec;
+    delete res;
+}
+
+void ProblemTest::finiteDifferencesApproximateDerivatives()
+{
+    Paraboloid problem;
+    double x[3] = {2, -1, 0.5}, value, g;
+    IVector *args = IVector::createVector(3, x), *grad = IVector::createVector(3, x);
+
+    IProblem::DifferenceScheme const schemes[] = {IProblem::CENTRAL_DIFFERENCE, IProblem::FORWARD_DIFFERENCE};
+    for (int s = 0; s < 2; s++) {
+        Adapter adapter(&problem, schemes[s]);
+        QVERIFY(adapter.isValid());
+        QCOMPARE(adapter->valueAndGradientByArgs(args, value, grad), (int)ERR_OK);
+        QCOMPARE(value, 1 + 9 + 6.25);
+        for (unsigned int i = 0; i < 3; i++) {
+            grad->getCoord(i, g);
+            QVERIFY(std::fabs(g - 2 * (x[i] - (i + 1))) < 1e-5);
+        }
+
+        QCOMPARE(adapter->derivativeGoalFunctionByArgs(2, 1, IProblem::BY_ARGS, g, args), (int)ERR_OK);
+        QVERIFY(std::fabs(g - 2) < 1e-3);
+        QCOMPARE(adapter->derivativeGoalFunctionByArgs(3, 1, IProblem::BY_ARGS, g, args), (int)ERR_NOT_IMPLEMENTED);
+    }
+    delete args;
+    delete grad;
+
+    QVERIFY(!IProblem::createFiniteDifferenceAdapter(NULL));
+    QVERIFY(!IProblem::createFiniteDifferenceAdapter(&problem, IProblem::CENTRAL_DIFFERENCE, -1));
+}
+
+void ProblemTest::finiteDifferencesRunOnSeveralThreads()
+{
+    Plugin plugin;
+    double p[2] = {1, -1}, x[2] = {3, -2}, value, g;
+    IVector *params = IVector::createVector(2, p), *args = IVector::createVector(2, x), *grad = IVector::createVector(2, x);
+    QCOMPARE(plugin->setParams(params), (int)ERR_OK);
+
+    /*plugin is reentrant, so perturbed points are spread over threads sharing it*/
+    Adapter adapter(plugin.problem(), IProblem::CENTRAL_DIFFERENCE, 4);
+    QVERIFY(adapter.isValid());
+    QCOMPARE(adapter->valueAndGradientByArgs(args, value, grad), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+    grad->getCoord(0, g);
+    QVERIFY(std::fabs(g - 6) < 1e-6);
+    grad->getCoord(1, g);
+    QVERIFY(std::fabs(g + 4) < 1e-6);
+    delete params;
+    delete args;
+    delete grad;
+}
+
+void ProblemTest::finiteDifferencesWrapLegacyProblem()
+{
+    LegacyParaboloid problem;
+    double x[3] = {0, 0, 0}, g;
+    IVector *args = IVector::createVector(3, x), *grad = IVector::createVector(3, x);
+
+    Adapter adapter(&problem, IProblem::CENTRAL_DIFFERENCE, 4);
+    QVERIFY(adapter.isValid());
+    QCOMPARE(adapter->gradientByArgs(args, grad), (int)ERR_OK);
+    grad->getCoord(2, g);
+    QVERIFY(std::fabs(g + 6) < 1e-6);
+    QCOMPARE(problem.derivativeCalls, 0);
+    delete args;
+    delete grad;
+}
+
+void ProblemTest::boundParamsAreReadWithoutCopy()
+{
+    Plugin plugin;
+    double p[2] = {1, -1}, x[2] = {3, -2}, value;
+    IVector *args = IVector::createVector(2, x);
+    QCOMPARE(plugin->bindParams(p, 2), (int)ERR_OK);
+    QCOMPARE(plugin->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+
+    /*buffer is read by every call, paramsChanged refreshes values cached by problem*/
+    p[0] = 4;
+    QCOMPARE(plugin->paramsChanged(), (int)ERR_OK);
+    QCOMPARE(plugin->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+
+    QCOMPARE(plugin->bindArgs(x, 2), (int)ERR_OK);
+    x[1] = 0;
+    QCOMPARE(plugin->argsChanged(), (int)ERR_OK);
+    IVector *params = IVector::createVector(2, p);
+    QCOMPARE(plugin->goalFunctionByParams(params, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+
+    QCOMPARE(plugin->bindParams(p, 3), (int)ERR_VARIABLES_NUMBER_MISMATCH);
+    QCOMPARE(plugin->bindParams(NULL, 0), (int)ERR_OK);
+    QVERIFY(plugin->goalFunctionByArgs(args, value) != ERR_OK);
+
+    Paraboloid problem;
+    QCOMPARE(problem.bindParams(p, 3), (int)ERR_NOT_IMPLEMENTED);
+    QCOMPARE(problem.paramsChanged(), (int)ERR_OK);
+    delete args;
+    delete params;
+}
+
+void ProblemTest::workersEvaluateIndependently()
+{
+    Plugin plugin;
+    double p[2] = {1, -1}, q[2] = {0, 0}, x[2] = {3, -2}, value;
+    IVector *params = IVector::createVector(2, p), *args = IVector::createVector(2, x);
+    QCOMPARE(plugin->setParams(params), (int)ERR_OK);
+    QVERIFY(plugin->isReentrant());
+
+    IProblem *worker = plugin->createWorkerInstance();
+    QVERIFY(worker);
+    QCOMPARE(worker->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+
+    /*worker keeps its copy of fixed params*/
+    IVector *other = IVector::createVector(2, q);
+    QCOMPARE(plugin->setParams(other), (int)ERR_OK);
+    QCOMPARE(worker->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, p));
+    QCOMPARE(worker->releaseWorkerInstance(), (int)ERR_OK);
+    QCOMPARE(plugin->releaseWorkerInstance(), (int)ERR_WRONG_ARG);
+
+    IBrocker *brocker = plugin.brocker()->createWorkerBrocker();
+    QVERIFY(brocker);
+    worker = static_cast<IProblem*>(brocker->getInterfaceImpl(IBrocker::PROBLEM));
+    QCOMPARE(worker->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, pluginValue(x, q));
+    brocker->release();
+
+    Paraboloid problem;
+    QVERIFY(!problem.isReentrant());
+    QVERIFY(!problem.createWorkerInstance());
+    delete params;
+    delete other;
+    delete args;
+}
+
+void ProblemTest::cacheAnswersRepeatedPoints()
+{
+    Paraboloid problem;
+    Cached cached(&problem, 1 << 16);
+    double x[3] = {2, -1, 0.5}, q[3] = {0, 0, 0}, value;
+    IVector *args = IVector::createVector(3, x), *grad = IVector::createVector(3, x);
+
+    QCOMPARE(cached->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(cached->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, 1 + 9 + 6.25);
+    QCOMPARE(problem.goalCalls, 1);
+    QCOMPARE(cached.cache()->getHits(), 1u);
+    QCOMPARE(cached.cache()->getMisses(), 1u);
+    QVERIFY(cached.cache()->getSize() > 0);
+
+    QCOMPARE(cached->gradientByArgs(args, grad), (int)ERR_OK);
+    QCOMPARE(cached->gradientByArgs(args, grad), (int)ERR_OK);
+    QCOMPARE(problem.derivativeCalls, 3);
+
+    /*fixed params are a part of key*/
+    IVector *params = IVector::createVector(3, q);
+    QCOMPARE(cached->setParams(params), (int)ERR_OK);
+    QCOMPARE(cached->goalFunctionByArgs(args, value), (int)ERR_OK);
+    QCOMPARE(value, 4 + 1 + 0.25);
+    QCOMPARE(problem.goalCalls, 2);
+
+    QCOMPARE(cached.cache()->clear(), (int)ERR_OK);
+    QCOMPARE(cached.cache()->getHits(), 0u);
+    QCOMPARE(cached.cache()->getSize(), 0u);
+    delete params;
+    delete args;
+    delete grad;
+
+    QVERIFY(!IProblemCache::createCache(&problem, 0));
+}
+
+void ProblemTest::cacheDropsLeastRecentlyUsed()
+{
+    Paraboloid problem;
+    Cached cached(&problem, 1024);
+    double x[3] = {0, 0, 0}, value;
+    IVector *args = IVector::createVector(3, x);
+
+    for (int i = 0; i < 100; i++) {
+        args->setCoord(0, i);
+        QCOMPARE(cached->goalFunctionByArgs(args, value), (int)ERR_OK);
+    }
+    QVERIFY(cached.cache()->getSize() <= 1024);
+
+    args->setCoord(0, 99);
+    cached->goalFunctionByArgs(args, value);
+    QCOMPARE(problem.goalCalls, 100);
+    args->setCoord(0, 0);
+    cached->goalFunctionByArgs(args, value);
+    QCOMPARE(problem.goalCalls, 101);
+    delete args;
+}
+
+QTEST_APPLESS_MAIN(ProblemTest)
+
+#include "tst_problem.moc"
@@ -0,0 +1,23 @@
+QT       += core testlib concurrent
+QT       -= gui
+
+QMAKE_CXXFLAGS += -std=gnu++0x
+
+TARGET = tst_sets
+CONFIG += console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+
+DEFINES += DLL_LIBRARY
+INCLUDEPATH += ../.. ../../src
+
+SOURCES += tst_sets.cpp \
+    ../../src/ISetImpl.cpp \
+    ../../src/ConcurrentSet.cpp \
+    ../../src/MappedSet.cpp \
+    ../../src/PrioritySet.cpp \
+    ../../src/ParetoSet.cpp \
+    ../../src/SetIterators.cpp \
+    ../../src/PointIndex.cpp \
+    ../../src/Vector.cpp \
+    ../../src/Log.cpp
@@ -0,0 +1,450 @@
+#include <QtTest>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QTemporaryDir>
+
+#include "IPrioritySet.h"
+#include "ISet.h"
+#include "IVector.h"
+
+class SetsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void priorityKeepsBestPoints();
+    void priorityHeapSurvivesRemove();
+    void paretoDropsDominatedPoints();
+    void paretoMinimizesOnlyObjectives();
+    void paretoCapacityBoundsSize();
+    void setFindsNearestAndInRadius();
+    void setLendsCoordinates();
+    void setPutsAndRemovesBatches();
+    void setRejectsBatchOverflowingStorage();
+    void concurrentSetTakesPointsOfSeveralThreads();
+    void mappedSetReadsAppendedFile();
+    void uniqueModeSkipsEqualPoints();
+    void concurrentSetPutsUniquePointsOnce();
+};
+
+namespace {
+
+int putPoint(IPrioritySet *set, double x, double value)
+{
+    double coords[2] = {x, value};
+    IVector *item = IVector::createVector(2, coords);
+    int errCode = set->put(item, value);
+    delete item;
+    return errCode;
+}
+
+/*grid of points (i, j) for i, j < side put in row-major order*/
+ISet* gridSet(unsigned int side)
+{
+    ISet *set = ISet::createSet(2);
+    for (unsigned int i = 0; i < side; i++) {
+        for (unsigned int j = 0; j < side; j++) {
+            double point[2] = {(double)i, (double)j};
+            set->putMany(1, point);
+        }
+    }
+    return set;
+}
+
+/*points (i, i % 7) for i from 'first' put by one of threads, 'added' counts new ones of putUnique*/
+struct Batch
+{
+    ISet* set;
+    unsigned int first;
+    unsigned int count;
+    bool unique;
+    unsigned int added;
+    int errCode;
+};
+
+void putBatch(Batch& batch)
+{
+    batch.added = 0;
+    batch.errCode = ERR_OK;
+    for (unsigned int i = batch.first; i < batch.first + batch.count && batch.errCode == ERR_OK; i++) {
+        double coords[2] = {(double)i, (double)(i % 7)};
+        IVector *item = IVector::createVector(2, coords);
+        bool added = true;
+        batch.errCode = batch.unique ? batch.set->putUnique(item, added) : batch.set->put(item);
+        batch.added += added ? 1 : 0;
+        delete item;
+    }
+}
+
+bool isFarFromOrigin(double const* coords, unsigned int /*dim*/, void* context)
+{
+    return coords[0] + coords[1] > *static_cast<double*>(context);
+}
+
+QVector<double> sortedValues(IPrioritySet const* set)
+{
+    unsigned int size = set->getSize();
+    QVector<double> coords(2 * size), values(size);
+    set->exportSorted(2 * size, coords.data(), values.data());
+    return values;
+}
+
+}
+
+void SetsTest::priorityKeepsBestPoints()
+{
+    IPrioritySet *set = IPrioritySet::createPrioritySet(2, 3);
+    QVERIFY(set);
+
+    double const values[] = {5, 1, 4, 2, 3, 6};
+    for (int i = 0; i < 6; i++)
+        QCOMPARE(putPoint(set, i, values[i]), (int)ERR_OK);
+
+    QCOMPARE(set->getSize(), 3u);
+    QCOMPARE(sortedValues(set), QVector<double>() << 1 << 2 << 3);
+
+    IVector *best;
+    double value;
+    QCOMPARE(set->getBest(best, value), (int)ERR_OK);
+    QCOMPARE(value, 1.0);
+    double x;
+    best->getCoord(0, x);
+    QCOMPARE(x, 1.0);
+    delete best;
+    delete set;
+}
+
+void SetsTest::priorityHeapSurvivesRemove()
+{
+    IPrioritySet *set = IPrioritySet::createPrioritySet(2, 8);
+    QVERIFY(set);
+
+    double const values[] = {7, 3, 9, 1, 8, 2, 6, 4};
+    for (int i = 0; i < 8; i++)
+        putPoint(set, i, values[i]);
+
+    /*the best point and one from the middle of heap are removed by index*/
+    for (int removed = 0; removed < 2; removed++) {
+        double target = removed == 0 ? 1 : 7;
+        for (unsigned int i = 0; i < set->getSize(); i++) {
+            double value;
+            set->getValue(i, value);
+            if (value == target) {
+                QCOMPARE(set->remove(i), (int)ERR_OK);
+                break;
+            }
+        }
+    }
+
+    QCOMPARE(sortedValues(set), QVector<double>() << 2 << 3 << 4 << 6 << 8 << 9);
+
+    IVector *best;
+    double value;
+    QCOMPARE(set->getBest(best, value), (int)ERR_OK);
+    QCOMPARE(value, 2.0);
+    delete best;
+
+    /*points keep their values after moves of remove*/
+    for (unsigned int i = 0; i < set->getSize(); i++) {
+        IVector *item;
+        double x, stored;
+        set->get(i, item);
+        item->getCoord(1, x);
+        set->getValue(i, stored);
+        QCOMPARE(stored, x);
+        delete item;
+    }
+    delete set;
+}
+
+void SetsTest::paretoDropsDominatedPoints()
+{
+    ISet *set = ISet::createParetoSet(2);
+    QVERIFY(set);
+
+    double const points[] = {1, 3,  3, 1,  2, 2,  2, 3,  3, 3};
+    QCOMPARE(set->putMany(5, points), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 3u);
+
+    double const dominating[] = {0.5, 0.5};
+    QCOMPARE(set->putMany(1, dominating), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 1u);
+
+    bool found;
+    IVector *item = IVector::createVector(2, const_cast<double*>(dominating));
+    set->contains(item, found);
+    QVERIFY(found);
+    delete item;
+    delete set;
+}
+
+void SetsTest::paretoMinimizesOnlyObjectives()
+{
+    ISet *set = ISet::createParetoSet(3, 1);
+    QVERIFY(set);
+
+    /*the third coordinate isn't an objective, so it doesn't save point from domination*/
+    double const points[] = {2, 0, 0,  1, 5, 5};
+    QCOMPARE(set->putMany(2, points), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 1u);
+
+    unsigned int count, dim;
+    double const *coords;
+    set->getData(count, dim, coords);
+    QCOMPARE(coords[0], 1.0);
+    delete set;
+}
+
+void SetsTest::paretoCapacityBoundsSize()
+{
+    ISet *set = ISet::createParetoSet(2, 0, 4);
+    QVERIFY(set);
+
+    /*points of front x + y == 10*/
+    for (int i = 0; i <= 10; i++) {
+        double point[2] = {(double)i, 10.0 - i};
+        QCOMPARE(set->putMany(1, point), (int)ERR_OK);
+    }
+
+    QCOMPARE(set->getSize(), 4u);
+    delete set;
+}
+
+void SetsTest::setFindsNearestAndInRadius()
+{
+    ISet *set = gridSet(10);
+    double coords[2] = {3.2, 4.1};
+    IVector *item = IVector::createVector(2, coords);
+
+    unsigned int *indices, count;
+    QCOMPARE(set->getNearest(item, 3, indices, count), (int)ERR_OK);
+    QCOMPARE(count, 3u);
+    QCOMPARE(indices[0], 34u);
+    QCOMPARE(indices[1], 44u);
+    QCOMPARE(indices[2], 35u);
+    delete[] indices;
+
+    QCOMPARE(set->getInRadius(item, 1, indices, count), (int)ERR_OK);
+    QCOMPARE(count, 3u);
+    QCOMPARE(indices[0], 34u);
+    QCOMPARE(indices[1], 35u);
+    QCOMPARE(indices[2], 44u);
+    delete[] indices;
+
+    /*points put after the tree was built are found too*/
+    QCOMPARE(set->put(item), (int)ERR_OK);
+    QCOMPARE(set->getNearest(item, 1, indices, count), (int)ERR_OK);
+    QCOMPARE(count, 1u);
+    QCOMPARE(indices[0], 100u);
+    delete[] indices;
+
+    QCOMPARE(set->remove(100), (int)ERR_OK);
+    QCOMPARE(set->getNearest(item, 200, indices, count), (int)ERR_OK);
+    QCOMPARE(count, 100u);
+    QCOMPARE(indices[0], 34u);
+    delete[] indices;
+    delete item;
+    delete set;
+}
+
+void SetsTest::setLendsCoordinates()
+{
+    ISet *set = gridSet(3);
+
+    unsigned int count, dim;
+    double const *data, *coords;
+    QCOMPARE(set->getData(count, dim, data), (int)ERR_OK);
+    QCOMPARE(count, 9u);
+    QCOMPARE(dim, 2u);
+    for (unsigned int i = 0; i < count; i++) {
+        QCOMPARE(data[2 * i], (double)(i / 3));
+        QCOMPARE(data[2 * i + 1], (double)(i % 3));
+    }
+
+    QCOMPARE(set->getCoordsPtr(5, dim, coords), (int)ERR_OK);
+    QVERIFY(coords == data + 10);
+    QCOMPARE(set->getCoordsPtr(9, dim, coords), (int)ERR_OUT_OF_RANGE);
+
+    ISet::IIterator *it = set->begin();
+    it->next();
+    QCOMPARE(set->getCoordsPtrByIterator(it, dim, coords), (int)ERR_OK);
+    QVERIFY(coords == data + 2);
+    set->deleteIterator(it);
+    delete set;
+}
+
+void SetsTest::setPutsAndRemovesBatches()
+{
+    ISet *set = ISet::createSet(2);
+    double const points[] = {0, 0,  1, 0,  0, 1,  1, 1,  2, 2};
+    QCOMPARE(set->putMany(5, points), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 5u);
+
+    QVector<double> buffer(10);
+    QCOMPARE(set->exportTo(9, buffer.data()), (int)ERR_OUT_OF_RANGE);
+    QCOMPARE(set->exportTo(10, buffer.data()), (int)ERR_OK);
+    for (int i = 0; i < 10; i++)
+        QCOMPARE(buffer[i], points[i]);
+
+    double limit = 1.5;
+    QCOMPARE(set->removeIf(isFarFromOrigin, &limit), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 3u);
+
+    unsigned int const removed[] = {2, 0};
+    QCOMPARE(set->remove(2, removed), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 1u);
+    unsigned int dim;
+    double const *coords;
+    set->getCoordsPtr(0, dim, coords);
+    QCOMPARE(coords[0], 1.0);
+    QCOMPARE(coords[1], 0.0);
+
+    unsigned int const wrong[] = {0, 1};
+    QCOMPARE(set->remove(2, wrong), (int)ERR_OUT_OF_RANGE);
+    QCOMPARE(set->getSize(), 1u);
+    delete set;
+}
+
+void SetsTest::setRejectsBatchOverflowingStorage()
+{
+    ISet *set = ISet::createSet(4);
+    double const point[] = {1, 2, 3, 4};
+    QCOMPARE(set->putMany(1, point), (int)ERR_OK);
+
+    /*count * dim doesn't fit into int, batch is rejected before its coordinates are read*/
+    QCOMPARE(set->putMany(0x20000000u, point), (int)ERR_OUT_OF_RANGE);
+    QCOMPARE(set->getSize(), 1u);
+    delete set;
+}
+
+void SetsTest::concurrentSetTakesPointsOfSeveralThreads()
+{
+    ISet *set = ISet::createConcurrentSet(2, 4);
+    QVERIFY(set);
+
+    QVector<Batch> batches;
+    for (unsigned int i = 0; i < 8; i++) {
+        Batch batch = {set, 250 * i, 250, false, 0, ERR_ANY_OTHER};
+        batches.append(batch);
+    }
+    QtConcurrent::blockingMap(batches, putBatch);
+    for (int i = 0; i < batches.size(); i++)
+        QCOMPARE(batches[i].errCode, (int)ERR_OK);
+    QCOMPARE(set->getSize(), 2000u);
+
+    for (unsigned int i = 0; i < 2000; i += 97) {
+        double coords[2] = {(double)i, (double)(i % 7)};
+        IVector *item = IVector::createVector(2, coords);
+        bool found = false;
+        QCOMPARE(set->contains(item, found), (int)ERR_OK);
+        QVERIFY(found);
+        delete item;
+    }
+
+    QVector<double> buffer(2 * 2000);
+    QCOMPARE(set->exportTo(buffer.size(), buffer.data()), (int)ERR_OK);
+    double sum = 0;
+    for (int i = 0; i < buffer.size(); i += 2)
+        sum += buffer[i];
+    QCOMPARE(sum, 1999 * 2000 / 2.0);
+
+    QCOMPARE(set->remove(0), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 1999u);
+    delete set;
+}
+
+void SetsTest::mappedSetReadsAppendedFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QByteArray fileName = (dir.path() + "/points.set").toLocal8Bit();
+
+    double const points[] = {1, 2,  3, 4,  5, 6};
+    QCOMPARE(ISet::appendToFile(fileName.constData(), 2, 3, points), (int)ERR_OK);
+    QCOMPARE(ISet::appendToFile(fileName.constData(), 2, 2, points + 2), (int)ERR_OK);
+    QCOMPARE(ISet::appendToFile(fileName.constData(), 3, 1, points), (int)ERR_DIMENSIONS_MISMATCH);
+
+    ISet *set = ISet::openMappedSet(fileName.constData());
+    QVERIFY(set);
+    QCOMPARE(set->getSize(), 5u);
+
+    unsigned int count, dim;
+    double const *data;
+    QCOMPARE(set->getData(count, dim, data), (int)ERR_OK);
+    QCOMPARE(count, 5u);
+    QCOMPARE(dim, 2u);
+    QCOMPARE(data[6], 3.0);
+    QCOMPARE(data[9], 6.0);
+
+    bool found = false;
+    IVector *item = IVector::createVector(2, const_cast<double*>(points + 4));
+    QCOMPARE(set->contains(item, found), (int)ERR_OK);
+    QVERIFY(found);
+    QCOMPARE(set->put(item), (int)ERR_NOT_IMPLEMENTED);
+    QCOMPARE(set->getSize(), 5u);
+    delete item;
+    delete set;
+
+    QVERIFY(!ISet::openMappedSet((dir.path() + "/missing.set").toLocal8Bit().constData()));
+}
+
+void SetsTest::uniqueModeSkipsEqualPoints()
+{
+    ISet *set = ISet::createSet(2);
+    QCOMPARE(set->setInsertMode(ISet::INSERT_UNIQUE), (int)ERR_OK);
+
+    /*the third point equals the first one within EPS, the fourth one repeats the second one*/
+    double const points[] = {1, 1,  2, 2,  1 + 5e-9, 1 - 5e-9,  2, 2,  3, 3};
+    QCOMPARE(set->putMany(5, points), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 3u);
+
+    bool added = true;
+    IVector *item = IVector::createVector(2, const_cast<double*>(points + 6));
+    QCOMPARE(set->putUnique(item, added), (int)ERR_OK);
+    QVERIFY(!added);
+    QCOMPARE(set->getSize(), 3u);
+
+    QCOMPARE(set->setInsertMode(ISet::INSERT_ALL), (int)ERR_OK);
+    QCOMPARE(set->put(item), (int)ERR_OK);
+    QCOMPARE(set->getSize(), 4u);
+    QCOMPARE(set->setInsertMode(ISet::DIMENSION_INSERT_MODE), (int)ERR_WRONG_ARG);
+    delete item;
+    delete set;
+}
+
+void SetsTest::concurrentSetPutsUniquePointsOnce()
+{
+    ISet *set = ISet::createConcurrentSet(2, 4);
+
+    /*every thread puts the same points, each of them is added by one thread only*/
+    QVector<Batch> batches;
+    for (unsigned int i = 0; i < 8; i++) {
+        Batch batch = {set, 0, 300, true, 0, ERR_ANY_OTHER};
+        batches.append(batch);
+    }
+    QtConcurrent::blockingMap(batches, putBatch);
+    unsigned int added = 0;
+    for (int i = 0; i < batches.size(); i++) {
+        QCOMPARE(batches[i].errCode, (int)ERR_OK);
+        added += batches[i].added;
+    }
+    QCOMPARE(set->getSize(), 300u);
+    QCOMPARE(added, 300u);
+
+    /*equal points on both sides of boundary of grid cells may go to different shards*/
+    double left[2] = {64e-8 - 3e-9, 0}, right[2] = {64e-8 + 3e-9, 0};
+    IVector *item = IVector::createVector(2, left);
+    bool isAdded = false;
+    QCOMPARE(set->putUnique(item, isAdded), (int)ERR_OK);
+    QVERIFY(isAdded);
+    delete item;
+    item = IVector::createVector(2, right);
+    QCOMPARE(set->putUnique(item, isAdded), (int)ERR_OK);
+    QVERIFY(!isAdded);
+    delete item;
+    delete set;
+}
+
+QTEST_APPLESS_MAIN(SetsTest)
+
+#include "tst_sets.moc"
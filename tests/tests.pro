@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    expression \
+    sets \
+    compact \
+    problem